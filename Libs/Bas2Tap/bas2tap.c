@@ -40,7 +40,6 @@
 #include <string.h>
 #include <math.h>
 
-#define BAS2TAP_EXTERN
 #include "bas2tap.h"
 
 /**********************************************************************************************************************************/
@@ -374,8 +373,24 @@ struct TokenMap_s
    {"COPY",      1, { 0 }}};
 
 
-char bas2tap_ConvertedSpectrumLine[MAXLINELENGTH + 1];
-byte ResultingLine[MAXLINELENGTH + 1];
+/**********************************************************************************************************************************/
+/* All conversion state lives in a bas2tap_context, so that several conversions can run in parallel on different threads.         */
+/* The context is activated for the calling thread on entry of each public function.                                              */
+/**********************************************************************************************************************************/
+
+#if defined(_MSC_VER)
+#define BAS2TAP_THREAD_LOCAL __declspec(thread)
+#else
+#define BAS2TAP_THREAD_LOCAL _Thread_local
+#endif
+
+static BAS2TAP_THREAD_LOCAL bas2tap_context *Context;
+
+#define bas2tap_error(...)            Context->error (Context, __VA_ARGS__)
+#define bas2tap_fgets(...)            Context->fgets (Context, __VA_ARGS__)
+#define bas2tap_output(...)           Context->output (Context, __VA_ARGS__)
+#define bas2tap_ConvertedSpectrumLine (Context->ConvertedSpectrumLine)
+#define ResultingLine                 (Context->ResultingLine)
 
 #if 0
 struct TapeHeader_s
@@ -403,26 +418,27 @@ struct TapeHeader_s
                 255};                                                             /* Flag converted BASIC */
 #endif
 
-int   Is48KProgram    = -1;                                                                                       /* -1 = unknown */
+#define Is48KProgram                  (Context->Is48KProgram)                                                  /* -1 = unknown */
                                                                                                                   /*  1 = 48K     */
                                                                                                                   /*  0 = 128K    */
-int   UsesInterface1  = -1;                                                           /* -1 = unknown                             */
+#define UsesInterface1                (Context->UsesInterface1)                           /* -1 = unknown                             */
                                                                                       /*  0 = either Interface1 or Opus Discovery */
                                                                                       /*  1 = Interface1                          */
                                                                                       /*  2 = Opus Discovery                      */
-bool  CaseIndependant = FALSE;
-bool  Quiet           = FALSE;                                                 /* Suppress banner and progress indication if TRUE */
-bool  NoWarnings      = FALSE;                                                                       /* Suppress warnings if TRUE */
-bool  DoCheckSyntax   = TRUE;
-bool  TokenBracket    = FALSE;
-bool  HandlingDEFFN   = FALSE;                                                                         /* Exceptional instruction */
-bool  InsideDEFFN     = FALSE;
+#define CaseIndependant               (Context->CaseIndependant)
+#define Quiet                         (Context->Quiet)                 /* Suppress banner and progress indication if TRUE */
+#define NoWarnings                    (Context->NoWarnings)                                          /* Suppress warnings if TRUE */
+#define DoCheckSyntax                 (Context->DoCheckSyntax)
+#define TokenBracket                  (Context->TokenBracket)
+#define HandlingDEFFN                 (Context->HandlingDEFFN)                                         /* Exceptional instruction */
+#define InsideDEFFN                   (Context->InsideDEFFN)
 #define DEFFN           0xCE
 /*FILE *ErrStream;*/
-int PreviousBasicLineNo = -1;
+#define PreviousBasicLineNo           (Context->PreviousBasicLineNo)
 
-void bas2tap_reset()
+void bas2tap_reset(bas2tap_context *ctx)
 {
+    Context = ctx;
     Is48KProgram = -1;
     UsesInterface1 = -1;
     CaseIndependant = FALSE;
@@ -737,6 +753,30 @@ int ExpandSequences (int FileLineNo, char **BasicLine, byte **SpectrumLine, bool
   if (**BasicLine != '{')
     return (0);
   StartOfSequence = (*BasicLine) + 1;
+  if (*StartOfSequence == '@' && *(StartOfSequence + 1) == '@' && IsDigit (*(StartOfSequence + 2)) && Context->embed)
+  {                                                                                   /* Form "{@@N}" -> raw bytes from the host */
+    const byte *Data;
+    size_t      Length;
+    int         Index = 0;
+
+    for (Cnt = 2 ; IsDigit (*(StartOfSequence + Cnt)) ; Cnt ++)
+      Index = Index * 10 + *(StartOfSequence + Cnt) - '0';
+    if (*(StartOfSequence + Cnt) == '}' && Context->embed (Context, Index, &Data, &Length))
+    {
+      if ((size_t)(*SpectrumLine - ResultingLine) + Length > MAXLINELENGTH)
+      {
+        bas2tap_error (FileLineNo, -1, "line is too long.");
+        return (-1);
+      }
+      memcpy (*SpectrumLine, Data, Length);
+      (*SpectrumLine) += Length;
+      (*BasicLine) = StartOfSequence + Cnt + 1;
+      if (StripSpaces)
+        while ((**BasicLine) == ' ')
+          (*BasicLine) ++;
+      return (1);
+    }
+  }
   /* 'CODE' and 'CAT' were added for the sole purpuse of allowing them to be OPEN #'ed as channels! */
   if (!x_strnicmp (StartOfSequence, "CODE}", 5))                                                               /* Special: 'CODE' */
   {
@@ -903,7 +943,7 @@ int ExpandSequences (int FileLineNo, char **BasicLine, byte **SpectrumLine, bool
   return (0);
 }
 
-int bas2tap_PrepareLine (char *LineIn, int FileLineNo, char **FirstToken)
+int bas2tap_PrepareLine (bas2tap_context *ctx, char *LineIn, int FileLineNo, char **FirstToken)
 
 /**********************************************************************************************************************************/
 /* Pre   : `LineIn' points to the read line, `FileLineNo' holds the real line number.                                             */
@@ -923,6 +963,7 @@ int bas2tap_PrepareLine (char *LineIn, int FileLineNo, char **FirstToken)
   bool   DoingREM        = FALSE;
   int    BasicLineNo     = -1;
 
+  Context = ctx;
   IndexIn = LineIn;
   IndexOut = bas2tap_ConvertedSpectrumLine;
   while (*IndexIn && StillOk)
@@ -3074,7 +3115,7 @@ bool CheckSyntax (int FileLineNo, byte *Line)
   return (AllOk);
 }
 
-int bas2tap_main (/*int argc, char **argv*/)
+int bas2tap_main (bas2tap_context *ctx/*int argc, char **argv*/)
 
 /**********************************************************************************************************************************/
 /* >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>> MAIN PROGRAM <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<< */
@@ -3188,6 +3229,7 @@ int bas2tap_main (/*int argc, char **argv*/)
   if (fwrite (&TapeHeader, 1, sizeof (struct TapeHeader_s), FpOut) < sizeof (struct TapeHeader_s))
   { AllOk = FALSE; WriteError = TRUE; }                                                        /* Write dummy header to get space */
   #endif
+  Context = ctx;
   while (AllOk && !EndOfFile)
   {
     if (bas2tap_fgets(&BasicIndex, &BasicLineNo))
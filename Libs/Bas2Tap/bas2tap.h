@@ -1,25 +1,45 @@
 #ifndef BAS2TAP_H
 #define BAS2TAP_H
 
-#ifndef BAS2TAP_EXTERN
-#define BAS2TAP_EXTERN extern
-#endif
+#include <stddef.h>
 
 #define MAXLINELENGTH 10240
 
+/* Sequence "{@@N}" in the line passed to bas2tap_PrepareLine is replaced with raw bytes returned by `embed' for index N */
+#define BAS2TAP_EMBED_PREFIX "{@@"
+
 #ifdef __cplusplus
 extern "C" {
 #endif
 
-BAS2TAP_EXTERN void (*bas2tap_error)(int line, int stmt, const char* fmt, ...);
-BAS2TAP_EXTERN int (*bas2tap_fgets)(char** basicIndex, int* basicLineNo);
-BAS2TAP_EXTERN void (*bas2tap_output)(const void* dst, size_t length);
-
-extern char bas2tap_ConvertedSpectrumLine[MAXLINELENGTH + 1];
-int bas2tap_PrepareLine(char* LineIn, int FileLineNo, char** FirstToken);
-
-void bas2tap_reset(void);
-int bas2tap_main(void);
+typedef struct bas2tap_context bas2tap_context;
+
+struct bas2tap_context
+{
+    void* user;
+    void (*error)(bas2tap_context* ctx, int line, int stmt, const char* fmt, ...);
+    int (*fgets)(bas2tap_context* ctx, char** basicIndex, int* basicLineNo);
+    void (*output)(bas2tap_context* ctx, const void* dst, size_t length);
+    int (*embed)(bas2tap_context* ctx, int index, const unsigned char** data, size_t* length);
+
+    char ConvertedSpectrumLine[MAXLINELENGTH + 1];
+    unsigned char ResultingLine[MAXLINELENGTH + 1];
+    int Is48KProgram;
+    int UsesInterface1;
+    unsigned char CaseIndependant;
+    unsigned char Quiet;
+    unsigned char NoWarnings;
+    unsigned char DoCheckSyntax;
+    unsigned char TokenBracket;
+    unsigned char HandlingDEFFN;
+    unsigned char InsideDEFFN;
+    int PreviousBasicLineNo;
+};
+
+int bas2tap_PrepareLine(bas2tap_context* ctx, char* LineIn, int FileLineNo, char** FirstToken);
+
+void bas2tap_reset(bas2tap_context* ctx);
+int bas2tap_main(bas2tap_context* ctx);
 
 #ifdef __cplusplus
 }
@@ -348,6 +348,9 @@ void lzsa_find_all_matches(lzsa_compressor *pCompressor, const int nMatchesPerOf
    int i;
 
    for (i = nStartOffset; i < nEndOffset; i++) {
+      if (((i - nStartOffset) & 1023) == 0 && lzsa_compressor_report_progress(pCompressor, i - nStartOffset, (nEndOffset - nStartOffset) * 3))
+         return;
+
       int nMatches = lzsa_find_matches_at(pCompressor, i, pMatch, nMatchesPerOffset, nEndOffset - nStartOffset);
 
       while (nMatches < nMatchesPerOffset) {
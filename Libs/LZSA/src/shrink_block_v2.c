@@ -298,6 +298,9 @@ static void lzsa_optimize_forward_v2(lzsa_compressor *pCompressor, const unsigne
       lzsa_arrival *cur_arrival = &arrival[i << ARRIVALS_PER_POSITION_SHIFT];
       int m;
 
+      if (((i - nStartOffset) & 1023) == 0 && lzsa_compressor_report_progress(pCompressor, (nEndOffset - nStartOffset) * (1 + nReduce) + (i - nStartOffset), (nEndOffset - nStartOffset) * 3))
+         return;
+
       for (j = 0; j < nArrivalsPerPosition && cur_arrival[j].from_slot; j++) {
          const int nPrevCost = cur_arrival[j].cost & 0x3fffffff;
          int nCodingChoiceCost = nPrevCost + 8 /* literal */;
@@ -1276,6 +1279,8 @@ int lzsa_optimize_and_write_block_v2(lzsa_compressor *pCompressor, const unsigne
    
    memset(pCompressor->best_match, 0, BLOCK_SIZE * sizeof(lzsa_match));
    lzsa_optimize_forward_v2(pCompressor, pInWindow, pCompressor->best_match - nPreviousBlockSize, nPreviousBlockSize, nPreviousBlockSize + nInDataSize, 0 /* reduce */, (nInDataSize < 65536) ? 1 : 0 /* insert forward reps */, nArrivalsPerPosition);
+   if (pCompressor->aborted)
+      return -1;
 
    int nDidReduce;
    int nPasses = 0;
@@ -1293,6 +1298,8 @@ int lzsa_optimize_and_write_block_v2(lzsa_compressor *pCompressor, const unsigne
       /* Compress optimally and do break ties in favor of less tokens */
       memset(pCompressor->improved_match, 0, BLOCK_SIZE * sizeof(lzsa_match));
       lzsa_optimize_forward_v2(pCompressor, pInWindow, pCompressor->improved_match - nPreviousBlockSize, nPreviousBlockSize, nPreviousBlockSize + nInDataSize, 1 /* reduce */, 0 /* use forward reps */, nArrivalsPerPosition);
+      if (pCompressor->aborted)
+         return -1;
 
       nPasses = 0;
       do {
@@ -75,6 +75,9 @@ int lzsa_compressor_init(lzsa_compressor *pCompressor, const int nMaxWindowSize,
    pCompressor->flags = nFlags;
    pCompressor->safe_dist = 0;
    pCompressor->num_commands = 0;
+   pCompressor->progress = NULL;
+   pCompressor->progress_user = NULL;
+   pCompressor->aborted = 0;
    
    memset(&pCompressor->stats, 0, sizeof(pCompressor->stats));
    pCompressor->stats.min_literals = -1;
@@ -229,7 +232,10 @@ int lzsa_compressor_shrink_block(lzsa_compressor *pCompressor, unsigned char *pI
       }
       lzsa_find_all_matches(pCompressor, (pCompressor->format_version == 2) ? NMATCHES_PER_INDEX_V2 : NMATCHES_PER_INDEX_V1, nPreviousBlockSize, nPreviousBlockSize + nInDataSize);
 
-      if (pCompressor->format_version == 1) {
+      if (pCompressor->aborted) {
+         nCompressedSize = -1;
+      }
+      else if (pCompressor->format_version == 1) {
          nCompressedSize = lzsa_optimize_and_write_block_v1(pCompressor, pInWindow, nPreviousBlockSize, nInDataSize, pOutData, nMaxOutDataSize);
          if (nCompressedSize != -1 && (pCompressor->flags & LZSA_FLAG_RAW_BACKWARD)) {
             lzsa_reverse_buffer(pOutData, nCompressedSize);
@@ -253,6 +259,23 @@ int lzsa_compressor_shrink_block(lzsa_compressor *pCompressor, unsigned char *pI
    return nCompressedSize;
 }
 
+/**
+ * Report compression progress to the progress callback, if any
+ *
+ * @param pCompressor compression context
+ * @param nCurrent amount of work done
+ * @param nTotal total amount of work
+ *
+ * @return non-zero if compression was aborted by the callback
+ */
+int lzsa_compressor_report_progress(lzsa_compressor *pCompressor, const int nCurrent, const int nTotal) {
+   if (!pCompressor->aborted && pCompressor->progress) {
+      if (pCompressor->progress(pCompressor->progress_user, nCurrent, nTotal))
+         pCompressor->aborted = 1;
+   }
+   return pCompressor->aborted;
+}
+
 /**
  * Get the number of compression commands issued in compressed data blocks
  *
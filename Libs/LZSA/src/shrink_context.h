@@ -134,6 +134,9 @@ typedef struct _lzsa_compressor {
    int safe_dist;
    int num_commands;
    lzsa_stats stats;
+   int (*progress)(void *pUser, int nCurrent, int nTotal);
+   void *progress_user;
+   int aborted;
 } lzsa_compressor;
 
 /**
@@ -169,6 +172,17 @@ void lzsa_compressor_destroy(lzsa_compressor *pCompressor);
  */
 int lzsa_compressor_shrink_block(lzsa_compressor *pCompressor, unsigned char *pInWindow, const int nPreviousBlockSize, const int nInDataSize, unsigned char *pOutData, const int nMaxOutDataSize);
 
+/**
+ * Report compression progress to the progress callback, if any
+ *
+ * @param pCompressor compression context
+ * @param nCurrent amount of work done
+ * @param nTotal total amount of work
+ *
+ * @return non-zero if compression was aborted by the callback
+ */
+int lzsa_compressor_report_progress(lzsa_compressor *pCompressor, const int nCurrent, const int nTotal);
+
 /**
  * Get the number of compression commands issued in compressed data blocks
  *
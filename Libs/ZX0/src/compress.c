@@ -28,6 +28,7 @@
 
 #include "zx0.h"
 
+typedef struct Ctx {
 unsigned char* output_data;
 int output_index;
 int input_index;
@@ -35,9 +36,22 @@ int bit_index;
 int bit_mask;
 int diff;
 int backtrack;
+} Ctx;
+
+#define output_data (ctx->output_data)
+#define output_index (ctx->output_index)
+#define input_index (ctx->input_index)
+#define bit_index (ctx->bit_index)
+#define bit_mask (ctx->bit_mask)
+#define diff (ctx->diff)
+#define backtrack (ctx->backtrack)
+#define read_bytes(n, delta) read_bytes_(ctx, n, delta)
+#define write_byte(value) write_byte_(ctx, value)
+#define write_bit(value) write_bit_(ctx, value)
+#define write_interlaced_elias_gamma(value, backwards_mode) write_interlaced_elias_gamma_(ctx, value, backwards_mode)
 
 static
-void read_bytes(int n, int *delta) {
+void read_bytes_(Ctx* ctx, int n, int *delta) {
     input_index += n;
     diff += n;
     if (diff > *delta)
@@ -45,13 +59,13 @@ void read_bytes(int n, int *delta) {
 }
 
 static
-void write_byte(int value) {
+void write_byte_(Ctx* ctx, int value) {
     output_data[output_index++] = value;
     diff--;
 }
 
 static
-void write_bit(int value) {
+void write_bit_(Ctx* ctx, int value) {
     if (backtrack) {
         if (value)
             output_data[output_index-1] |= 1;
@@ -69,7 +83,7 @@ void write_bit(int value) {
 }
 
 static
-void write_interlaced_elias_gamma(int value, int backwards_mode) {
+void write_interlaced_elias_gamma_(Ctx* ctx, int value, int backwards_mode) {
     int i;
 
     for (i = 2; i <= value; i <<= 1)
@@ -88,6 +102,7 @@ unsigned char *zx0_compress(BLOCK *optimal, unsigned char *input_data, int input
     int last_offset = INITIAL_OFFSET;
     int first = TRUE;
     int i;
+    Ctx ctx_, *ctx = &ctx_;
 
     /* calculate and allocate output buffer */
     *output_size = (optimal->bits+18+7)/8;
@@ -114,6 +129,7 @@ unsigned char *zx0_compress(BLOCK *optimal, unsigned char *input_data, int input
     input_index = skip;
     output_index = 0;
     bit_mask = 0;
+    backtrack = FALSE;
 
     for (optimal = next->chain; optimal; optimal = optimal->chain) {
         if (!optimal->offset) {
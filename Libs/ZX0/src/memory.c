@@ -34,12 +34,16 @@ struct ZX0Context {
 BLOCK *ghost_root/* = NULL*/;
 BLOCK *dead_array/* = NULL*/;
 int dead_array_size/* = 0*/;
+zx0_progress_callback progress;
+void* progress_user;
 };
 #define ghost_root (C->ghost_root)
 #define dead_array (C->dead_array)
 #define dead_array_size (C->dead_array_size)
 ZX0Context* zx0_new() { return calloc(1, sizeof(ZX0Context)); }
 void zx0_delete(ZX0Context* C) { if (C) { if (dead_array) free(dead_array); free(C); } }
+void zx0_set_progress(ZX0Context* C, zx0_progress_callback callback, void* user) { C->progress = callback; C->progress_user = user; }
+int zx0_report_progress(ZX0Context* C, int current, int total) { return C->progress ? C->progress(C->progress_user, current, total) : 0; }
 
 BLOCK *zx0_allocate(ZX0Context* C, int bits, int index, int offset, int length, BLOCK *chain) {
     BLOCK *ptr;
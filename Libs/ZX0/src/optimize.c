@@ -90,6 +90,8 @@ BLOCK** zx0_optimize(ZX0Context* C, unsigned char *input_data, int input_size, i
 
     /* process remaining bytes */
     for (index = skip; index < input_size; index++) {
+        if (((index - skip) & 255) == 0 && zx0_report_progress(C, index - skip, input_size - skip))
+            goto error;
         best_length_size = 2;
         max_offset = offset_ceiling(index, offset_limit);
         for (offset = 1; offset <= max_offset; offset++) {
@@ -32,6 +32,10 @@ struct ZX0Context;
 typedef struct ZX0Context ZX0Context;
 ZX0Context* zx0_new(void);
 void zx0_delete(ZX0Context* C);
+/* callback returns non-zero to abort compression */
+typedef int (*zx0_progress_callback)(void* user, int current, int total);
+void zx0_set_progress(ZX0Context* C, zx0_progress_callback callback, void* user);
+int zx0_report_progress(ZX0Context* C, int current, int total);
 #define BLOCK ZX0Block
 #define block_t zx0block_t
 typedef struct block_t {
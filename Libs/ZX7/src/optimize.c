@@ -44,7 +44,7 @@ static int count_bits(int offset, int len) {
     return 1 + (offset > 128 ? 12 : 8) + elias_gamma_bits(len-1);
 }
 
-Optimal* optimize(unsigned char *input_data, size_t input_size, long skip) {
+Optimal* optimize(unsigned char *input_data, size_t input_size, long skip, zx7_progress_callback progress, void *progress_user) {
     size_t *min;
     size_t *max;
     size_t *matches;
@@ -89,6 +89,15 @@ Optimal* optimize(unsigned char *input_data, size_t input_size, long skip) {
     /* process remaining bytes */
     for (; i < input_size; i++) {
 
+        if (progress && ((i - skip) & 1023) == 0 && progress(progress_user, i - skip, input_size - skip)) {
+            free(min);
+            free(max);
+            free(matches);
+            free(match_slots);
+            free(optimal);
+            return NULL;
+        }
+
         optimal[i].bits = optimal[i-1].bits + 9;
         match_index = input_data[i-1] << 8 | input_data[i];
         best_len = 1;
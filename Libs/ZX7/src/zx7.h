@@ -32,6 +32,9 @@ typedef struct optimal_t {
     int len;
 } Optimal;
 
-Optimal *zx7_optimize(unsigned char *input_data, size_t input_size, long skip);
+/* progress callback returns non-zero to abort compression; optimize returns NULL in that case */
+typedef int (*zx7_progress_callback)(void *user, size_t current, size_t total);
+
+Optimal *zx7_optimize(unsigned char *input_data, size_t input_size, long skip, zx7_progress_callback progress, void *progress_user);
 
 unsigned char *zx7_compress(Optimal *optimal, unsigned char *input_data, size_t input_size, long skip, size_t *output_size, long *delta);
@@ -0,0 +1,145 @@
+#include "BuildManifest.h"
+#include "Common/Hasher.h"
+#include "Common/IO.h"
+
+const char* BuildManifest::FileName = ".manifest";
+
+BuildManifest::BuildManifest(std::filesystem::path outputPath)
+    : mOutputPath(outputPath.lexically_normal())
+    , mModified(false)
+{
+}
+
+BuildManifest::~BuildManifest()
+{
+}
+
+uint64_t BuildManifest::hash(const void* data, size_t size)
+{
+    Hasher hasher;
+    hasher.add(data, size);
+    return hasher.value();
+}
+
+void BuildManifest::load()
+{
+    mEntries.clear();
+    mModified = false;
+
+    std::string data;
+    try {
+        auto path = mOutputPath / FileName;
+        if (!std::filesystem::exists(path))
+            return;
+        data = loadFile(path);
+    } catch (...) {
+        return;
+    }
+
+    std::stringstream ss(data);
+    std::string line;
+    while (std::getline(ss, line)) {
+        std::stringstream ls(line);
+        Entry entry;
+        ls >> std::hex >> entry.hash >> entry.fingerprint >> std::dec >> entry.size >> entry.modificationTime;
+        if (!ls || ls.get() != ' ') {
+            // Manifest is damaged; everything will be rewritten
+            mEntries.clear();
+            return;
+        }
+
+        std::string key;
+        std::getline(ls, key);
+        if (!key.empty())
+            mEntries[key] = entry;
+    }
+}
+
+void BuildManifest::save()
+{
+    if (!mModified)
+        return;
+
+    std::stringstream ss;
+    for (const auto& it : mEntries) {
+        ss << std::hex << std::setfill('0') << std::setw(16) << it.second.hash << ' '
+            << std::setw(16) << it.second.fingerprint << std::dec << ' '
+            << it.second.size << ' ' << it.second.modificationTime << ' ' << it.first << '\n';
+    }
+
+    ::writeFile(mOutputPath / FileName, ss.str());
+    mModified = false;
+}
+
+bool BuildManifest::writeFile(const std::filesystem::path& fileName, const std::string& str)
+{
+    return writeFile(fileName, str.data(), str.length());
+}
+
+bool BuildManifest::writeFile(const std::filesystem::path& fileName, const void* data, size_t size, uint64_t fingerprint)
+{
+    std::string key = keyForPath(fileName);
+    uint64_t contentHash = hash(data, size);
+
+    auto it = mEntries.find(key);
+    if (it != mEntries.end() && it->second.size == size && it->second.hash == contentHash
+            && isUnmodified(fileName, it->second)) {
+        if (it->second.fingerprint != fingerprint) {
+            it->second.fingerprint = fingerprint;
+            mModified = true;
+        }
+        return false;
+    }
+
+    ::writeFile(fileName, data, size);
+
+    Entry entry;
+    entry.size = size;
+    entry.hash = contentHash;
+    entry.fingerprint = fingerprint;
+    entry.modificationTime = int64_t(std::filesystem::last_write_time(fileName).time_since_epoch().count());
+    mEntries[key] = entry;
+    mModified = true;
+
+    return true;
+}
+
+bool BuildManifest::isUpToDate(const std::filesystem::path& fileName, uint64_t fingerprint) const
+{
+    auto it = mEntries.find(keyForPath(fileName));
+    return (it != mEntries.end() && it->second.fingerprint == fingerprint && isUnmodified(fileName, it->second));
+}
+
+void BuildManifest::addGeneratedFile(const std::filesystem::path& fileName, uint64_t fingerprint)
+{
+    Entry entry;
+    entry.size = std::filesystem::file_size(fileName);
+    entry.hash = 0;
+    entry.fingerprint = fingerprint;
+    entry.modificationTime = int64_t(std::filesystem::last_write_time(fileName).time_since_epoch().count());
+    mEntries[keyForPath(fileName)] = entry;
+    mModified = true;
+}
+
+bool BuildManifest::isUnmodified(const std::filesystem::path& fileName, const Entry& entry) const
+{
+    std::error_code error;
+    auto fileSize = std::filesystem::file_size(fileName, error);
+    if (error || fileSize != entry.size)
+        return false;
+
+    auto time = std::filesystem::last_write_time(fileName, error);
+    return (!error && int64_t(time.time_since_epoch().count()) == entry.modificationTime);
+}
+
+std::string BuildManifest::keyForPath(const std::filesystem::path& fileName) const
+{
+    auto path = fileName.lexically_normal();
+    auto relative = path.lexically_relative(mOutputPath);
+    if (!relative.empty())
+        path = std::move(relative);
+
+    std::string key = pathToUtf8(path);
+    std::replace(key.begin(), key.end(), '\\', '/');
+    return key;
+}
@@ -0,0 +1,46 @@
+#ifndef COMMON_BUILDMANIFEST_H
+#define COMMON_BUILDMANIFEST_H
+
+#include "Common/Common.h"
+
+class BuildManifest
+{
+public:
+    static const char* FileName;
+
+    explicit BuildManifest(std::filesystem::path outputPath);
+    ~BuildManifest();
+
+    static uint64_t hash(const void* data, size_t size);
+
+    void load();
+    void save();
+
+    bool writeFile(const std::filesystem::path& fileName, const std::string& str);
+    bool writeFile(const std::filesystem::path& fileName, const void* data, size_t size, uint64_t fingerprint = 0);
+
+    // Fingerprint identifies inputs the file was generated from; file is up to date if it was not modified since
+    bool isUpToDate(const std::filesystem::path& fileName, uint64_t fingerprint) const;
+    void addGeneratedFile(const std::filesystem::path& fileName, uint64_t fingerprint);
+
+private:
+    struct Entry
+    {
+        uint64_t size;
+        int64_t modificationTime;
+        uint64_t hash;
+        uint64_t fingerprint;
+    };
+
+    bool isUnmodified(const std::filesystem::path& fileName, const Entry& entry) const;
+
+    std::filesystem::path mOutputPath;
+    std::map<std::string, Entry> mEntries;
+    bool mModified;
+
+    std::string keyForPath(const std::filesystem::path& fileName) const;
+
+    DISABLE_COPY(BuildManifest);
+};
+
+#endif
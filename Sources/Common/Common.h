@@ -30,6 +30,7 @@
 #include <map>
 #include <iomanip>
 #include <mutex>
+#include <future>
 
 #define DISABLE_COPY(NAME) \
     NAME(const NAME&) = delete; \
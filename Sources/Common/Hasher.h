@@ -0,0 +1,30 @@
+#ifndef COMMON_HASHER_H
+#define COMMON_HASHER_H
+
+#include "Common/Common.h"
+
+// Incremental 64-bit FNV-1a hash
+class Hasher
+{
+public:
+    Hasher() : mHash(0xcbf29ce484222325ull) {}
+
+    void add(const void* data, size_t size)
+    {
+        const uint8_t* p = reinterpret_cast<const uint8_t*>(data);
+        for (size_t i = 0; i < size; i++) {
+            mHash ^= p[i];
+            mHash *= 0x100000001b3ull;
+        }
+    }
+
+    void add(int64_t value) { add(&value, sizeof(value)); }
+    void add(const std::string& str) { add(int64_t(str.length())); add(str.data(), str.length()); }
+
+    uint64_t value() const { return mHash; }
+
+private:
+    uint64_t mHash;
+};
+
+#endif
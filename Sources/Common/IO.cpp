@@ -1,5 +1,15 @@
 #include "IO.h"
 #include "Common/Strings.h"
+#include <atomic>
+#include <chrono>
+#include <random>
+
+#ifndef _WIN32
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
 
 namespace
 {
@@ -37,9 +47,8 @@ namespace
     };
 }
 
-[[noreturn]] static void error(const char* message, const std::filesystem::path& fileName)
+[[noreturn]] static void error(const char* message, const std::filesystem::path& fileName, const std::string& errorText)
 {
-    const char* error = strerror(errno);
     std::stringstream ss;
 
     for (const char* p = message; *p; ) {
@@ -54,7 +63,7 @@ namespace
                 ss << '"' << fileName << '"';
                 break;
             case 'e':
-                ss << error;
+                ss << errorText;
                 break;
         }
     }
@@ -62,6 +71,27 @@ namespace
     throw std::runtime_error(ss.str());
 }
 
+[[noreturn]] static void error(const char* message, const std::filesystem::path& fileName)
+{
+    error(message, fileName, strerror(errno));
+}
+
+// Concurrent builds may write the same file, so each writer gets its own temporary file
+static std::filesystem::path tempFileNameFor(const std::filesystem::path& fileName)
+{
+    static const uint64_t session = (uint64_t(std::random_device()()) << 32)
+        ^ uint64_t(std::chrono::steady_clock::now().time_since_epoch().count());
+    static std::atomic<uint32_t> counter;
+
+    std::stringstream ss;
+    ss << '.' << std::hex << std::setfill('0') << std::setw(16) << session
+       << '-' << std::setw(8) << counter++ << ".tmp";
+
+    std::filesystem::path tempFileName = fileName;
+    tempFileName += ss.str();
+    return tempFileName;
+}
+
 std::filesystem::path pathFromUtf8(const std::string& name)
 {
   #ifdef _WIN32
@@ -110,6 +140,137 @@ std::string loadFile(const std::filesystem::path& fileName)
     return buffer;
 }
 
+MappedFile::MappedFile(const std::filesystem::path& fileName)
+    : mData(nullptr)
+    , mSize(0)
+    , mMappedSize(0)
+{
+  #ifdef _WIN32
+    mBuffer = loadFile(fileName);
+    mData = &mBuffer[0];
+    mSize = mBuffer.length();
+  #else
+    int fd = open(fileName.c_str(), O_RDONLY);
+    if (fd < 0)
+        error("Unable to open file %f: %e", fileName);
+
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+        int err = errno;
+        close(fd);
+        errno = err;
+        error("Unable to determine size of file %f: %e", fileName);
+    }
+
+    mSize = size_t(st.st_size);
+    if (mSize == 0) {
+        close(fd);
+        mData = &mBuffer[0];
+        return;
+    }
+
+    // Reserve at least one extra zero-filled byte past the end of file so that the data is NUL-terminated
+    size_t pageSize = size_t(sysconf(_SC_PAGESIZE));
+    mMappedSize = (mSize + pageSize) & ~(pageSize - 1);
+
+    void* reserved = mmap(nullptr, mMappedSize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (reserved == MAP_FAILED) {
+        int err = errno;
+        close(fd);
+        errno = err;
+        error("Unable to map file %f: %e", fileName);
+    }
+
+    void* mapped = mmap(reserved, mSize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_FIXED, fd, 0);
+    int err = errno;
+    close(fd);
+    if (mapped == MAP_FAILED) {
+        munmap(reserved, mMappedSize);
+        errno = err;
+        error("Unable to map file %f: %e", fileName);
+    }
+
+    mData = reinterpret_cast<char*>(mapped);
+  #endif
+}
+
+MappedFile::~MappedFile()
+{
+  #ifndef _WIN32
+    if (mMappedSize != 0)
+        munmap(mData, mMappedSize);
+  #endif
+}
+
+FileWriter::FileWriter(std::filesystem::path fileName)
+    : mFileName(std::move(fileName))
+{
+    std::filesystem::path dir = mFileName;
+    dir.remove_filename();
+    std::filesystem::create_directories(dir);
+
+    mTempFileName = tempFileNameFor(mFileName);
+
+  #ifdef _WIN32
+    mHandle = _wfopen(mTempFileName.c_str(), L"wb");
+  #else
+    mHandle = fopen(mTempFileName.c_str(), "wb");
+  #endif
+    if (!mHandle)
+        error("Unable to open file %f for writing: %e", mTempFileName);
+}
+
+FileWriter::~FileWriter()
+{
+    if (mHandle) {
+        fclose(mHandle);
+        std::error_code error;
+        std::filesystem::remove(mTempFileName, error);
+    }
+}
+
+void FileWriter::write(const void* data, size_t size)
+{
+    size_t bytesWritten = fwrite(data, 1, size, mHandle);
+    if (ferror(mHandle))
+        error("Unable to write file %f: %e", mTempFileName);
+    if (bytesWritten != size)
+        error("Incomplete write in file %f.", mTempFileName);
+}
+
+void FileWriter::writeAt(size_t offset, const void* data, size_t size)
+{
+    long position = ftell(mHandle);
+    if (position < 0 || fseek(mHandle, long(offset), SEEK_SET) != 0)
+        error("Seek failed in file %f: %e", mTempFileName);
+
+    write(data, size);
+
+    if (fseek(mHandle, position, SEEK_SET) != 0)
+        error("Seek failed in file %f: %e", mTempFileName);
+}
+
+void FileWriter::commit()
+{
+    FILE* handle = mHandle;
+    mHandle = nullptr;
+    if (fclose(handle) != 0) {
+        int err = errno;
+        std::error_code errorCode;
+        std::filesystem::remove(mTempFileName, errorCode);
+        errno = err;
+        error("Unable to write file %f: %e", mTempFileName);
+    }
+
+    std::error_code errorCode;
+    std::filesystem::rename(mTempFileName, mFileName, errorCode);
+    if (errorCode) {
+        std::error_code removeError;
+        std::filesystem::remove(mTempFileName, removeError);
+        error("Unable to replace file %f: %e", mFileName, errorCode.message());
+    }
+}
+
 void writeFile(const std::filesystem::path& fileName, const char* str, int flags)
 {
     return writeFile(fileName, str, strlen(str), flags);
@@ -122,10 +283,6 @@ void writeFile(const std::filesystem::path& fileName, const std::string& str, in
 
 void writeFile(const std::filesystem::path& fileName, const void* data, size_t size, int flags)
 {
-    std::filesystem::path dir = fileName;
-    dir.remove_filename();
-    std::filesystem::create_directories(dir);
-
     auto status = std::filesystem::status(fileName);
     bool fileExists = std::filesystem::exists(status) && !std::filesystem::is_directory(status);
 
@@ -137,30 +294,7 @@ void writeFile(const std::filesystem::path& fileName, const void* data, size_t s
             error("File %f already exists.", fileName);
     }
 
-    if (fileExists && (flags & SkipIfSameContent) != 0) {
-        try {
-            std::string oldContent = loadFile(fileName);
-            if (oldContent.size() == size && memcmp(oldContent.data(), data, size) == 0)
-                return;
-        } catch (...) {
-        }
-    }
-
-  #ifdef _WIN32
-    FileHandle f{_wfopen(fileName.c_str(), L"wb"), fileName};
-  #else
-    FileHandle f{fopen(fileName.c_str(), "wb"), fileName};
-  #endif
-    if (!f)
-        error("Unable to open file %f for writing: %e", fileName);
-
-    f.setDeleteOnClose(true);
-
-    size_t bytesWritten = fwrite(data, 1, size, f);
-    if (ferror(f))
-        error("Unable to write file %f: %e", fileName);
-    if (bytesWritten != size)
-        error("Incomplete write in file %f.", fileName);
-
-    f.setDeleteOnClose(false);
+    FileWriter writer(fileName);
+    writer.write(data, size);
+    writer.commit();
 }
@@ -7,7 +7,6 @@ enum WriteFlag
 {
     FailIfExists = 0x01,
     SkipIfExists = 0x02,
-    SkipIfSameContent = 0x04,
 };
 
 std::filesystem::path pathFromUtf8(const std::string& name);
@@ -15,6 +14,47 @@ std::string pathToUtf8(const std::filesystem::path& path);
 
 std::string loadFile(const std::filesystem::path& fileName);
 
+class MappedFile
+{
+public:
+    explicit MappedFile(const std::filesystem::path& fileName);
+    ~MappedFile();
+
+    // Contents are always followed by a NUL byte. Writes are private to this mapping.
+    char* data() { return mData; }
+    const char* data() const { return mData; }
+    size_t size() const { return mSize; }
+    bool empty() const { return mSize == 0; }
+
+private:
+    char* mData;
+    size_t mSize;
+    size_t mMappedSize;
+    std::string mBuffer;
+
+    DISABLE_COPY(MappedFile);
+};
+
+// Writes into a temporary file that replaces the target file on commit()
+class FileWriter
+{
+public:
+    explicit FileWriter(std::filesystem::path fileName);
+    ~FileWriter();
+
+    void write(const void* data, size_t size);
+    void writeAt(size_t offset, const void* data, size_t size);
+
+    void commit();
+
+private:
+    FILE* mHandle;
+    std::filesystem::path mFileName;
+    std::filesystem::path mTempFileName;
+
+    DISABLE_COPY(FileWriter);
+};
+
 void writeFile(const std::filesystem::path& fileName, const char* str, int flags = 0);
 void writeFile(const std::filesystem::path& fileName, const std::string& str, int flags = 0);
 void writeFile(const std::filesystem::path& fileName, const void* data, size_t size, int flags = 0);
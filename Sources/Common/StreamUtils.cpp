@@ -10,3 +10,14 @@ void writeWordLE(std::stringstream& ss, uint16_t byte)
     ss << static_cast<unsigned char>(byte & 0xff);
     ss << static_cast<unsigned char>((byte >> 8) & 0xff);
 }
+
+void writeByte(uint8_t*& p, uint8_t byte)
+{
+    *p++ = byte;
+}
+
+void writeWordLE(uint8_t*& p, uint16_t word)
+{
+    *p++ = uint8_t(word & 0xff);
+    *p++ = uint8_t((word >> 8) & 0xff);
+}
@@ -6,4 +6,7 @@
 void writeByte(std::stringstream& ss, uint8_t byte);
 void writeWordLE(std::stringstream& ss, uint16_t byte);
 
+void writeByte(uint8_t*& p, uint8_t byte);
+void writeWordLE(uint8_t*& p, uint16_t word);
+
 #endif
@@ -7,14 +7,14 @@ XmlDocument xmlLoad(const std::filesystem::path& path)
     auto xml = std::make_unique<TinyXmlDocument>();
 
     xml->path = path;
-    xml->data = loadFile(path);
-    if (xml->data.empty()) {
+    MappedFile data(path);
+    if (data.empty()) {
         std::stringstream ss;
         ss << "File \"" << xml->path.string() << "\" is empty.";
         throw std::runtime_error(ss.str());
     }
 
-    if (!xml->doc.LoadMemory(&xml->data[0], xml->data.length(), TIXML_ENCODING_UTF8)) {
+    if (!xml->doc.LoadMemory(data.data(), long(data.size()), TIXML_ENCODING_UTF8)) {
         std::stringstream ss;
         ss << "Parse error in XML file \"" << xml->path.string() << "\" at line "
             << xml->doc.ErrorRow() << ", column " << xml->doc.ErrorCol() << ": " << xml->doc.ErrorDesc();
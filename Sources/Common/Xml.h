@@ -46,7 +46,6 @@
 struct TinyXmlDocument
 {
     std::filesystem::path path;
-    std::string data;
     TiXmlDocument doc;
 };
 
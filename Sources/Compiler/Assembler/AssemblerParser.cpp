@@ -8,7 +8,9 @@
 #include "Compiler/Assembler/AssemblerContextRepeat.h"
 #include "Compiler/Assembler/AssemblerContextIf.h"
 #include "Compiler/Assembler/MacroEnsure.h"
+#include "Compiler/Assembler/MacroEnsureTStates.h"
 #include "Compiler/Assembler/Label.h"
+#include "Compiler/Assembler/RelaxedJump.h"
 #include "Compiler/Tree/Symbol.h"
 #include "Compiler/Tree/SymbolTable.h"
 #include "Compiler/Linker/Program.h"
@@ -34,6 +36,8 @@ const std::unordered_map<std::string, void(AssemblerParser::*)()> AssemblerParse
         { "else", &AssemblerParser::parseElseDecl },
         { "endif", &AssemblerParser::parseEndIfDecl },
         { "ensure", &AssemblerParser::parseEnsureDecl },
+        { "ensuretstates", &AssemblerParser::parseEnsureTStatesDecl },
+        { "timing", &AssemblerParser::parseEnsureTStatesDecl },
         /*
         { "allowwrite", &AssemblerParser::parseAllowWrite },
         { "disallowwrite", &AssemblerParser::parseDisallowWrite },
@@ -296,6 +300,42 @@ void AssemblerParser::parseEnsureDecl()
     expectEol();
 }
 
+void AssemblerParser::parseEnsureTStatesDecl()
+{
+    SourceLocation* location = mToken->location();
+
+    mToken = mToken->next();
+    expectNotEol();
+
+    auto start = ParsingContext(mHeap,
+        mToken, mContext, mSymbolTable, &mContext->localLabelsPrefix(), false).unambiguousExpression(false);
+
+    expectComma();
+    mToken = mToken->next();
+    expectNotEol();
+
+    auto end = ParsingContext(mHeap,
+        mToken, mContext, mSymbolTable, &mContext->localLabelsPrefix(), false).unambiguousExpression(false);
+
+    expectComma();
+    mToken = mToken->next();
+    expectNotEol();
+
+    bool exact = true;
+    if (mToken->id() == TOK_LESSEQ) {
+        exact = false;
+        mToken = mToken->next();
+        expectNotEol();
+    }
+
+    auto tStates = ParsingContext(mHeap,
+        mToken, mContext, mSymbolTable, &mContext->localLabelsPrefix(), false).unambiguousExpression(false);
+
+    mContext->addInstruction(new (mHeap) MacroEnsureTStates(location, start, end, tStates, exact));
+
+    expectEol();
+}
+
 /*
 void AssemblerParser::parseAllowWrite()
 {
@@ -486,6 +526,9 @@ Instruction* AssemblerParser::parseOpcode()
     SourceLocation* location = mToken->location();
     const char* matchedOpcode = nullptr;
 
+    if (mToken->id() >= TOK_IDENTIFIER && equalCaseInsensitive(mToken->text(), "jmp"))
+        return parseRelaxedJump();
+
     #define Z80_OPCODE_0(OP, BYTES, TSTATES) \
         { \
             ParsingContext context(mHeap, mToken, mContext, mSymbolTable, &mContext->localLabelsPrefix(), false); \
@@ -534,6 +577,37 @@ Instruction* AssemblerParser::parseOpcode()
     return nullptr;
 }
 
+Instruction* AssemblerParser::parseRelaxedJump()
+{
+    SourceLocation* location = mToken->location();
+
+    for (int i = 0; i <= RelaxedJump::Always; i++) {
+        auto condition = RelaxedJump::Condition(i);
+
+        ParsingContext context(mHeap, mToken, mContext, mSymbolTable, &mContext->localLabelsPrefix(), false);
+        context.nextToken();
+
+        if (condition != RelaxedJump::Always) {
+            if (!context.consumeIdentifier(RelaxedJump::conditionName(condition)) || !context.consumeComma())
+                continue;
+        }
+
+        Expr* target = nullptr;
+        if (!context.expression(target, &Z80::RegisterNames, &Z80::ConditionNames, false, true))
+            continue;
+        context.setupHereVariable(target, 1);
+        if (!context.checkEnd())
+            continue;
+
+        if (mContext->currentSection())
+            mContext->currentSection()->setHasRelaxableBranches();
+
+        return new (mHeap) RelaxedJump(location, condition, target);
+    }
+
+    throw CompilerError(location, "invalid operands for opcode 'JMP'.");
+}
+
 std::string AssemblerParser::readLabelName()
 {
     switch (mToken->id()) {
@@ -577,13 +651,14 @@ const char* AssemblerParser::consumeIdentifier()
     return text;
 }
 
-/*
-void AssemblerParser::expectComma(int tokenId)
+void AssemblerParser::expectComma()
 {
-    if (tokenId != T_COMMA)
-        error(tr("expected ','"));
+    if (mToken->id() != TOK_COMMA) {
+        std::stringstream ss;
+        ss << "expected ',', found " << mToken->name() << '.';
+        throw CompilerError(mToken->location(), ss.str());
+    }
 }
-*/
 
 void AssemblerParser::expectEol()
 {
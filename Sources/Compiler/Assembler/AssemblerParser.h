@@ -40,6 +40,7 @@ private:
     void parseElseDecl();
     void parseEndIfDecl();
     void parseEnsureDecl();
+    void parseEnsureTStatesDecl();
     /*
     void parseAllowWrite();
     void parseDisallowWrite();
@@ -56,11 +57,12 @@ private:
     void parseDefSpace();
 
     Instruction* parseOpcode();
+    Instruction* parseRelaxedJump();
 
     std::string readLabelName();
 
     const char* consumeIdentifier();
-    //void expectComma(int tokenId);
+    void expectComma();
     void expectEol();
     void expectNotEol();
 
@@ -2,6 +2,7 @@
 #include "Compiler/CompilerError.h"
 #include "Compiler/Linker/CodeEmitter.h"
 #include "Compiler/Tree/Expr.h"
+#include "Compiler/Tree/SymbolReferences.h"
 
 ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
@@ -37,6 +38,11 @@ bool DEFB::emitCode(CodeEmitter* emitter,
     return true;
 }
 
+void DEFB::collectReferences(SymbolReferences& refs) const
+{
+    mValue->collectReferences(refs);
+}
+
 Instruction* DEFB::clone() const
 {
     return new (heap()) DEFB(location(), mValue);
@@ -117,6 +123,11 @@ bool DEFW::emitCode(CodeEmitter* emitter, int64_t& nextAddress,
     return true;
 }
 
+void DEFW::collectReferences(SymbolReferences& refs) const
+{
+    mValue->collectReferences(refs);
+}
+
 Instruction* DEFW::clone() const
 {
     return new (heap()) DEFW(location(), mValue);
@@ -165,6 +176,11 @@ bool DEFD::emitCode(CodeEmitter* emitter, int64_t& nextAddress,
     return true;
 }
 
+void DEFD::collectReferences(SymbolReferences& refs) const
+{
+    mValue->collectReferences(refs);
+}
+
 Instruction* DEFD::clone() const
 {
     return new (heap()) DEFD(location(), mValue);
@@ -207,6 +223,11 @@ bool DEFS::emitCode(CodeEmitter* emitter, int64_t& nextAddress,
     return true;
 }
 
+void DEFS::collectReferences(SymbolReferences& refs) const
+{
+    mValue->collectReferences(refs);
+}
+
 Instruction* DEFS::clone() const
 {
     return new (heap()) DEFS(location(), mValue);
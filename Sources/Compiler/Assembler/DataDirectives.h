@@ -18,6 +18,7 @@ public:
     bool canEmitCodeWithoutBaseAddress(ISectionResolver* sectionResolver) const override;
     bool emitCode(CodeEmitter* emitter, int64_t& nextAddress, ISectionResolver* sectionResolver,
         std::unique_ptr<CompilerError>& resolveError) const override;
+    void collectReferences(SymbolReferences& refs) const override;
 
     Instruction* clone() const override;
 
@@ -63,6 +64,7 @@ public:
     bool canEmitCodeWithoutBaseAddress(ISectionResolver* sectionResolver) const override;
     bool emitCode(CodeEmitter* emitter, int64_t& nextAddress, ISectionResolver* sectionResolver,
         std::unique_ptr<CompilerError>& resolveError) const override;
+    void collectReferences(SymbolReferences& refs) const override;
 
     Instruction* clone() const override;
 
@@ -85,6 +87,7 @@ public:
     bool canEmitCodeWithoutBaseAddress(ISectionResolver* sectionResolver) const override;
     bool emitCode(CodeEmitter* emitter, int64_t& nextAddress, ISectionResolver* sectionResolver,
         std::unique_ptr<CompilerError>& resolveError) const override;
+    void collectReferences(SymbolReferences& refs) const override;
 
     Instruction* clone() const override;
 
@@ -107,6 +110,7 @@ public:
     bool canEmitCodeWithoutBaseAddress(ISectionResolver* sectionResolver) const override;
     bool emitCode(CodeEmitter* emitter, int64_t& nextAddress, ISectionResolver* sectionResolver,
         std::unique_ptr<CompilerError>& resolveError) const override;
+    void collectReferences(SymbolReferences& refs) const override;
 
     Instruction* clone() const override;
 
@@ -66,6 +66,20 @@ void Instruction::unresolveLabel()
     }
 }
 
+bool Instruction::collectBranchDisplacements(std::vector<BranchDisplacement>&,
+    int64_t& nextAddress, ISectionResolver* sectionResolver, std::unique_ptr<CompilerError>& resolveError) const
+{
+    size_t size;
+    if (!calculateSizeInBytes(size, sectionResolver, resolveError))
+        return false;
+    nextAddress += int64_t(size);
+    return true;
+}
+
+void Instruction::collectReferences(SymbolReferences&) const
+{
+}
+
 void Instruction::resetCounters() const
 {
 }
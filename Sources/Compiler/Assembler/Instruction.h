@@ -7,6 +7,8 @@
 class ISectionResolver;
 class CodeEmitter;
 class CompilerError;
+struct BranchDisplacement;
+struct SymbolReferences;
 
 class Instruction : public GCObject
 {
@@ -37,6 +39,9 @@ public:
     virtual bool canEmitCodeWithoutBaseAddress(ISectionResolver* sectionResolver) const = 0;
     virtual bool emitCode(CodeEmitter* emitter, int64_t& nextAddress, ISectionResolver* sectionResolver,
         std::unique_ptr<CompilerError>& resolveError) const = 0;
+    virtual bool collectBranchDisplacements(std::vector<BranchDisplacement>& displacements, int64_t& nextAddress,
+        ISectionResolver* sectionResolver, std::unique_ptr<CompilerError>& resolveError) const;
+    virtual void collectReferences(SymbolReferences& refs) const;
 
     virtual Instruction* clone() const = 0;
 
@@ -1,6 +1,7 @@
 #include "Instructions.Z80.h"
 #include "Compiler/Linker/CodeEmitter.h"
 #include "Compiler/Token.h"
+#include "Compiler/Tree/SymbolReferences.h"
 #include "Compiler/CompilerError.h"
 
 ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -61,6 +62,11 @@ bool Z80::bit::canEvaluate(const int64_t* nextAddress,
     return mValue->canEvaluateValue(nextAddress, sectionResolver, resolveError);
 }
 
+void Z80::bit::collectReferences(SymbolReferences& refs) const
+{
+    mValue->collectReferences(refs);
+}
+
 int Z80::bit::value(int64_t currentAddress, ISectionResolver* sectionResolver, uint8_t baseByte) const
 {
     Value value = mValue->evaluateValue(&currentAddress, sectionResolver);
@@ -90,6 +96,11 @@ bool Z80::byte::canEvaluate(const int64_t* nextAddress,
     return mValue->canEvaluateValue(nextAddress, sectionResolver, resolveError);
 }
 
+void Z80::byte::collectReferences(SymbolReferences& refs) const
+{
+    mValue->collectReferences(refs);
+}
+
 int Z80::byte::value(int64_t currentAddress, ISectionResolver* sectionResolver) const
 {
     return mValue->evaluateByte(&currentAddress, sectionResolver);
@@ -116,6 +127,11 @@ bool Z80::word::canEvaluate(const int64_t* nextAddress,
     return mValue->canEvaluateValue(nextAddress, sectionResolver, resolveError);
 }
 
+void Z80::word::collectReferences(SymbolReferences& refs) const
+{
+    mValue->collectReferences(refs);
+}
+
 int Z80::word::low(int64_t currentAddress, ISectionResolver* sectionResolver, int& high) const
 {
     auto word = mValue->evaluateWord(&currentAddress, sectionResolver);
@@ -218,6 +234,11 @@ bool Z80::memAddr::canEvaluate(const int64_t* nextAddress,
     return mValue->canEvaluateValue(nextAddress, sectionResolver, resolveError);
 }
 
+void Z80::memAddr::collectReferences(SymbolReferences& refs) const
+{
+    mValue->collectReferences(refs);
+}
+
 int Z80::memAddr::low(int64_t currentAddress, ISectionResolver* sectionResolver, int& high) const
 {
     auto word = mValue->evaluateWord(&currentAddress, sectionResolver);
@@ -272,6 +293,11 @@ bool Z80::IX_byte::canEvaluate(const int64_t* nextAddress,
     return mValue->canEvaluateValue(nextAddress, sectionResolver, resolveError);
 }
 
+void Z80::IX_byte::collectReferences(SymbolReferences& refs) const
+{
+    mValue->collectReferences(refs);
+}
+
 int Z80::IX_byte::value(int64_t currentAddress, ISectionResolver* sectionResolver) const
 {
     return mValue->evaluateByte(&currentAddress, sectionResolver);
@@ -326,6 +352,11 @@ bool Z80::IY_byte::canEvaluate(const int64_t* nextAddress,
     return mValue->canEvaluateValue(nextAddress, sectionResolver, resolveError);
 }
 
+void Z80::IY_byte::collectReferences(SymbolReferences& refs) const
+{
+    mValue->collectReferences(refs);
+}
+
 int Z80::IY_byte::value(int64_t currentAddress, ISectionResolver* sectionResolver) const
 {
     return mValue->evaluateByte(&currentAddress, sectionResolver);
@@ -352,6 +383,11 @@ bool Z80::relOffset::canEvaluate(const int64_t* nextAddress,
     return mValue->canEvaluateValue(nextAddress, sectionResolver, resolveError);
 }
 
+void Z80::relOffset::collectReferences(SymbolReferences& refs) const
+{
+    mValue->collectReferences(refs);
+}
+
 int Z80::relOffset::value(int64_t currentAddress, ISectionResolver* sectionResolver, int64_t nextAddress) const
 {
     return mValue->evaluateByteOffset(nextAddress, &currentAddress, sectionResolver);
@@ -392,6 +428,11 @@ bool Z80::portAddr::canEvaluate(const int64_t* nextAddress,
     return mValue->canEvaluateValue(nextAddress, sectionResolver, resolveError);
 }
 
+void Z80::portAddr::collectReferences(SymbolReferences& refs) const
+{
+    mValue->collectReferences(refs);
+}
+
 int Z80::portAddr::value(int64_t currentAddress, ISectionResolver* sectionResolver) const
 {
     return mValue->evaluateByte(&currentAddress, sectionResolver);
@@ -415,6 +456,11 @@ bool Z80::intMode::canEvaluate(const int64_t* nextAddress,
     return mValue->canEvaluateValue(nextAddress, sectionResolver, resolveError);
 }
 
+void Z80::intMode::collectReferences(SymbolReferences& refs) const
+{
+    mValue->collectReferences(refs);
+}
+
 int Z80::intMode::value(int64_t currentAddress, ISectionResolver* sectionResolver) const
 {
     Value value = mValue->evaluateValue(&currentAddress, sectionResolver);
@@ -444,6 +490,11 @@ bool Z80::rstIndex::canEvaluate(const int64_t* nextAddress,
     return mValue->canEvaluateValue(nextAddress, sectionResolver, resolveError);
 }
 
+void Z80::rstIndex::collectReferences(SymbolReferences& refs) const
+{
+    mValue->collectReferences(refs);
+}
+
 int Z80::rstIndex::value(int64_t currentAddress, ISectionResolver* sectionResolver, uint8_t baseByte) const
 {
     Value value = mValue->evaluateValue(&currentAddress, sectionResolver);
@@ -502,6 +553,8 @@ bool Z80::AF_::tryParse(ParsingContext* context, size_t)
         int high; (void)high;\
         (void)nextAddress; \
         (void)sectionResolver; \
+        const TStates tStates = TSTATES; \
+        emitter->addTStates(nextAddress, tStates.t1, tStates.t2); \
         emitter->emitBytes(location(), OP##_bytes.data(), OP##_bytes.size()); \
         nextAddress += OP##_bytes.size(); \
         return true; \
@@ -542,6 +595,8 @@ bool Z80::AF_::tryParse(ParsingContext* context, size_t)
         if (!mOp1.canEvaluate(&nextAddress, sectionResolver, resolveError)) \
             return false; \
         auto array = toUInt8Array BYTES; \
+        const TStates tStates = TSTATES; \
+        emitter->addTStates(nextAddress, tStates.t1, tStates.t2); \
         emitter->emitBytes(location(), array.data(), array.size()); \
         nextAddress += array.size(); \
         return true; \
@@ -584,6 +639,8 @@ bool Z80::AF_::tryParse(ParsingContext* context, size_t)
                 || !mOp2.canEvaluate(&nextAddress, sectionResolver, resolveError)) \
             return false; \
         auto array = toUInt8Array BYTES; \
+        const TStates tStates = TSTATES; \
+        emitter->addTStates(nextAddress, tStates.t1, tStates.t2); \
         emitter->emitBytes(location(), array.data(), array.size()); \
         nextAddress += array.size(); \
         return true; \
@@ -103,6 +103,7 @@ namespace Z80
         bool tryParse(ParsingContext* c, size_t offset);
         bool canEvaluate(const int64_t* nextAddress,
             ISectionResolver* sectionResolver, std::unique_ptr<CompilerError>& resolveError) const;
+        void collectReferences(SymbolReferences& refs) const;
         int value(int64_t currentAddress, ISectionResolver* sectionResolver, uint8_t baseByte) const;
     private:
         Expr* mValue;
@@ -111,10 +112,12 @@ namespace Z80
     class byte
     {
     public:
+        Expr* expr() const { return mValue; }
         void toString(std::stringstream& ss) const;
         bool tryParse(ParsingContext* c, size_t offset);
         bool canEvaluate(const int64_t* nextAddress,
             ISectionResolver* sectionResolver, std::unique_ptr<CompilerError>& resolveError) const;
+        void collectReferences(SymbolReferences& refs) const;
         int value(int64_t currentAddress, ISectionResolver* sectionResolver) const;
     private:
         Expr* mValue;
@@ -123,10 +126,12 @@ namespace Z80
     class word
     {
     public:
+        Expr* expr() const { return mValue; }
         void toString(std::stringstream& ss) const;
         bool tryParse(ParsingContext* c, size_t offset);
         bool canEvaluate(const int64_t* nextAddress,
             ISectionResolver* sectionResolver, std::unique_ptr<CompilerError>& resolveError) const;
+        void collectReferences(SymbolReferences& refs) const;
         int low(int64_t currentAddress, ISectionResolver* sectionResolver, int& high) const;
     private:
         Expr* mValue;
@@ -137,6 +142,7 @@ namespace Z80
         void toString(std::stringstream& ss) const;
         bool tryParse(ParsingContext* c, size_t offset);
         bool canEvaluate(const int64_t*, ISectionResolver*, std::unique_ptr<CompilerError>&) const { return true; }
+        void collectReferences(SymbolReferences&) const {}
     };
 
     struct memDE
@@ -144,6 +150,7 @@ namespace Z80
         void toString(std::stringstream& ss) const;
         bool tryParse(ParsingContext* c, size_t offset);
         bool canEvaluate(const int64_t*, ISectionResolver*, std::unique_ptr<CompilerError>&) const { return true; }
+        void collectReferences(SymbolReferences&) const {}
     };
 
     struct memHL
@@ -151,6 +158,7 @@ namespace Z80
         void toString(std::stringstream& ss) const;
         bool tryParse(ParsingContext* c, size_t offset);
         bool canEvaluate(const int64_t*, ISectionResolver*, std::unique_ptr<CompilerError>&) const { return true; }
+        void collectReferences(SymbolReferences&) const {}
     };
 
     struct memIX
@@ -158,6 +166,7 @@ namespace Z80
         void toString(std::stringstream& ss) const;
         bool tryParse(ParsingContext* c, size_t offset);
         bool canEvaluate(const int64_t*, ISectionResolver*, std::unique_ptr<CompilerError>&) const { return true; }
+        void collectReferences(SymbolReferences&) const {}
     };
 
     struct memIY
@@ -165,6 +174,7 @@ namespace Z80
         void toString(std::stringstream& ss) const;
         bool tryParse(ParsingContext* c, size_t offset);
         bool canEvaluate(const int64_t*, ISectionResolver*, std::unique_ptr<CompilerError>&) const { return true; }
+        void collectReferences(SymbolReferences&) const {}
     };
 
     struct memSP
@@ -172,6 +182,7 @@ namespace Z80
         void toString(std::stringstream& ss) const;
         bool tryParse(ParsingContext* c, size_t offset);
         bool canEvaluate(const int64_t*, ISectionResolver*, std::unique_ptr<CompilerError>&) const { return true; }
+        void collectReferences(SymbolReferences&) const {}
     };
 
     class memAddr
@@ -181,6 +192,7 @@ namespace Z80
         bool tryParse(ParsingContext* c, size_t offset);
         bool canEvaluate(const int64_t* nextAddress,
             ISectionResolver* sectionResolver, std::unique_ptr<CompilerError>& resolveError) const;
+        void collectReferences(SymbolReferences& refs) const;
         int low(int64_t currentAddress, ISectionResolver* sectionResolver, int& high) const;
     private:
         Expr* mValue;
@@ -193,6 +205,7 @@ namespace Z80
         bool tryParse(ParsingContext* c, size_t offset);
         bool canEvaluate(const int64_t* nextAddress,
             ISectionResolver* sectionResolver, std::unique_ptr<CompilerError>& resolveError) const;
+        void collectReferences(SymbolReferences& refs) const;
         int value(int64_t currentAddress, ISectionResolver* sectionResolver) const;
     private:
         Expr* mValue;
@@ -205,6 +218,7 @@ namespace Z80
         bool tryParse(ParsingContext* c, size_t offset);
         bool canEvaluate(const int64_t* nextAddress,
             ISectionResolver* sectionResolver, std::unique_ptr<CompilerError>& resolveError) const;
+        void collectReferences(SymbolReferences& refs) const;
         int value(int64_t currentAddress, ISectionResolver* sectionResolver) const;
     private:
         Expr* mValue;
@@ -213,10 +227,12 @@ namespace Z80
     class relOffset
     {
     public:
+        Expr* expr() const { return mValue; }
         void toString(std::stringstream& ss) const;
         bool tryParse(ParsingContext* c, size_t offset);
         bool canEvaluate(const int64_t* nextAddress,
             ISectionResolver* sectionResolver, std::unique_ptr<CompilerError>& resolveError) const;
+        void collectReferences(SymbolReferences& refs) const;
         int value(int64_t currentAddress, ISectionResolver* sectionResolver, int64_t nextAddress) const;
     private:
         Expr* mValue;
@@ -228,6 +244,7 @@ namespace Z80
         void toString(std::stringstream& ss) const;
         bool tryParse(ParsingContext* c, size_t offset);
         bool canEvaluate(const int64_t*, ISectionResolver*, std::unique_ptr<CompilerError>&) const { return true; }
+        void collectReferences(SymbolReferences&) const {}
     };
 
     class portAddr
@@ -237,6 +254,7 @@ namespace Z80
         bool tryParse(ParsingContext* c, size_t offset);
         bool canEvaluate(const int64_t* nextAddress,
             ISectionResolver* sectionResolver, std::unique_ptr<CompilerError>& resolveError) const;
+        void collectReferences(SymbolReferences& refs) const;
         int value(int64_t currentAddress, ISectionResolver* sectionResolver) const;
     private:
         Expr* mValue;
@@ -249,6 +267,7 @@ namespace Z80
         bool tryParse(ParsingContext* c, size_t offset);
         bool canEvaluate(const int64_t* nextAddress,
             ISectionResolver* sectionResolver, std::unique_ptr<CompilerError>& resolveError) const;
+        void collectReferences(SymbolReferences& refs) const;
         int value(int64_t currentAddress, ISectionResolver* sectionResolver) const;
     private:
         Expr* mValue;
@@ -261,6 +280,7 @@ namespace Z80
         bool tryParse(ParsingContext* c, size_t offset);
         bool canEvaluate(const int64_t* nextAddress,
             ISectionResolver* sectionResolver, std::unique_ptr<CompilerError>& resolveError) const;
+        void collectReferences(SymbolReferences& refs) const;
         int value(int64_t currentAddress, ISectionResolver* sectionResolver, uint8_t baseByte) const;
     private:
         Expr* mValue;
@@ -271,6 +291,7 @@ namespace Z80
             static void toString(std::stringstream& ss) { ss << #NAME; } \
             static bool tryParse(ParsingContext* context, size_t) { return context->consumeIdentifier(#NAME); } \
             static bool canEvaluate(const int64_t*, ISectionResolver*, std::unique_ptr<CompilerError>&) { return true; } \
+            static void collectReferences(SymbolReferences&) {} \
         }
 
     struct AF_
@@ -278,6 +299,7 @@ namespace Z80
         static void toString(std::stringstream& ss);
         static bool tryParse(ParsingContext* context, size_t offset);
         static bool canEvaluate(const int64_t*, ISectionResolver*, std::unique_ptr<CompilerError>&) { return true; }
+        static void collectReferences(SymbolReferences&) {}
     };
 
     Z80_REGOP(A);
@@ -308,6 +330,7 @@ namespace Z80
             static void toString(std::stringstream& ss) { ss << #NAME; } \
             static bool tryParse(ParsingContext* context, size_t) { return context->consumeIdentifier(#NAME); } \
             static bool canEvaluate(const int64_t*, ISectionResolver*, std::unique_ptr<CompilerError>&) { return true; } \
+            static void collectReferences(SymbolReferences&) {} \
         }
 
     Z80_FLAGOP(C);
@@ -342,6 +365,11 @@ namespace Z80
 
         bool isZ80Opcode() const final override;
 
+        virtual const char* mnemonic() const = 0;
+        virtual const char* operand1() const { return nullptr; }
+        virtual const char* operand2() const { return nullptr; }
+        virtual TStates tStates() const = 0;
+
         virtual void toString(std::stringstream& ss) const = 0;
 
         DISABLE_COPY(Opcode);
@@ -377,6 +405,10 @@ namespace Z80
             mOp1.toString(ss);
         }
 
+        void collectReferences(SymbolReferences& refs) const override { mOp1.collectReferences(refs); }
+
+        const OP1& op1() const { return mOp1; }
+
         static bool tryParse(ParsingContext* context, OP1& op1)
         {
             if (!op1.tryParse(context, CHILD::operandOffset())) return false;
@@ -408,6 +440,15 @@ namespace Z80
             mOp2.toString(ss);
         }
 
+        void collectReferences(SymbolReferences& refs) const override
+        {
+            mOp1.collectReferences(refs);
+            mOp2.collectReferences(refs);
+        }
+
+        const OP1& op1() const { return mOp1; }
+        const OP2& op2() const { return mOp2; }
+
         static bool tryParse(ParsingContext* context, OP1& op1, OP2& op2)
         {
             if (!op1.tryParse(context, CHILD::operand1Offset())) return false;
@@ -430,6 +471,8 @@ namespace Z80
         { \
         public: \
             explicit OP(SourceLocation* location) : Opcode0(location) {} \
+            const char* mnemonic() const final override { return #OP; } \
+            TStates tStates() const final override { return TSTATES; } \
             bool calculateSizeInBytes(size_t& outSize, ISectionResolver* sectionResolver, \
                 std::unique_ptr<CompilerError>& resolveError) const final override; \
             bool canEmitCodeWithoutBaseAddress(ISectionResolver* sectionResolver) const final override; \
@@ -445,6 +488,9 @@ namespace Z80
         { \
         public: \
             OP##_##OP1(SourceLocation* location, OP1 op1) : Opcode1(location, op1) {} \
+            const char* mnemonic() const final override { return #OP; } \
+            const char* operand1() const final override { return #OP1; } \
+            TStates tStates() const final override { return TSTATES; } \
             bool calculateSizeInBytes(size_t& outSize, ISectionResolver* sectionResolver, \
                 std::unique_ptr<CompilerError>& resolveError) const final override; \
             bool canEmitCodeWithoutBaseAddress(ISectionResolver* sectionResolver) const final override; \
@@ -469,6 +515,10 @@ namespace Z80
         { \
         public: \
             OP##_##OP1##_##OP2(SourceLocation* location, OP1 op1, OP2 op2) : Opcode2(location, op1, op2) {} \
+            const char* mnemonic() const final override { return #OP; } \
+            const char* operand1() const final override { return #OP1; } \
+            const char* operand2() const final override { return #OP2; } \
+            TStates tStates() const final override { return TSTATES; } \
             bool calculateSizeInBytes(size_t& outSize, ISectionResolver* sectionResolver, \
                 std::unique_ptr<CompilerError>& resolveError) const final override; \
             bool canEmitCodeWithoutBaseAddress(ISectionResolver* sectionResolver) const final override; \
@@ -1,5 +1,7 @@
 #include "Label.h"
 #include "Compiler/CompilerError.h"
+#include "Compiler/Linker/CodeEmitter.h"
+#include "Compiler/Tree/SymbolReferences.h"
 
 //#define DEBUG_LABEL 1
 
@@ -109,11 +111,17 @@ bool Label::canEmitCodeWithoutBaseAddress(ISectionResolver*) const
     return true;
 }
 
-bool Label::emitCode(CodeEmitter*, int64_t&, ISectionResolver*, std::unique_ptr<CompilerError>&) const
+bool Label::emitCode(CodeEmitter* emitter, int64_t& nextAddress, ISectionResolver*, std::unique_ptr<CompilerError>&) const
 {
+    emitter->addLabelTiming(mName, nextAddress);
     return true;
 }
 
+void Label::collectReferences(SymbolReferences& refs) const
+{
+    refs.definedLabels.emplace(this);
+}
+
 bool Label::hasAddress() const
 {
     return mCurrentReadAddress->isValid();
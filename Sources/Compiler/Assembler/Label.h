@@ -14,12 +14,14 @@ public:
     Type type() const final override;
 
     const char* name() const { return mName; }
+    size_t offset() const { return mOffset; }
 
     bool calculateSizeInBytes(size_t& outSize,
         ISectionResolver* sectionResolver, std::unique_ptr<CompilerError>& resolveError) const override;
     bool canEmitCodeWithoutBaseAddress(ISectionResolver* sectionResolver) const override;
     bool emitCode(CodeEmitter* emitter, int64_t& nextAddress, ISectionResolver* sectionResolver,
         std::unique_ptr<CompilerError>& resolveError) const override;
+    void collectReferences(SymbolReferences& refs) const override;
 
     bool hasAddress() const;
     Address* address() const;
@@ -1,6 +1,7 @@
 #include "MacroEnsure.h"
 #include "Compiler/CompilerError.h"
 #include "Compiler/Tree/Expr.h"
+#include "Compiler/Tree/SymbolReferences.h"
 
 bool MacroEnsure::calculateSizeInBytes(size_t& outSize, ISectionResolver*, std::unique_ptr<CompilerError>&) const
 {
@@ -31,6 +32,11 @@ bool MacroEnsure::emitCode(CodeEmitter* emitter,
     return true;
 }
 
+void MacroEnsure::collectReferences(SymbolReferences& refs) const
+{
+    mCondition->collectReferences(refs);
+}
+
 Instruction* MacroEnsure::clone() const
 {
     return new (heap()) MacroEnsure(location(), mCondition);
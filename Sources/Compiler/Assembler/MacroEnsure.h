@@ -19,6 +19,7 @@ public:
     bool canEmitCodeWithoutBaseAddress(ISectionResolver* sectionResolver) const final override;
     bool emitCode(CodeEmitter* emitter, int64_t& nextAddress, ISectionResolver* sectionResolver,
         std::unique_ptr<CompilerError>& resolveError) const final override;
+    void collectReferences(SymbolReferences& refs) const final override;
 
     Instruction* clone() const override;
 
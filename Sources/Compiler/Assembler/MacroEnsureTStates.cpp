@@ -0,0 +1,50 @@
+#include "MacroEnsureTStates.h"
+#include "Compiler/CompilerError.h"
+#include "Compiler/Linker/CodeEmitter.h"
+#include "Compiler/Tree/Expr.h"
+#include "Compiler/Tree/SymbolReferences.h"
+
+bool MacroEnsureTStates::calculateSizeInBytes(size_t& outSize, ISectionResolver*, std::unique_ptr<CompilerError>&) const
+{
+    outSize = 0;
+    return true;
+}
+
+bool MacroEnsureTStates::canEmitCodeWithoutBaseAddress(ISectionResolver*) const
+{
+    return true;
+}
+
+bool MacroEnsureTStates::emitCode(CodeEmitter* emitter,
+    int64_t& nextAddress, ISectionResolver* sectionResolver, std::unique_ptr<CompilerError>& resolveError) const
+{
+    if (!mStart->canEvaluateValue(&nextAddress, sectionResolver, resolveError)
+            || !mEnd->canEvaluateValue(&nextAddress, sectionResolver, resolveError)
+            || !mTStates->canEvaluateValue(&nextAddress, sectionResolver, resolveError))
+        return false;
+
+    CodeEmitter::TStatesCheck check;
+    check.location = location();
+    check.startAddress = mStart->evaluateValue(&nextAddress, sectionResolver).number;
+    check.endAddress = mEnd->evaluateValue(&nextAddress, sectionResolver).number;
+    check.tStates = mTStates->evaluateValue(&nextAddress, sectionResolver).number;
+    check.exact = mExact;
+
+    if (check.tStates < 0)
+        throw CompilerError(mTStates->location(), "number of T-states cannot be negative.");
+
+    emitter->addTStatesCheck(check);
+    return true;
+}
+
+void MacroEnsureTStates::collectReferences(SymbolReferences& refs) const
+{
+    mStart->collectReferences(refs);
+    mEnd->collectReferences(refs);
+    mTStates->collectReferences(refs);
+}
+
+Instruction* MacroEnsureTStates::clone() const
+{
+    return new (heap()) MacroEnsureTStates(location(), mStart, mEnd, mTStates, mExact);
+}
@@ -0,0 +1,38 @@
+#ifndef COMPILER_ASSEMBLER_MACROENSURETSTATES_H
+#define COMPILER_ASSEMBLER_MACROENSURETSTATES_H
+
+#include "Compiler/Assembler/Instruction.h"
+
+class Expr;
+
+class MacroEnsureTStates final : public Instruction
+{
+public:
+    MacroEnsureTStates(SourceLocation* location, Expr* start, Expr* end, Expr* tStates, bool exact)
+        : Instruction(location)
+        , mStart(start)
+        , mEnd(end)
+        , mTStates(tStates)
+        , mExact(exact)
+    {
+    }
+
+    bool calculateSizeInBytes(size_t& outSize,
+        ISectionResolver* sectionResolver, std::unique_ptr<CompilerError>& resolveError) const final override;
+    bool canEmitCodeWithoutBaseAddress(ISectionResolver* sectionResolver) const final override;
+    bool emitCode(CodeEmitter* emitter, int64_t& nextAddress, ISectionResolver* sectionResolver,
+        std::unique_ptr<CompilerError>& resolveError) const final override;
+    void collectReferences(SymbolReferences& refs) const final override;
+
+    Instruction* clone() const override;
+
+private:
+    Expr* mStart;
+    Expr* mEnd;
+    Expr* mTStates;
+    bool mExact;
+
+    DISABLE_COPY(MacroEnsureTStates);
+};
+
+#endif
@@ -1,6 +1,7 @@
 #include "MacroIf.h"
 #include "Compiler/CompilerError.h"
 #include "Compiler/Tree/Expr.h"
+#include "Compiler/Tree/SymbolReferences.h"
 
 Instruction::Type MacroIf::type() const
 {
@@ -96,6 +97,33 @@ bool MacroIf::emitCode(CodeEmitter* emitter,
     return true;
 }
 
+bool MacroIf::collectBranchDisplacements(std::vector<BranchDisplacement>& displacements,
+    int64_t& nextAddress, ISectionResolver* sectionResolver, std::unique_ptr<CompilerError>& resolveError) const
+{
+    if (!mCondition->canEvaluateValue(nullptr, sectionResolver, resolveError))
+        return false;
+
+    auto result = mCondition->evaluateValue(nullptr, sectionResolver).number;
+    const std::vector<Instruction*>& instructions = (result ? mThenInstructions : mElseInstructions);
+
+    for (const auto& instruction : instructions) {
+        if (!instruction->collectBranchDisplacements(displacements, nextAddress, sectionResolver, resolveError))
+            return false;
+    }
+
+    return true;
+}
+
+void MacroIf::collectReferences(SymbolReferences& refs) const
+{
+    // Condition may depend on section placement, so both branches are considered reachable
+    mCondition->collectReferences(refs);
+    for (const auto& instruction : mThenInstructions)
+        instruction->collectReferences(refs);
+    for (const auto& instruction : mElseInstructions)
+        instruction->collectReferences(refs);
+}
+
 void MacroIf::resetCounters() const
 {
     for (const auto& instruction : mThenInstructions)
@@ -29,6 +29,9 @@ public:
     bool canEmitCodeWithoutBaseAddress(ISectionResolver* sectionResolver) const final override;
     bool emitCode(CodeEmitter* emitter, int64_t& nextAddress, ISectionResolver* sectionResolver,
         std::unique_ptr<CompilerError>& resolveError) const final override;
+    bool collectBranchDisplacements(std::vector<BranchDisplacement>& displacements, int64_t& nextAddress,
+        ISectionResolver* sectionResolver, std::unique_ptr<CompilerError>& resolveError) const final override;
+    void collectReferences(SymbolReferences& refs) const final override;
 
     void resetCounters() const final override;
     void saveReadCounter() const final override;
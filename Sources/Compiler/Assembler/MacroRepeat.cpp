@@ -1,6 +1,8 @@
 #include "MacroRepeat.h"
 #include "Compiler/CompilerError.h"
 #include "Compiler/Tree/Expr.h"
+#include "Compiler/Tree/SymbolReferences.h"
+#include "Compiler/Linker/ISectionResolver.h"
 
 Instruction::Type MacroRepeat::type() const
 {
@@ -26,6 +28,9 @@ bool MacroRepeat::resolveLabels(size_t& address,
         instruction->saveReadCounter();
 
     for (uint64_t i = 0; i < count; i++) {
+        if ((i & 0xff) == 0 && sectionResolver)
+            sectionResolver->checkCancelation();
+
         mValue = Value(int64_t(i));
         for (const auto& instruction : mInstructions) {
             if (!instruction->resolveLabel(address, sectionResolver, resolveError))
@@ -65,6 +70,9 @@ bool MacroRepeat::calculateSizeInBytes(size_t& outSize,
         instruction->saveReadCounter();
 
     for (uint64_t i = 0; i < count; i++) {
+        if ((i & 0xff) == 0 && sectionResolver)
+            sectionResolver->checkCancelation();
+
         mValue = Value(int64_t(i));
         for (const auto& instruction : mInstructions) {
             size_t size = 0;
@@ -120,6 +128,9 @@ bool MacroRepeat::emitCode(CodeEmitter* emitter, int64_t& nextAddress, ISectionR
         instruction->saveReadCounter();
 
     for (uint64_t i = 0; i < count; i++) {
+        if ((i & 0xff) == 0 && sectionResolver)
+            sectionResolver->checkCancelation();
+
         mValue = Value(int64_t(i));
         for (const auto& instruction : mInstructions) {
             if (!instruction->emitCode(emitter, nextAddress, sectionResolver, resolveError))
@@ -137,6 +148,47 @@ bool MacroRepeat::emitCode(CodeEmitter* emitter, int64_t& nextAddress, ISectionR
     return true;
 }
 
+bool MacroRepeat::collectBranchDisplacements(std::vector<BranchDisplacement>& displacements,
+    int64_t& nextAddress, ISectionResolver* sectionResolver, std::unique_ptr<CompilerError>& resolveError) const
+{
+    if (!mCount->canEvaluateValue(nullptr, sectionResolver, resolveError))
+        return false;
+
+    auto count = mCount->evaluateValue(nullptr, sectionResolver).number;
+    if (count <= 0)
+        return true;
+
+    for (const auto& instruction : mInstructions)
+        instruction->saveReadCounter();
+
+    for (int64_t i = 0; i < count; i++) {
+        if ((i & 0xff) == 0 && sectionResolver)
+            sectionResolver->checkCancelation();
+
+        mValue = Value(i);
+        for (const auto& instruction : mInstructions) {
+            if (!instruction->collectBranchDisplacements(displacements, nextAddress, sectionResolver, resolveError))
+                return false;
+        }
+
+        for (const auto& instruction : mInstructions)
+            instruction->advanceCounters();
+    }
+
+    mValue = Value(0);
+    for (const auto& instruction : mInstructions)
+        instruction->restoreReadCounter();
+
+    return true;
+}
+
+void MacroRepeat::collectReferences(SymbolReferences& refs) const
+{
+    mCount->collectReferences(refs);
+    for (const auto& instruction : mInstructions)
+        instruction->collectReferences(refs);
+}
+
 void MacroRepeat::resetCounters() const
 {
     for (const auto& instruction : mInstructions)
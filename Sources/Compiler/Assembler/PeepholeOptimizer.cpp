@@ -0,0 +1,307 @@
+#include "PeepholeOptimizer.h"
+#include "Compiler/Assembler/Instructions.Z80.h"
+#include "Compiler/Assembler/Label.h"
+#include "Compiler/CompilerError.h"
+#include "Compiler/Tree/Expr.h"
+
+namespace
+{
+    enum Flag : uint8_t
+    {
+        FlagC = 0x01,
+        FlagN = 0x02,
+        FlagPV = 0x04,
+        FlagH = 0x10,
+        FlagZ = 0x40,
+        FlagS = 0x80,
+        AllFlags = FlagS | FlagZ | FlagH | FlagPV | FlagN | FlagC,
+        AllButCarry = FlagS | FlagZ | FlagH | FlagPV | FlagN,
+    };
+
+    struct FlagEffects
+    {
+        uint8_t reads;
+        uint8_t writes;
+        bool transfersControl;
+    };
+}
+
+static bool equals(const char* a, const char* b)
+{
+    return a && b && strcmp(a, b) == 0;
+}
+
+static bool isAnyOf(const char* name, std::initializer_list<const char*> names)
+{
+    for (const char* it : names) {
+        if (equals(name, it))
+            return true;
+    }
+    return false;
+}
+
+static uint8_t conditionFlags(const char* operand)
+{
+    if (isAnyOf(operand, { "flagZ", "flagNZ" }))
+        return FlagZ;
+    if (isAnyOf(operand, { "flagC", "flagNC" }))
+        return FlagC;
+    if (isAnyOf(operand, { "flagPE", "flagPO" }))
+        return FlagPV;
+    if (isAnyOf(operand, { "flagP", "flagM" }))
+        return FlagS;
+    return 0;
+}
+
+static FlagEffects flagEffects(const Z80::Opcode* opcode)
+{
+    const char* op = opcode->mnemonic();
+    const char* op1 = opcode->operand1();
+    const char* op2 = opcode->operand2();
+
+    if (isAnyOf(op, { "JP", "JR", "CALL", "RET", "DJNZ" }))
+        return { conditionFlags(op1), 0, true };
+    if (isAnyOf(op, { "RETI", "RETN", "RST", "HALT" }))
+        return { 0, 0, true };
+
+    if (isAnyOf(op, { "AND", "OR", "XOR", "CP", "SUB", "NEG", "RLC", "RRC", "SLA", "SRA", "SRL", "SLL" }))
+        return { 0, AllFlags, false };
+    if (isAnyOf(op, { "ADC", "SBC", "RL", "RR" }))
+        return { FlagC, AllFlags, false };
+    if (equals(op, "ADD"))
+        return { 0, uint8_t(equals(op1, "A") ? AllFlags : FlagH | FlagN | FlagC), false };
+    if (isAnyOf(op, { "INC", "DEC" })) {
+        bool is8Bit = isAnyOf(op1, { "A", "B", "C", "D", "E", "H", "L",
+            "IXH", "IXL", "IYH", "IYL", "memHL", "IX_byte", "IY_byte" });
+        return { 0, uint8_t(is8Bit ? AllButCarry : 0), false };
+    }
+
+    if (isAnyOf(op, { "RLCA", "RRCA", "SCF" }))
+        return { 0, FlagH | FlagN | FlagC, false };
+    if (isAnyOf(op, { "RLA", "RRA", "CCF" }))
+        return { FlagC, FlagH | FlagN | FlagC, false };
+    if (equals(op, "CPL"))
+        return { 0, FlagH | FlagN, false };
+    if (equals(op, "DAA"))
+        return { FlagH | FlagN | FlagC, AllFlags, false };
+
+    if (isAnyOf(op, { "BIT", "RLD", "RRD", "CPI", "CPD", "CPIR", "CPDR" }))
+        return { 0, AllButCarry, false };
+    if (isAnyOf(op, { "LDI", "LDD", "LDIR", "LDDR" }))
+        return { 0, FlagH | FlagPV | FlagN, false };
+    if (isAnyOf(op, { "INI", "IND", "INIR", "INDR", "OUTI", "OUTD", "OTIR", "OTDR" }))
+        return { 0, FlagZ | FlagN, false };
+    if (equals(op, "IN"))
+        return { 0, uint8_t(equals(op2, "portC") ? AllButCarry : 0), false };
+    if (equals(op, "LD"))
+        return { 0, uint8_t(isAnyOf(op2, { "I", "R" }) ? AllButCarry : 0), false };
+
+    if (equals(op, "PUSH"))
+        return { uint8_t(equals(op1, "AF") ? AllFlags : 0), 0, false };
+    if (equals(op, "POP"))
+        return { 0, uint8_t(equals(op1, "AF") ? AllFlags : 0), false };
+    if (equals(op, "EX"))
+        return { uint8_t(equals(op1, "AF") ? AllFlags : 0), 0, false };
+
+    if (isAnyOf(op, { "SET", "RES", "NOP", "DI", "EI", "IM", "OUT", "EXX" }))
+        return { 0, 0, false };
+
+    return { AllFlags, 0, true };
+}
+
+static bool isZero(const Expr* expr)
+{
+    std::unique_ptr<CompilerError> resolveError;
+    if (!expr->canEvaluateValue(nullptr, nullptr, resolveError))
+        return false;
+    return expr->evaluateValue(nullptr, nullptr).number == 0;
+}
+
+static const Expr* jumpTarget(const Z80::Opcode* opcode)
+{
+    if (auto jp = dynamic_cast<const Z80::JP_word*>(opcode)) return jp->op1().expr();
+    if (auto jp = dynamic_cast<const Z80::JP_flagC_word*>(opcode)) return jp->op2().expr();
+    if (auto jp = dynamic_cast<const Z80::JP_flagM_word*>(opcode)) return jp->op2().expr();
+    if (auto jp = dynamic_cast<const Z80::JP_flagNC_word*>(opcode)) return jp->op2().expr();
+    if (auto jp = dynamic_cast<const Z80::JP_flagNZ_word*>(opcode)) return jp->op2().expr();
+    if (auto jp = dynamic_cast<const Z80::JP_flagP_word*>(opcode)) return jp->op2().expr();
+    if (auto jp = dynamic_cast<const Z80::JP_flagPE_word*>(opcode)) return jp->op2().expr();
+    if (auto jp = dynamic_cast<const Z80::JP_flagPO_word*>(opcode)) return jp->op2().expr();
+    if (auto jp = dynamic_cast<const Z80::JP_flagZ_word*>(opcode)) return jp->op2().expr();
+    if (auto jr = dynamic_cast<const Z80::JR_relOffset*>(opcode)) return jr->op1().expr();
+    if (auto jr = dynamic_cast<const Z80::JR_flagC_relOffset*>(opcode)) return jr->op2().expr();
+    if (auto jr = dynamic_cast<const Z80::JR_flagNC_relOffset*>(opcode)) return jr->op2().expr();
+    if (auto jr = dynamic_cast<const Z80::JR_flagNZ_relOffset*>(opcode)) return jr->op2().expr();
+    if (auto jr = dynamic_cast<const Z80::JR_flagZ_relOffset*>(opcode)) return jr->op2().expr();
+    return nullptr;
+}
+
+PeepholeOptimizer::PeepholeOptimizer(std::vector<Instruction*>& instructions)
+    : mInstructions(instructions)
+{
+}
+
+PeepholeOptimizer::~PeepholeOptimizer()
+{
+}
+
+void PeepholeOptimizer::run()
+{
+    bool changed;
+    do {
+        changed = false;
+        for (size_t i = 0; i < mInstructions.size(); i++) {
+            if (tryRewrite(i))
+                changed = true;
+        }
+    } while (changed);
+}
+
+bool PeepholeOptimizer::tryRewrite(size_t index)
+{
+    auto opcode = dynamic_cast<Z80::Opcode*>(mInstructions[index]);
+    if (!opcode)
+        return false;
+
+    // Operands of labelled instructions may be patched at runtime
+    if (index > 0 && mInstructions[index - 1]->type() == Instruction::Type::Label)
+        return false;
+
+    const char* op1 = opcode->operand1();
+    const char* op2 = opcode->operand2();
+    if (equals(opcode->mnemonic(), "LD") && equals(op1, op2)) {
+        remove(index);
+        return true;
+    }
+
+    if (auto ld = dynamic_cast<Z80::LD_A_byte*>(opcode)) {
+        if (isZero(ld->op2().expr()) && !areFlagsLive(index, AllFlags)) {
+            replace(index, new (ld->heap()) Z80::XOR_A(ld->location(), Z80::A()));
+            return true;
+        }
+        return false;
+    }
+
+    if (auto cp = dynamic_cast<Z80::CP_byte*>(opcode)) {
+        // OR A sets S, Z, H and C the same way; it differs in P/V (parity instead of overflow) and N
+        if (isZero(cp->op1().expr()) && !areFlagsLive(index, FlagPV | FlagN)) {
+            replace(index, new (cp->heap()) Z80::OR_A(cp->location(), Z80::A()));
+            return true;
+        }
+        return false;
+    }
+
+    const Expr* target = jumpTarget(opcode);
+    if (target && isNextInstructionLabel(index, target)) {
+        remove(index);
+        return true;
+    }
+
+    return false;
+}
+
+bool PeepholeOptimizer::areFlagsLive(size_t index, uint8_t flags) const
+{
+    std::vector<std::pair<size_t, uint8_t>> pending{ { index + 1, flags } };
+    std::unordered_set<size_t> visited;
+
+    while (!pending.empty()) {
+        auto [i, mask] = pending.back();
+        pending.pop_back();
+        if (!visited.emplace(i * 256 + mask).second)
+            continue;
+
+        for (; mask != 0; i++) {
+            // Execution continues past the end of section
+            if (i >= mInstructions.size())
+                return true;
+
+            if (mInstructions[i]->type() == Instruction::Type::Label)
+                continue;
+
+            auto opcode = dynamic_cast<const Z80::Opcode*>(mInstructions[i]);
+            if (!opcode)
+                return true;
+
+            FlagEffects effects = flagEffects(opcode);
+            if ((effects.reads & mask) != 0)
+                return true;
+
+            if (effects.transfersControl) {
+                const Expr* target = jumpTarget(opcode);
+                if (auto djnz = dynamic_cast<const Z80::DJNZ_relOffset*>(opcode))
+                    target = djnz->op1().expr();
+
+                std::optional<size_t> targetIndex = findLabel(target);
+                if (!targetIndex)
+                    return true;
+
+                pending.emplace_back(*targetIndex, mask);
+                if (!opcode->operand2() && !equals(opcode->mnemonic(), "DJNZ"))
+                    break;
+            }
+
+            mask &= ~effects.writes;
+        }
+    }
+
+    return false;
+}
+
+std::optional<size_t> PeepholeOptimizer::findLabel(const Expr* target) const
+{
+    auto identifier = dynamic_cast<const ExprIdentifier*>(target);
+    if (!identifier)
+        return std::nullopt;
+
+    for (size_t i = 0; i < mInstructions.size(); i++) {
+        if (mInstructions[i]->type() == Instruction::Type::Label) {
+            auto label = static_cast<const Label*>(mInstructions[i]);
+            if (label->offset() == 0 && identifier->name() == label->name())
+                return i;
+        }
+    }
+
+    return std::nullopt;
+}
+
+bool PeepholeOptimizer::isNextInstructionLabel(size_t index, const Expr* target) const
+{
+    std::optional<size_t> targetIndex = findLabel(target);
+    if (!targetIndex || *targetIndex <= index)
+        return false;
+
+    for (size_t i = index + 1; i < *targetIndex; i++) {
+        if (mInstructions[i]->type() != Instruction::Type::Label)
+            return false;
+    }
+
+    return true;
+}
+
+void PeepholeOptimizer::replace(size_t index, Z80::Opcode* replacement)
+{
+    addSavings(static_cast<const Z80::Opcode*>(mInstructions[index]), 1);
+    addSavings(replacement, -1);
+    mInstructions[index] = replacement;
+    ++mResult.rewrites;
+}
+
+void PeepholeOptimizer::remove(size_t index)
+{
+    addSavings(static_cast<const Z80::Opcode*>(mInstructions[index]), 1);
+    mInstructions.erase(mInstructions.begin() + ptrdiff_t(index));
+    ++mResult.rewrites;
+}
+
+void PeepholeOptimizer::addSavings(const Z80::Opcode* opcode, int sign)
+{
+    size_t size = 0;
+    std::unique_ptr<CompilerError> resolveError;
+    opcode->calculateSizeInBytes(size, nullptr, resolveError);
+
+    Z80::TStates tStates = opcode->tStates();
+    mResult.bytesSaved += sign * int64_t(size);
+    mResult.tStatesSaved.min += sign * std::min(tStates.t1, tStates.t2);
+    mResult.tStatesSaved.max += sign * std::max(tStates.t1, tStates.t2);
+}
@@ -0,0 +1,37 @@
+#ifndef COMPILER_ASSEMBLER_PEEPHOLEOPTIMIZER_H
+#define COMPILER_ASSEMBLER_PEEPHOLEOPTIMIZER_H
+
+#include "Compiler/Linker/DebugInformation.h"
+
+class Instruction;
+class Expr;
+
+namespace Z80 { class Opcode; }
+
+class PeepholeOptimizer
+{
+public:
+    explicit PeepholeOptimizer(std::vector<Instruction*>& instructions);
+    ~PeepholeOptimizer();
+
+    const DebugInformation::Optimization& result() const { return mResult; }
+
+    void run();
+
+private:
+    std::vector<Instruction*>& mInstructions;
+    DebugInformation::Optimization mResult;
+
+    bool tryRewrite(size_t index);
+    bool areFlagsLive(size_t index, uint8_t flags) const;
+    std::optional<size_t> findLabel(const Expr* target) const;
+    bool isNextInstructionLabel(size_t index, const Expr* target) const;
+
+    void replace(size_t index, Z80::Opcode* replacement);
+    void remove(size_t index);
+    void addSavings(const Z80::Opcode* opcode, int sign);
+
+    DISABLE_COPY(PeepholeOptimizer);
+};
+
+#endif
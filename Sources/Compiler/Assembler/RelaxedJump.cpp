@@ -0,0 +1,124 @@
+#include "RelaxedJump.h"
+#include "Compiler/CompilerError.h"
+#include "Compiler/Linker/CodeEmitter.h"
+#include "Compiler/Tree/Expr.h"
+#include "Compiler/Tree/SymbolReferences.h"
+
+namespace
+{
+    struct Encoding
+    {
+        const char* name;
+        uint8_t jrOpcode;
+        uint8_t jpOpcode;
+    };
+
+    const Encoding Encodings[] = {
+            { "nz", 0x20, 0xC2 },
+            { "z", 0x28, 0xCA },
+            { "nc", 0x30, 0xD2 },
+            { "c", 0x38, 0xDA },
+            { "po", 0, 0xE2 },
+            { "pe", 0, 0xEA },
+            { "p", 0, 0xF2 },
+            { "m", 0, 0xFA },
+            { nullptr, 0x18, 0xC3 },
+        };
+
+    const int JRTStates = 12;
+    const int JRNotTakenTStates = 7;
+    const int JPTStates = 10;
+}
+
+const char* RelaxedJump::conditionName(Condition condition)
+{
+    return Encodings[condition].name;
+}
+
+bool RelaxedJump::isZ80Opcode() const
+{
+    return true;
+}
+
+bool RelaxedJump::calculateSizeInBytes(size_t& outSize, ISectionResolver*, std::unique_ptr<CompilerError>&) const
+{
+    outSize = (mShort ? 2 : 3);
+    return true;
+}
+
+bool RelaxedJump::canEmitCodeWithoutBaseAddress(ISectionResolver* sectionResolver) const
+{
+    std::unique_ptr<CompilerError> resolveError;
+    return mTarget->canEvaluateValue(nullptr, sectionResolver, resolveError);
+}
+
+bool RelaxedJump::emitCode(CodeEmitter* emitter,
+    int64_t& nextAddress, ISectionResolver* sectionResolver, std::unique_ptr<CompilerError>& resolveError) const
+{
+    if (!mTarget->canEvaluateValue(&nextAddress, sectionResolver, resolveError))
+        return false;
+
+    const Encoding& encoding = Encodings[mCondition];
+    const bool conditional = (mCondition != Always);
+
+    DebugInformation::TStates jrTStates{ (conditional ? JRNotTakenTStates : JRTStates), JRTStates };
+    DebugInformation::TStates jpTStates{ JPTStates, JPTStates };
+
+    std::stringstream ss;
+    ss << "jmp ";
+    if (conditional)
+        ss << encoding.name << ' ';
+
+    if (mShort) {
+        uint8_t bytes[2];
+        bytes[0] = encoding.jrOpcode;
+        bytes[1] = mTarget->evaluateByteOffset(nextAddress + 2, &nextAddress, sectionResolver);
+        emitter->addTStates(nextAddress, int(jrTStates.min), int(jrTStates.max));
+        ss << "-> jr";
+        emitter->addBranchTiming(ss.str(), nextAddress, true, jrTStates, jpTStates);
+        emitter->emitBytes(location(), bytes, sizeof(bytes));
+        nextAddress += sizeof(bytes);
+    } else {
+        uint16_t target = mTarget->evaluateWord(&nextAddress, sectionResolver);
+        uint8_t bytes[3];
+        bytes[0] = encoding.jpOpcode;
+        bytes[1] = uint8_t(target & 0xff);
+        bytes[2] = uint8_t((target >> 8) & 0xff);
+        emitter->addTStates(nextAddress, int(jpTStates.min), int(jpTStates.max));
+        if (canBeShort()) {
+            ss << "-> jp";
+            emitter->addBranchTiming(ss.str(), nextAddress, false, jpTStates, jrTStates);
+        }
+        emitter->emitBytes(location(), bytes, sizeof(bytes));
+        nextAddress += sizeof(bytes);
+    }
+
+    return true;
+}
+
+bool RelaxedJump::collectBranchDisplacements(std::vector<BranchDisplacement>& displacements,
+    int64_t& nextAddress, ISectionResolver* sectionResolver, std::unique_ptr<CompilerError>& resolveError) const
+{
+    std::optional<int64_t> displacement;
+    if (mTarget->canEvaluateValue(&nextAddress, sectionResolver, resolveError)) {
+        Value value = mTarget->evaluateValue(&nextAddress, sectionResolver);
+        if (value.bits != SignificantBits::All)
+            value.truncateTo16Bit();
+        displacement = value.number - (nextAddress + 2);
+    }
+
+    displacements.emplace_back(BranchDisplacement{ this, displacement });
+
+    nextAddress += (mShort ? 2 : 3);
+    return true;
+}
+
+void RelaxedJump::collectReferences(SymbolReferences& refs) const
+{
+    mTarget->collectReferences(refs);
+}
+
+Instruction* RelaxedJump::clone() const
+{
+    return new (heap()) RelaxedJump(location(), mCondition, mTarget);
+}
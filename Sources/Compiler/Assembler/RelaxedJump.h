@@ -0,0 +1,69 @@
+#ifndef COMPILER_ASSEMBLER_RELAXEDJUMP_H
+#define COMPILER_ASSEMBLER_RELAXEDJUMP_H
+
+#include "Compiler/Assembler/Instruction.h"
+
+class Expr;
+class RelaxedJump;
+
+struct BranchDisplacement
+{
+    const RelaxedJump* jump;
+    std::optional<int64_t> displacement;
+};
+
+// "jmp" pseudo-instruction: emitted as JP until the linker proves that JR can reach the target
+class RelaxedJump final : public Instruction
+{
+public:
+    enum Condition
+    {
+        NZ,
+        Z,
+        NC,
+        C,
+        PO,
+        PE,
+        P,
+        M,
+        Always,
+    };
+
+    RelaxedJump(SourceLocation* location, Condition condition, Expr* target)
+        : Instruction(location)
+        , mTarget(target)
+        , mCondition(condition)
+        , mShort(false)
+    {
+    }
+
+    static const char* conditionName(Condition condition);
+
+    bool isZ80Opcode() const final override;
+
+    Condition condition() const { return mCondition; }
+    bool canBeShort() const { return mCondition <= C || mCondition == Always; }
+
+    bool isShort() const { return mShort; }
+    void setShort(bool flag) const { mShort = flag; }
+
+    bool calculateSizeInBytes(size_t& outSize,
+        ISectionResolver* sectionResolver, std::unique_ptr<CompilerError>& resolveError) const final override;
+    bool canEmitCodeWithoutBaseAddress(ISectionResolver* sectionResolver) const final override;
+    bool emitCode(CodeEmitter* emitter, int64_t& nextAddress, ISectionResolver* sectionResolver,
+        std::unique_ptr<CompilerError>& resolveError) const final override;
+    bool collectBranchDisplacements(std::vector<BranchDisplacement>& displacements, int64_t& nextAddress,
+        ISectionResolver* sectionResolver, std::unique_ptr<CompilerError>& resolveError) const final override;
+    void collectReferences(SymbolReferences& refs) const final override;
+
+    Instruction* clone() const override;
+
+private:
+    Expr* mTarget;
+    Condition mCondition;
+    mutable bool mShort;
+
+    DISABLE_COPY(RelaxedJump);
+};
+
+#endif
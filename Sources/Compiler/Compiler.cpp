@@ -13,6 +13,9 @@
 #include "Compiler/Linker/Program.h"
 #include "Compiler/Linker/Linker.h"
 #include "Compiler/Linker/CompiledOutput.h"
+#include "Compiler/Linker/DebugInformation.h"
+#include "Compiler/Linker/ListingWriter.h"
+#include "Compiler/Linker/SourceMap.h"
 #include "Compiler/Assembler/AssemblerParser.h"
 #include "Compiler/Output/TRDOSWriter.h"
 #include "Compiler/Output/SpectrumSnapshotWriter.h"
@@ -23,6 +26,7 @@
 #include "Compiler/CompilerError.h"
 #include "Compiler/Lexer.h"
 #include "Compiler/Project.h"
+#include "Common/BuildManifest.h"
 #include "Common/IO.h"
 #include "Common/GC.h"
 #include "Common/Strings.h"
@@ -34,6 +38,66 @@ namespace
         std::string data;
         int startLine;
     };
+
+    class LinkerProgress : public ILinkerListener
+    {
+    public:
+        static const int Scale = 1000;
+
+        LinkerProgress(ICompilerListener* listener, int current, int total)
+            : mListener(listener)
+            , mCurrent(current)
+            , mTotal(total)
+        {
+        }
+
+        void checkCancelation() const override
+        {
+            if (mListener)
+                mListener->checkCancelation();
+        }
+
+        void linkerProgress(int64_t current, int64_t total, const std::string& message) override
+        {
+            if (!mListener)
+                return;
+
+            int64_t fraction = 0;
+            if (total > 0 && current > 0)
+                fraction = std::min<int64_t>(current * Scale / total, Scale - 1);
+
+            mListener->compilerProgress(int(mCurrent * Scale + fraction), mTotal * Scale, message);
+        }
+
+    private:
+        ICompilerListener* mListener;
+        int mCurrent;
+        int mTotal;
+    };
+}
+
+static uint64_t outputFingerprint(std::stringstream& ss, const Project::Output* output,
+    CompiledOutput* linkerOutput, const std::unordered_map<std::string, BasicFile>& basicFiles)
+{
+    for (const auto& file : output->files) {
+        if (file.ref) {
+            ss << " file " << *file.ref;
+            if (auto data = linkerOutput->getFile(*file.ref))
+                ss << ' ' << data->fingerprint();
+            if (auto group = linkerOutput->getFileGroup(*file.ref)) {
+                for (auto bankFile : *group)
+                    ss << ' ' << bankFile->fingerprint();
+            }
+        } else if (file.refBasic) {
+            ss << " basic " << *file.refBasic;
+            auto it = basicFiles.find(*file.refBasic);
+            if (it != basicFiles.end())
+                ss << ' ' << BuildManifest::hash(it->second.data.data(), it->second.data.size()) << ' ' << it->second.startLine;
+        }
+    }
+
+    std::string str = ss.str();
+    return BuildManifest::hash(str.data(), str.size());
 }
 
 ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -93,6 +157,9 @@ void Compiler::buildProject(const std::filesystem::path& projectFile, const std:
         mOutputPath = mProjectPath / Project::DefaultOutputDirectory;
     mOutputPath = mOutputPath.lexically_normal();
 
+    BuildManifest manifest(mOutputPath);
+    manifest.load();
+
     // Collect list of source files
 
     if (mListener)
@@ -217,13 +284,13 @@ void Compiler::buildProject(const std::filesystem::path& projectFile, const std:
         std::string buildSettingsJava = ss.str();
 
         auto path = mOutputPath / "java_generated" / "build" / "BuildSettings.java";
-        writeFile(path, "package build;\n" + buildSettingsJava, SkipIfSameContent);
+        manifest.writeFile(path, "package build;\n" + buildSettingsJava);
         sourceFile.fileID = new (mHeap) FileID("build/BuildSettings.java", path);
         sourceFile.fileType = FileType::Java;
         buildJavaFiles.emplace_back(sourceFile);
 
         path = mOutputPath / "java_generated" / "game" / "BuildSettings.java";
-        writeFile(path, "package game;\n" + buildSettingsJava, SkipIfSameContent);
+        manifest.writeFile(path, "package game;\n" + buildSettingsJava);
         sourceFile.fileID = new (mHeap) FileID("game/BuildSettings.java", path);
         sourceFile.fileType = FileType::Java;
         gameJavaFiles.emplace_back(sourceFile);
@@ -345,8 +412,9 @@ void Compiler::buildProject(const std::filesystem::path& projectFile, const std:
 
         switch (file.fileType) {
             case FileType::Asm: {
+                MappedFile source(file.fileID->path());
                 Lexer lexer(mHeap, Lexer::Mode::Assembler);
-                lexer.scan(file.fileID, loadFile(file.fileID->path()).c_str());
+                lexer.scan(file.fileID, source.data());
                 AssemblerParser parser(mHeap, program);
                 parser.parse(lexer.firstToken());
                 break;
@@ -361,31 +429,74 @@ void Compiler::buildProject(const std::filesystem::path& projectFile, const std:
     // Link program
 
     if (mListener)
-        mListener->compilerProgress(count++, total, "Linking...");
+        mListener->compilerProgress(count, total, "Linking...");
+
+    LinkerProgress linkerProgress(mListener, count++, total);
+    Linker linker(mHeap, &project, &linkerProgress);
+
+    std::unordered_set<std::string> filesUsedByBasic;
+    for (const auto& it : basicFiles) {
+        for (const auto& file : it.second) {
+            MappedFile source(file.fileID->path());
+            SpectrumBasicCompiler::collectFileReferences(source.data(), filesUsedByBasic);
+        }
+    }
+    for (const auto& name : filesUsedByBasic)
+        linker.addFileUsedByBasic(name);
 
-    Linker linker(mHeap, &project);
     mLinkerOutput = linker.link(program);
 
+    if (mListener) {
+        for (const auto& file : mLinkerOutput->files()) {
+            for (const auto& warning : file->warnings())
+                mListener->printMessage(CompilerError::makeFullMessage(warning.location, "warning: " + warning.message));
+
+            const auto& removedSections = file->debugInfo()->removedSections();
+            if (!removedSections.empty()) {
+                int64_t removedBytes = 0;
+                for (const auto& section : removedSections)
+                    removedBytes += section.size.value_or(0);
+
+                std::stringstream ss;
+                ss << "removed " << removedSections.size() << " unused section(s) from file \""
+                   << file->name() << "\" (" << removedBytes << " bytes).";
+                mListener->printMessage(ss.str());
+            }
+        }
+    }
+
     // Compile basic files
 
     std::unordered_map<std::string, BasicFile> compiledBasicFiles;
 
+    std::vector<std::future<BasicFile>> basicJobs;
+    basicJobs.reserve(basicFiles.size());
     for (const auto& it : basicFiles) {
-        SpectrumBasicCompiler compiler(mHeap, mLinkerOutput);
+        const std::vector<SourceFile>* files = &it.second;
+        basicJobs.emplace_back(std::async(std::launch::async, [this, files]() -> BasicFile {
+                SpectrumBasicCompiler compiler(mHeap, mLinkerOutput);
 
-        for (const auto& file : it.second) {
-            if (mListener)
-                mListener->compilerProgress(count++, total, file.fileID->name().string());
-            compiler.addFile(&file);
-        }
+                for (const auto& file : *files)
+                    compiler.addFile(&file);
 
-        compiler.compile();
+                compiler.compile();
 
-        int startLine = -1;
-        if (compiler.hasStartLine())
-            startLine = compiler.startLine();
+                int startLine = -1;
+                if (compiler.hasStartLine())
+                    startLine = compiler.startLine();
 
-        compiledBasicFiles[it.first] = BasicFile{ compiler.compiledData(), startLine };
+                return BasicFile{ compiler.compiledData(), startLine };
+            }));
+    }
+
+    auto basicJob = basicJobs.begin();
+    for (const auto& it : basicFiles) {
+        if (mListener) {
+            for (const auto& file : it.second)
+                mListener->compilerProgress(count++, total, file.fileID->name().string());
+        }
+
+        compiledBasicFiles[it.first] = (basicJob++)->get();
     }
 
     // Generate separate files
@@ -393,6 +504,8 @@ void Compiler::buildProject(const std::filesystem::path& projectFile, const std:
     std::filesystem::path individualFilesPath = mOutputPath / "files";
 
     for (const auto& file : mLinkerOutput->files()) {
+        auto path = individualFilesPath / file->name();
+
         size_t n = file->size();
         const auto* p = file->data();
 
@@ -400,27 +513,81 @@ void Compiler::buildProject(const std::filesystem::path& projectFile, const std:
         for (size_t i = 0; i < n; i++)
             bytes[i] = p[i].value;
 
-        writeFile(individualFilesPath / file->name(), bytes.get(), n);
+        manifest.writeFile(path, bytes.get(), n);
     }
 
     for (const auto& it : compiledBasicFiles)
-        writeFile(individualFilesPath / (it.first + ".B"), it.second.data);
+        manifest.writeFile(individualFilesPath / (it.first + ".B"), it.second.data);
+
+    // Generate source maps
+
+    for (const auto& file : mLinkerOutput->files())
+        SourceMap::update(manifest, individualFilesPath / (file->name() + ".srcmap"), file);
+
+    // Generate listings
+
+    for (const auto& file : mLinkerOutput->files()) {
+        if (!file->isListingEnabled())
+            continue;
+
+        FileWriter writer(individualFilesPath / (file->name() + ".lst"));
+        ListingWriter listing(file);
+        std::string line;
+        while (listing.nextLine(line)) {
+            line += '\n';
+            writer.write(line.data(), line.size());
+        }
+        writer.commit();
+    }
+
+    // Generate timing report
+
+    {
+        std::stringstream ss;
+        for (const auto& file : mLinkerOutput->files()) {
+            ss << "; " << file->name() << "\n\n";
+            file->debugInfo()->writeTimingReport(ss);
+            ss << "\n";
+        }
+        manifest.writeFile(mOutputPath / (projectName + ".timing"), ss.str());
+    }
+
+    // Generate memory map
+
+    {
+        std::stringstream ss;
+        for (const auto& file : mLinkerOutput->files()) {
+            ss << "; " << file->name() << "\n\n";
+            file->debugInfo()->writeMemoryMap(ss);
+            ss << "\n";
+        }
+        manifest.writeFile(mOutputPath / (projectName + ".map"), ss.str());
+    }
+
+    manifest.save();
 
     // Generate outputs configured in the project
 
     std::unordered_set<std::string> outputs;
-    auto makePath = [this, &outputs](std::string name) -> std::filesystem::path {
+    std::vector<std::filesystem::path> outputPaths;
+    auto makePath = [this, &outputs, &outputPaths](std::string name) -> std::filesystem::path {
             std::filesystem::path path = mOutputPath / name;
             if (!outputs.emplace(std::move(name)).second) {
                 std::stringstream ss;
                 ss << "Duplicate output file \"" << path << "\".";
                 throw CompilerError(nullptr, ss.str());
             }
+            outputPaths.emplace_back(path);
             return path;
         };
 
+    // Settings of outputs come from the project file; data comes from fingerprints of compiled files
+    std::string projectFileData = loadFile(projectFile);
+    uint64_t projectFingerprint = BuildManifest::hash(projectFileData.data(), projectFileData.size());
+
     for (const auto& output : project.outputs) {
         std::unique_ptr<IOutputWriter> outputWriter;
+        outputPaths.clear();
 
         if (!output->isEnabled(program->projectVariables()))
             continue;
@@ -434,7 +601,35 @@ void Compiler::buildProject(const std::filesystem::path& projectFile, const std:
                 tapeWriter->setWriteTapFile(makePath(projectName + ".tap"));
                 if (mEnableWav) {
                     mGeneratedWavFile = makePath(projectName + ".wav");
-                    tapeWriter->setWriteWavFile(*mGeneratedWavFile);
+                    tapeWriter->setWriteWavFile(*mGeneratedWavFile, output->wav);
+                }
+
+                outputWriter = std::move(tapeWriter);
+                break;
+            }
+
+            case Project::Output::ZXSpectrumTZX: {
+                if (mListener)
+                    mListener->compilerProgress(count++, total, "Generating TZX...");
+
+                auto tapeWriter = std::make_unique<SpectrumTapeWriter>();
+                tapeWriter->setTurboTiming(*output->turbo);
+                for (const auto& file : output->files) {
+                    if (!file.turbo)
+                        continue;
+                    if (!file.ref)
+                        throw CompilerError(file.location, "only code files can be written as turbo blocks.");
+                    if (auto group = mLinkerOutput->getFileGroup(*file.ref)) {
+                        for (auto bankFile : *group)
+                            tapeWriter->addTurboFile(bankFile->name());
+                    }
+                    tapeWriter->addTurboFile(*file.ref);
+                }
+
+                tapeWriter->setWriteTzxFile(makePath(projectName + ".tzx"));
+                if (mEnableWav) {
+                    mGeneratedWavFile = makePath(projectName + ".wav");
+                    tapeWriter->setWriteWavFile(*mGeneratedWavFile, output->wav);
                 }
 
                 outputWriter = std::move(tapeWriter);
@@ -465,6 +660,18 @@ void Compiler::buildProject(const std::filesystem::path& projectFile, const std:
                 break;
             }
 
+            case Project::Output::ZXSpectrumSZX: {
+                if (mListener)
+                    mListener->compilerProgress(count++, total, "Generating SZX...");
+
+                auto szxWriter = std::make_unique<SpectrumSnapshotWriter>();
+                output->z80->initWriter(program, &linker, szxWriter.get());
+                szxWriter->setWriteSzxFile(output->location, makePath(projectName + ".szx"));
+
+                outputWriter = std::move(szxWriter);
+                break;
+            }
+
             case Project::Output::PC: {
                 if (mListener)
                     mListener->compilerProgress(count++, total, "Generating executables...");
@@ -484,6 +691,23 @@ void Compiler::buildProject(const std::filesystem::path& projectFile, const std:
                 continue;
         }
 
+        // Snapshots and executables also depend on program symbols, so they are always regenerated
+        std::optional<uint64_t> fingerprint;
+        if (!mOutputWriterProxy && (output->type == Project::Output::ZXSpectrumTAP
+                || output->type == Project::Output::ZXSpectrumTZX || output->type == Project::Output::ZXSpectrumTRD)) {
+            std::stringstream ss;
+            ss << projectFingerprint << ' ' << projectConfiguration << ' ' << int(output->type) << ' ' << mEnableWav;
+            fingerprint = outputFingerprint(ss, output.get(), mLinkerOutput, compiledBasicFiles);
+
+            bool upToDate = true;
+            for (const auto& path : outputPaths) {
+                if (!manifest.isUpToDate(path, *fingerprint))
+                    upToDate = false;
+            }
+            if (upToDate)
+                continue;
+        }
+
         IOutputWriter* writer = outputWriter.get();
         if (mOutputWriterProxy) {
             mOutputWriterProxy->setOutput(output->type, outputWriter.get());
@@ -493,6 +717,14 @@ void Compiler::buildProject(const std::filesystem::path& projectFile, const std:
         for (const auto& file : output->files) {
             if (file.ref) {
                 auto data = mLinkerOutput->getFile(*file.ref);
+                auto group = mLinkerOutput->getFileGroup(*file.ref);
+                if (!data && group) {
+                    for (auto bankFile : *group) {
+                        writer->addCodeFile(file.location, bankFile->name(), bankFile->name(),
+                            bankFile->data(), bankFile->size(), bankFile->loadAddress());
+                    }
+                    continue;
+                }
                 if (!data) {
                     std::stringstream ss;
                     ss << "File \"" << *file.ref << "\" was not generated by the compiler.";
@@ -515,8 +747,15 @@ void Compiler::buildProject(const std::filesystem::path& projectFile, const std:
         }
 
         writer->writeOutput();
+
+        if (fingerprint) {
+            for (const auto& path : outputPaths)
+                manifest.addGeneratedFile(path, *fingerprint);
+        }
     }
 
+    manifest.save();
+
     if (mListener)
         mListener->compilerProgress(count, total, "Done");
 }
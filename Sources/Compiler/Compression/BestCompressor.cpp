@@ -0,0 +1,113 @@
+#include "BestCompressor.h"
+#include "Compiler/CompilerError.h"
+
+namespace
+{
+    struct Aborted {};
+}
+
+class BestCompressor::Candidate : public ICompressorListener
+{
+public:
+    BestCompressor* owner;
+    std::unique_ptr<Compressor> compressor;
+    int64_t current;
+    int64_t total;
+
+    Candidate(BestCompressor* owner, std::unique_ptr<Compressor> compressor)
+        : owner(owner)
+        , compressor(std::move(compressor))
+        , current(0)
+        , total(0)
+    {
+        this->compressor->setListener(this);
+    }
+
+    void compressorProgress(int64_t current, int64_t total) override
+    {
+        std::lock_guard<std::mutex> lock(owner->mProgressMutex);
+        this->current = current;
+        this->total = total;
+        owner->candidateProgress();
+    }
+};
+
+BestCompressor::BestCompressor(bool fastOnly)
+    : mSelected(fastOnly ? Compression::BestFast : Compression::Best)
+{
+    // In order of preference when sizes are equal: faster decompressors first
+    mCandidates.emplace_back(std::make_unique<Candidate>(this, Compressor::create(nullptr, Compression::Lzsa2)));
+    mCandidates.emplace_back(std::make_unique<Candidate>(this, Compressor::create(nullptr, Compression::Zx7)));
+    if (!fastOnly)
+        mCandidates.emplace_back(std::make_unique<Candidate>(this, Compressor::create(nullptr, Compression::Zx0)));
+}
+
+BestCompressor::~BestCompressor()
+{
+}
+
+Compression BestCompressor::compression() const
+{
+    return mSelected;
+}
+
+void BestCompressor::candidateProgress()
+{
+    int64_t current = 0, total = 0;
+    for (const auto& candidate : mCandidates) {
+        current += candidate->current;
+        total += candidate->total;
+    }
+
+    if (reportProgress(current, total))
+        throw Aborted();
+}
+
+void BestCompressor::compress(SourceLocation* location, std::vector<uint8_t> src, std::vector<uint8_t>& dst)
+{
+    if (src.empty()) {
+        mSelected = mCandidates.front()->compressor->compression();
+        return;
+    }
+
+    std::vector<std::future<std::vector<uint8_t>>> results;
+    results.reserve(mCandidates.size());
+    for (const auto& candidate : mCandidates) {
+        Compressor* compressor = candidate->compressor.get();
+        results.emplace_back(std::async(std::launch::async, [compressor, location, &src]() {
+                std::vector<uint8_t> result;
+                compressor->compress(location, src, result);
+                return result;
+            }));
+    }
+
+    std::vector<uint8_t> best;
+    Candidate* bestCandidate = nullptr;
+    std::exception_ptr error;
+
+    for (size_t i = 0; i < results.size(); i++) {
+        try {
+            auto result = results[i].get();
+            if (!bestCandidate || result.size() < best.size()) {
+                bestCandidate = mCandidates[i].get();
+                best = std::move(result);
+            }
+        } catch (const Aborted&) {
+        } catch (...) {
+            if (!error)
+                error = std::current_exception();
+        }
+    }
+
+    rethrowIfAborted();
+
+    if (!bestCandidate) {
+        if (error)
+            std::rethrow_exception(error);
+        throw CompilerError(location, "internal compiler error: no compressor produced output.");
+    }
+
+    mSelected = bestCandidate->compressor->compression();
+    setSafeDistance(bestCandidate->compressor->safeDistance());
+    dst.insert(dst.end(), best.begin(), best.end());
+}
@@ -0,0 +1,27 @@
+#ifndef COMPILER_COMPRESSION_BESTCOMPRESSOR_H
+#define COMPILER_COMPRESSION_BESTCOMPRESSOR_H
+
+#include "Compiler/Compression/Compressor.h"
+
+class BestCompressor final : public Compressor
+{
+public:
+    explicit BestCompressor(bool fastOnly);
+    ~BestCompressor() override;
+
+    Compression compression() const override;
+    void compress(SourceLocation* location, std::vector<uint8_t> src, std::vector<uint8_t>& dst) override;
+
+private:
+    class Candidate;
+
+    std::vector<std::unique_ptr<Candidate>> mCandidates;
+    std::mutex mProgressMutex;
+    Compression mSelected;
+
+    void candidateProgress();
+
+    DISABLE_COPY(BestCompressor);
+};
+
+#endif
@@ -10,6 +10,15 @@ enum class Compression
     Zx0,
     Zx0Quick,
     Lzsa2,
+    Best,
+    BestFast,
+};
+
+enum class DecompressorVariant
+{
+    None,
+    Small,
+    Fast,
 };
 
 #endif
@@ -3,6 +3,40 @@
 #include "Compiler/Compression/Lzsa2Compressor.h"
 #include "Compiler/Compression/Zx0Compressor.h"
 #include "Compiler/Compression/Zx7Compressor.h"
+#include "Compiler/Compression/BestCompressor.h"
+
+Compressor::Compressor()
+    : mListener(nullptr)
+    , mSafeDistance(0)
+{
+}
+
+Compressor::~Compressor()
+{
+}
+
+bool Compressor::reportProgress(int64_t current, int64_t total) noexcept
+{
+    if (!mListener || mAbortReason)
+        return mAbortReason != nullptr;
+
+    try {
+        mListener->compressorProgress(current, total);
+        return false;
+    } catch (...) {
+        mAbortReason = std::current_exception();
+        return true;
+    }
+}
+
+void Compressor::rethrowIfAborted()
+{
+    if (mAbortReason) {
+        auto reason = mAbortReason;
+        mAbortReason = nullptr;
+        std::rethrow_exception(reason);
+    }
+}
 
 std::unique_ptr<Compressor> Compressor::create(SourceLocation* location, Compression compression)
 {
@@ -17,6 +51,10 @@ std::unique_ptr<Compressor> Compressor::create(SourceLocation* location, Compres
             return std::unique_ptr<Compressor>(new Zx0Compressor(false));
         case Compression::Zx0Quick:
             return std::unique_ptr<Compressor>(new Zx0Compressor(true));
+        case Compression::Best:
+            return std::unique_ptr<Compressor>(new BestCompressor(false));
+        case Compression::BestFast:
+            return std::unique_ptr<Compressor>(new BestCompressor(true));
     }
 
     throw CompilerError(location, "internal compiler error: invalid compression mode.");
@@ -5,14 +5,43 @@
 
 class SourceLocation;
 
+class ICompressorListener
+{
+public:
+    virtual ~ICompressorListener() = default;
+    virtual void compressorProgress(int64_t current, int64_t total) = 0;
+};
+
 class Compressor
 {
 public:
-    virtual ~Compressor() = default;
+    Compressor();
+    virtual ~Compressor();
+
+    void setListener(ICompressorListener* listener) { mListener = listener; }
+
+    // Minimum distance between the end of decompressed data and the end of compressed data that allows
+    // decompressing in-place (valid after compress()).
+    int64_t safeDistance() const { return mSafeDistance; }
+
     virtual Compression compression() const = 0;
     virtual void compress(SourceLocation* location, std::vector<uint8_t> src, std::vector<uint8_t>& dst) = 0;
 
     static std::unique_ptr<Compressor> create(SourceLocation* location, Compression compression);
+
+protected:
+    // Called from inside compression loops. Returns true if listener threw and compression should stop.
+    bool reportProgress(int64_t current, int64_t total) noexcept;
+    void rethrowIfAborted();
+
+    void setSafeDistance(int64_t distance) { mSafeDistance = distance; }
+
+private:
+    ICompressorListener* mListener;
+    int64_t mSafeDistance;
+    std::exception_ptr mAbortReason;
+
+    DISABLE_COPY(Compressor);
 };
 
 #endif
@@ -0,0 +1,289 @@
+#include "Decompressor.h"
+#include "Compiler/Compression/dzx0_standard.h"
+#include "Compiler/Compression/dzx0_turbo.h"
+#include "Compiler/Compression/dzx7_standard.h"
+#include "Compiler/Compression/dzx7_turbo.h"
+#include "Compiler/Compression/unlzsa2_small.h"
+#include "Compiler/Compression/unlzsa2_fast.h"
+#include "Compiler/LexerUtils.h"
+#include "Common/Strings.h"
+
+/*
+ * ZX0 decoders by Einar Saukas & introspec, copyright (c) 2021, Einar Saukas (see Libs/ZX0/LICENSE).
+ * ZX7 decoders by Einar Saukas, Antonio Villena, Metalbrain & Urusergi (see Libs/ZX7/zx7.txt).
+ * LZSA2 decompressors by spke & uniabis (see Libs/LZSA/asm/z80 for the license).
+ *
+ * Sources are embedded from Libs at build time and converted from the syntax of sjasmplus when first used:
+ * conditionals are evaluated with nothing defined, macros are expanded, statements separated with ':' are
+ * split, numbers and some shorthand instructions are rewritten, local labels are qualified with the preceding
+ * global label and all labels get the given prefix.
+ */
+
+namespace
+{
+    struct Statement
+    {
+        std::string scope;
+        std::string label;
+        std::string text;
+    };
+}
+
+static std::string trimmed(const std::string& str)
+{
+    size_t start = str.find_first_not_of(" \t\r");
+    if (start == std::string::npos)
+        return std::string();
+
+    size_t end = str.find_last_not_of(" \t\r");
+    return str.substr(start, end - start + 1);
+}
+
+static std::string firstWord(const std::string& str, std::string* rest = nullptr)
+{
+    size_t end = str.find_first_of(" \t");
+    if (rest)
+        *rest = (end != std::string::npos ? trimmed(str.substr(end)) : std::string());
+    return str.substr(0, end);
+}
+
+static void splitStatements(const std::string& scope, const std::string& text, std::vector<Statement>& statements)
+{
+    std::stringstream ss(text);
+    std::string statement;
+    while (std::getline(ss, statement, ':')) {
+        statement = trimmed(statement);
+        if (!statement.empty())
+            statements.emplace_back(Statement{ scope, std::string(), std::move(statement) });
+    }
+}
+
+static std::string convertOperands(const std::string& operands, const std::string& scope,
+    const std::unordered_set<std::string>& labels, const char* prefix)
+{
+    std::stringstream ss;
+
+    const char* p = operands.c_str();
+    while (*p) {
+        if ((*p == '$' || *p == '#') && isHexDigit(p[1])) {
+            ss << "0x";
+            while (isHexDigit(*++p))
+                ss << char(tolower(*p));
+        } else if (*p == '%' && (p[1] == '0' || p[1] == '1')) {
+            ss << "0b";
+            while (*++p == '0' || *p == '1')
+                ss << *p;
+        } else if (isDigit(*p)) {
+            while (isIdentifier(*p))
+                ss << *p++;
+        } else if (isIdentifier(*p) || *p == '.') {
+            const char* start = p;
+            while (isIdentifier(*p) || *p == '.')
+                ++p;
+            if (*p == '\'')
+                ++p;
+
+            std::string name(start, p);
+            std::string qualified = (name[0] == '.' ? scope + name : name);
+            if (labels.find(qualified) == labels.end())
+                ss << toLower(name);
+            else {
+                std::replace(qualified.begin(), qualified.end(), '.', '_');
+                ss << prefix << toLower(qualified);
+            }
+        } else
+            ss << *p++;
+    }
+
+    return ss.str();
+}
+
+static std::string convertDecompressor(const char* symbol, const unsigned char* source, const char* prefix)
+{
+    std::unordered_set<std::string> defines;
+    std::unordered_map<std::string, std::vector<std::string>> macros;
+    std::vector<std::string>* macro = nullptr;
+    std::vector<bool> conditions;
+
+    std::unordered_set<std::string> labels;
+    std::vector<Statement> statements;
+    std::string scope;
+
+    std::stringstream input(reinterpret_cast<const char*>(source));
+    std::string line;
+    while (std::getline(input, line)) {
+        line = line.substr(0, line.find(';'));
+
+        // Labels start in the first column, everything else is indented
+        bool hasLabel = (!line.empty() && line[0] != ' ' && line[0] != '\t' && line[0] != '\r');
+        std::string text = trimmed(line);
+        if (text.empty())
+            continue;
+
+        if (!hasLabel) {
+            std::string operand;
+            std::string directive = toUpper(firstWord(text, &operand));
+            if (directive == "IFDEF" || directive == "IFNDEF") {
+                bool defined = (defines.find(operand) != defines.end());
+                conditions.emplace_back(defined == (directive == "IFDEF"));
+                continue;
+            } else if (directive == "ELSE") {
+                assert(!conditions.empty());
+                conditions.back() = !conditions.back();
+                continue;
+            } else if (directive == "ENDIF") {
+                assert(!conditions.empty());
+                conditions.pop_back();
+                continue;
+            }
+
+            if (std::find(conditions.begin(), conditions.end(), false) != conditions.end())
+                continue;
+
+            if (directive == "DEFINE") {
+                defines.emplace(operand);
+                continue;
+            } else if (directive == "MACRO") {
+                macro = &macros[operand];
+                continue;
+            } else if (directive == "ENDM") {
+                macro = nullptr;
+                continue;
+            }
+        } else if (std::find(conditions.begin(), conditions.end(), false) != conditions.end())
+            continue;
+
+        if (macro) {
+            macro->emplace_back(std::move(text));
+            continue;
+        }
+
+        if (hasLabel) {
+            size_t end = text.find_first_of(" \t:");
+            std::string label = text.substr(0, end);
+            text = (end != std::string::npos ? text.substr(end + (text[end] == ':' ? 1 : 0)) : std::string());
+
+            if (label[0] == '@')
+                label = label.substr(1);
+            if (label[0] == '.')
+                label = scope + label;
+            else
+                scope = label;
+
+            labels.emplace(label);
+            statements.emplace_back(Statement{ scope, std::move(label), std::string() });
+        }
+
+        std::vector<Statement> lineStatements;
+        splitStatements(scope, text, lineStatements);
+        for (auto& statement : lineStatements) {
+            auto it = macros.find(firstWord(statement.text));
+            if (it == macros.end()) {
+                statements.emplace_back(std::move(statement));
+                continue;
+            }
+            for (const auto& macroLine : it->second)
+                splitStatements(scope, macroLine, statements);
+        }
+    }
+
+    assert(conditions.empty());
+    assert(!macro);
+
+    std::stringstream ss;
+    ss << symbol << ":\n";
+    for (const auto& statement : statements) {
+        if (!statement.label.empty()) {
+            std::string label = statement.label;
+            std::replace(label.begin(), label.end(), '.', '_');
+            ss << prefix << toLower(label) << ":\n";
+            continue;
+        }
+
+        std::string operands;
+        std::string mnemonic = toLower(firstWord(statement.text, &operands));
+        if (mnemonic == "exa") {
+            mnemonic = "ex";
+            operands = "af, af'";
+        } else if ((mnemonic == "add" || mnemonic == "adc" || mnemonic == "sbc") && operands.find(',') == std::string::npos)
+            operands = "a, " + operands;
+
+        ss << "        " << mnemonic;
+        if (!operands.empty())
+            ss << ' ' << convertOperands(operands, statement.scope, labels, prefix);
+        ss << '\n';
+    }
+
+    return ss.str();
+}
+
+void decompressorCodecs(Compression compression, std::vector<Compression>& codecs)
+{
+    switch (compression) {
+        case Compression::None:
+            return;
+        case Compression::Zx7:
+            codecs.emplace_back(Compression::Zx7);
+            return;
+        case Compression::Zx0:
+        case Compression::Zx0Quick:
+            codecs.emplace_back(Compression::Zx0);
+            return;
+        case Compression::Lzsa2:
+            codecs.emplace_back(Compression::Lzsa2);
+            return;
+        case Compression::Best:
+            codecs.emplace_back(Compression::Zx0);
+            /* falls through */
+        case Compression::BestFast:
+            codecs.emplace_back(Compression::Zx7);
+            codecs.emplace_back(Compression::Lzsa2);
+            return;
+    }
+
+    assert(false);
+}
+
+Compression decompressorCodec(Compression compression)
+{
+    return (compression == Compression::Zx0Quick ? Compression::Zx0 : compression);
+}
+
+const char* decompressorSymbol(Compression codec)
+{
+    switch (codec) {
+        case Compression::Zx7: return "decompress_zx7";
+        case Compression::Zx0: return "decompress_zx0";
+        case Compression::Lzsa2: return "decompress_lzsa2";
+        default: break;
+    }
+
+    assert(false);
+    return nullptr;
+}
+
+const char* decompressorSource(Compression codec, DecompressorVariant variant)
+{
+    bool fast = (variant == DecompressorVariant::Fast);
+    switch (codec) {
+        case Compression::Zx7: {
+            static const std::string standard = convertDecompressor("decompress_zx7", dzx7_standard_bytes, "");
+            static const std::string turbo = convertDecompressor("decompress_zx7", dzx7_turbo_bytes, "");
+            return (fast ? turbo : standard).c_str();
+        }
+        case Compression::Zx0: {
+            static const std::string standard = convertDecompressor("decompress_zx0", dzx0_standard_bytes, "");
+            static const std::string turbo = convertDecompressor("decompress_zx0", dzx0_turbo_bytes, "");
+            return (fast ? turbo : standard).c_str();
+        }
+        case Compression::Lzsa2: {
+            static const std::string small = convertDecompressor("decompress_lzsa2", unlzsa2_small_bytes, "unlzsa2s_");
+            static const std::string quick = convertDecompressor("decompress_lzsa2", unlzsa2_fast_bytes, "unlzsa2f_");
+            return (fast ? quick : small).c_str();
+        }
+        default: break;
+    }
+
+    assert(false);
+    return nullptr;
+}
@@ -0,0 +1,15 @@
+#ifndef COMPILER_COMPRESSION_DECOMPRESSOR_H
+#define COMPILER_COMPRESSION_DECOMPRESSOR_H
+
+#include "Compiler/Compression/Compression.h"
+
+// Collects codecs that may be produced by the given compression mode ("best" modes select one at link time)
+void decompressorCodecs(Compression compression, std::vector<Compression>& codecs);
+
+// Codec of the decompressor for data produced by the given (non-"best") compression mode
+Compression decompressorCodec(Compression compression);
+
+const char* decompressorSymbol(Compression codec);
+const char* decompressorSource(Compression codec, DecompressorVariant variant);
+
+#endif
@@ -0,0 +1,174 @@
+#include "Deflate.h"
+
+namespace
+{
+    const size_t WindowSize = 32768;
+    const size_t MinMatch = 3;
+    const size_t MaxMatch = 258;
+    const size_t MaxChainLength = 128;
+    const size_t HashBits = 15;
+    const size_t NoPosition = size_t(-1);
+
+    const uint16_t LengthBase[] = {
+        3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31,
+        35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258,
+    };
+    const uint8_t LengthExtraBits[] = {
+        0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2,
+        3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0,
+    };
+    const uint16_t DistanceBase[] = {
+        1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193,
+        257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577,
+    };
+    const uint8_t DistanceExtraBits[] = {
+        0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6,
+        7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13,
+    };
+
+    class BitWriter
+    {
+    public:
+        explicit BitWriter(std::vector<uint8_t>& dst) : mDst(dst), mBits(0), mCount(0) {}
+
+        void write(uint32_t value, int count)
+        {
+            mBits |= value << mCount;
+            mCount += count;
+            while (mCount >= 8) {
+                mDst.emplace_back(uint8_t(mBits & 0xff));
+                mBits >>= 8;
+                mCount -= 8;
+            }
+        }
+
+        // Huffman codes are stored starting from the most significant bit
+        void writeCode(uint32_t code, int count)
+        {
+            uint32_t reversed = 0;
+            for (int i = 0; i < count; i++)
+                reversed |= ((code >> i) & 1) << (count - 1 - i);
+            write(reversed, count);
+        }
+
+        void flush()
+        {
+            if (mCount > 0)
+                mDst.emplace_back(uint8_t(mBits & 0xff));
+            mBits = 0;
+            mCount = 0;
+        }
+
+    private:
+        std::vector<uint8_t>& mDst;
+        uint32_t mBits;
+        int mCount;
+    };
+}
+
+static void writeLiteralOrLength(BitWriter& writer, int symbol)
+{
+    if (symbol < 144)
+        writer.writeCode(0x30 + symbol, 8);
+    else if (symbol < 256)
+        writer.writeCode(0x190 + symbol - 144, 9);
+    else if (symbol < 280)
+        writer.writeCode(symbol - 256, 7);
+    else
+        writer.writeCode(0xc0 + symbol - 280, 8);
+}
+
+static void writeMatch(BitWriter& writer, size_t length, size_t distance)
+{
+    int lengthCode = 28;
+    while (LengthBase[lengthCode] > length)
+        --lengthCode;
+    writeLiteralOrLength(writer, 257 + lengthCode);
+    writer.write(uint32_t(length - LengthBase[lengthCode]), LengthExtraBits[lengthCode]);
+
+    int distanceCode = 29;
+    while (DistanceBase[distanceCode] > distance)
+        --distanceCode;
+    writer.writeCode(uint32_t(distanceCode), 5);
+    writer.write(uint32_t(distance - DistanceBase[distanceCode]), DistanceExtraBits[distanceCode]);
+}
+
+static size_t hash(const uint8_t* p)
+{
+    uint32_t value = (uint32_t(p[0]) << 16) | (uint32_t(p[1]) << 8) | p[2];
+    return size_t((value * 2654435761u) >> (32 - HashBits));
+}
+
+void zlibCompress(const uint8_t* data, size_t size, std::vector<uint8_t>& dst)
+{
+    dst.clear();
+    dst.reserve(size / 2 + 16);
+    dst.emplace_back(0x78);     // deflate, 32K window
+    dst.emplace_back(0x9c);     // default compression level
+
+    BitWriter writer(dst);
+    writer.write(1, 1);         // final block
+    writer.write(1, 2);         // fixed Huffman codes
+
+    std::vector<size_t> head(size_t(1) << HashBits, NoPosition);
+    std::vector<size_t> prev(size, NoPosition);
+    auto insert = [&](size_t pos) {
+            if (pos + MinMatch <= size) {
+                size_t h = hash(data + pos);
+                prev[pos] = head[h];
+                head[h] = pos;
+            }
+        };
+
+    size_t pos = 0;
+    while (pos < size) {
+        size_t bestLength = 0;
+        size_t bestDistance = 0;
+
+        if (pos + MinMatch <= size) {
+            size_t maxLength = std::min(MaxMatch, size - pos);
+            size_t candidate = head[hash(data + pos)];
+            for (size_t chain = 0; candidate != NoPosition && chain < MaxChainLength; chain++) {
+                if (pos - candidate > WindowSize)
+                    break;
+
+                size_t length = 0;
+                while (length < maxLength && data[candidate + length] == data[pos + length])
+                    ++length;
+                if (length > bestLength) {
+                    bestLength = length;
+                    bestDistance = pos - candidate;
+                    if (length == maxLength)
+                        break;
+                }
+
+                candidate = prev[candidate];
+            }
+        }
+
+        if (bestLength >= MinMatch) {
+            writeMatch(writer, bestLength, bestDistance);
+            for (size_t i = 0; i < bestLength; i++)
+                insert(pos + i);
+            pos += bestLength;
+        } else {
+            writeLiteralOrLength(writer, data[pos]);
+            insert(pos);
+            ++pos;
+        }
+    }
+
+    writeLiteralOrLength(writer, 256);  // end of block
+    writer.flush();
+
+    uint32_t a = 1, b = 0;
+    for (size_t i = 0; i < size; i++) {
+        a = (a + data[i]) % 65521;
+        b = (b + a) % 65521;
+    }
+    uint32_t adler = (b << 16) | a;
+    dst.emplace_back(uint8_t(adler >> 24));
+    dst.emplace_back(uint8_t(adler >> 16));
+    dst.emplace_back(uint8_t(adler >> 8));
+    dst.emplace_back(uint8_t(adler));
+}
@@ -0,0 +1,9 @@
+#ifndef COMPILER_COMPRESSION_DEFLATE_H
+#define COMPILER_COMPRESSION_DEFLATE_H
+
+#include "Common/Common.h"
+
+// Produces zlib stream (RFC 1950) with a single fixed Huffman deflate block
+void zlibCompress(const uint8_t* data, size_t size, std::vector<uint8_t>& dst);
+
+#endif
@@ -0,0 +1,99 @@
+#include "Lz4.h"
+
+namespace
+{
+    const size_t WindowSize = 65535;
+    const size_t MinMatch = 4;
+    const size_t LastLiterals = 5;
+    const size_t MatchSafeDistance = 12;
+    const size_t MaxChainLength = 64;
+    const size_t HashBits = 16;
+    const size_t NoPosition = size_t(-1);
+}
+
+static size_t hash(const uint8_t* p)
+{
+    uint32_t value = uint32_t(p[0]) | (uint32_t(p[1]) << 8) | (uint32_t(p[2]) << 16) | (uint32_t(p[3]) << 24);
+    return size_t((value * 2654435761u) >> (32 - HashBits));
+}
+
+static void writeLength(std::vector<uint8_t>& dst, size_t length)
+{
+    for (; length >= 255; length -= 255)
+        dst.emplace_back(uint8_t(255));
+    dst.emplace_back(uint8_t(length));
+}
+
+static void writeSequence(std::vector<uint8_t>& dst, const uint8_t* literals, size_t literalCount,
+    size_t matchLength, size_t offset)
+{
+    size_t matchCode = (matchLength != 0 ? matchLength - MinMatch : 0);
+    dst.emplace_back(uint8_t((std::min<size_t>(literalCount, 15) << 4) | std::min<size_t>(matchCode, 15)));
+    if (literalCount >= 15)
+        writeLength(dst, literalCount - 15);
+    dst.insert(dst.end(), literals, literals + literalCount);
+
+    if (matchLength != 0) {
+        dst.emplace_back(uint8_t(offset & 0xff));
+        dst.emplace_back(uint8_t(offset >> 8));
+        if (matchCode >= 15)
+            writeLength(dst, matchCode - 15);
+    }
+}
+
+void lz4Compress(const uint8_t* data, size_t size, std::vector<uint8_t>& dst)
+{
+    dst.clear();
+    dst.reserve(size / 2 + 16);
+
+    std::vector<size_t> head(size_t(1) << HashBits, NoPosition);
+    std::vector<size_t> prev(size, NoPosition);
+    auto insert = [&](size_t pos) {
+            if (pos + MinMatch <= size) {
+                size_t h = hash(data + pos);
+                prev[pos] = head[h];
+                head[h] = pos;
+            }
+        };
+
+    // Format requires last match to start at least 12 bytes before the end and last 5 bytes to be literals
+    size_t matchLimit = (size > MatchSafeDistance ? size - MatchSafeDistance : 0);
+    size_t literalStart = 0;
+    size_t pos = 0;
+    while (pos < matchLimit) {
+        size_t bestLength = 0;
+        size_t bestOffset = 0;
+
+        size_t maxLength = size - LastLiterals - pos;
+        size_t candidate = head[hash(data + pos)];
+        for (size_t chain = 0; candidate != NoPosition && chain < MaxChainLength; chain++) {
+            if (pos - candidate > WindowSize)
+                break;
+
+            size_t length = 0;
+            while (length < maxLength && data[candidate + length] == data[pos + length])
+                ++length;
+            if (length > bestLength) {
+                bestLength = length;
+                bestOffset = pos - candidate;
+                if (length == maxLength)
+                    break;
+            }
+
+            candidate = prev[candidate];
+        }
+
+        if (bestLength >= MinMatch) {
+            writeSequence(dst, data + literalStart, pos - literalStart, bestLength, bestOffset);
+            for (size_t i = 0; i < bestLength; i++)
+                insert(pos + i);
+            pos += bestLength;
+            literalStart = pos;
+        } else {
+            insert(pos);
+            ++pos;
+        }
+    }
+
+    writeSequence(dst, data + literalStart, size - literalStart, 0, 0);
+}
@@ -0,0 +1,9 @@
+#ifndef COMPILER_COMPRESSION_LZ4_H
+#define COMPILER_COMPRESSION_LZ4_H
+
+#include "Common/Common.h"
+
+// Produces single LZ4 block (no frame), greedy parsing
+void lz4Compress(const uint8_t* data, size_t size, std::vector<uint8_t>& dst);
+
+#endif
@@ -12,6 +12,9 @@ public:
     Compression compression() const override;
     void compress(SourceLocation* location, std::vector<uint8_t> src, std::vector<uint8_t>& dst) override;
 
+private:
+    static int progressCallback(void* user, int current, int total);
+
     DISABLE_COPY(Lzsa2Compressor);
 };
 
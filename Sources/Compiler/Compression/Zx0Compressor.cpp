@@ -14,6 +14,11 @@ Zx0Compressor::~Zx0Compressor()
 {
 }
 
+int Zx0Compressor::progressCallback(void* user, int current, int total)
+{
+    return reinterpret_cast<Zx0Compressor*>(user)->reportProgress(current, total) ? 1 : 0;
+}
+
 Compression Zx0Compressor::compression() const
 {
     return (mQuick ? Compression::Zx0Quick : Compression::Zx0);
@@ -34,15 +39,20 @@ void Zx0Compressor::compress(SourceLocation* location, std::vector<uint8_t> src,
         if (!context)
             throw CompilerError(location, "zx0: out of memory.");
 
+        zx0_set_progress(context, progressCallback, this);
+
         optimal = zx0_optimize(context, src.data(), src.size(), 0, (mQuick ? 2176 : 32640));
-        if (!optimal)
+        if (!optimal) {
+            rethrowIfAborted();
             throw CompilerError(location, "zx0: out of memory.");
+        }
 
         int delta = 0;
         compressed = zx0_compress(optimal[src.size() - 1], src.data(), src.size(), 0, FALSE, &compressedSize, &delta);
         if (!compressed)
             throw CompilerError(location, "zx0: out of memory.");
 
+        setSafeDistance(delta);
         dst.reserve(dst.size() + compressedSize);
         dst.insert(dst.end(), compressed, compressed + compressedSize);
     } catch (...) {
@@ -15,6 +15,8 @@ public:
 private:
     bool mQuick;
 
+    static int progressCallback(void* user, int current, int total);
+
     DISABLE_COPY(Zx0Compressor);
 };
 
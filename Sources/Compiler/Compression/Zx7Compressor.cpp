@@ -13,6 +13,11 @@ Zx7Compressor::~Zx7Compressor()
 {
 }
 
+int Zx7Compressor::progressCallback(void* user, size_t current, size_t total)
+{
+    return reinterpret_cast<Zx7Compressor*>(user)->reportProgress(int64_t(current), int64_t(total)) ? 1 : 0;
+}
+
 Compression Zx7Compressor::compression() const
 {
     return Compression::Zx7;
@@ -28,15 +33,18 @@ void Zx7Compressor::compress(SourceLocation* location, std::vector<uint8_t> src,
         return;
 
     try {
-        optimal = zx7_optimize(src.data(), src.size(), 0);
-        if (!optimal)
+        optimal = zx7_optimize(src.data(), src.size(), 0, progressCallback, this);
+        if (!optimal) {
+            rethrowIfAborted();
             throw CompilerError(location, "zx7: out of memory.");
+        }
 
         long delta = 0;
         compressed = zx7_compress(optimal, src.data(), src.size(), 0, &compressedSize, &delta);
         if (!compressed)
             throw CompilerError(location, "zx7: out of memory.");
 
+        setSafeDistance(int64_t(delta));
         dst.reserve(dst.size() + compressedSize);
         dst.insert(dst.end(), compressed, compressed + compressedSize);
     } catch (...) {
@@ -12,6 +12,9 @@ public:
     Compression compression() const override;
     void compress(SourceLocation* location, std::vector<uint8_t> src, std::vector<uint8_t>& dst) override;
 
+private:
+    static int progressCallback(void* user, size_t current, size_t total);
+
     DISABLE_COPY(Zx7Compressor);
 };
 
@@ -11,6 +11,8 @@ const std::unordered_map<std::string, Expr*(ExpressionParser::*)()> ExpressionPa
         { "addressof", &ExpressionParser::parseAddressOfFunction },
         { "baseof", &ExpressionParser::parseBaseOfFunction },
         { "sizeof", &ExpressionParser::parseSizeOfFunction },
+        { "bankof", &ExpressionParser::parseBankOfFunction },
+        { "compressionof", &ExpressionParser::parseCompressionOfFunction },
     };
 
 ExpressionParser::ExpressionParser(GCHeap* heap,
@@ -534,3 +536,35 @@ Expr* ExpressionParser::parseSizeOfFunction()
 
     return expr;
 }
+
+Expr* ExpressionParser::parseBankOfFunction()
+{
+    mContext->ensureNotEol();
+
+    if (mContext->token()->id() != TOK_IDENTIFIER) {
+        mError = "expected section name.";
+        mErrorLocation = mContext->token()->location();
+        return nullptr;
+    }
+
+    Expr* expr = new (mHeap) ExprBankOfSection(mContext->token()->location(), mContext->token()->text());
+    mContext->nextToken();
+
+    return expr;
+}
+
+Expr* ExpressionParser::parseCompressionOfFunction()
+{
+    mContext->ensureNotEol();
+
+    if (mContext->token()->id() != TOK_IDENTIFIER) {
+        mError = "expected section name.";
+        mErrorLocation = mContext->token()->location();
+        return nullptr;
+    }
+
+    Expr* expr = new (mHeap) ExprCompressionOfSection(mContext->token()->location(), mContext->token()->text());
+    mContext->nextToken();
+
+    return expr;
+}
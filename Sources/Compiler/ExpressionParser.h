@@ -51,6 +51,8 @@ private:
     Expr* parseAddressOfFunction();
     Expr* parseBaseOfFunction();
     Expr* parseSizeOfFunction();
+    Expr* parseBankOfFunction();
+    Expr* parseCompressionOfFunction();
 
     DISABLE_COPY(ExpressionParser);
 };
@@ -1,4 +1,5 @@
 #include "CodeEmitter.h"
+#include "Compiler/CompilerError.h"
 
 CodeEmitter::CodeEmitter()
 {
@@ -7,3 +8,98 @@ CodeEmitter::CodeEmitter()
 CodeEmitter::~CodeEmitter()
 {
 }
+
+void CodeEmitter::resetTiming()
+{
+    mTiming = DebugInformation::Timing();
+    mInstructionTimings.clear();
+    mTStatesChecks.clear();
+}
+
+void CodeEmitter::addTStates(int64_t address, int minTStates, int maxTStates)
+{
+    if (minTStates > maxTStates)
+        std::swap(minTStates, maxTStates);
+
+    mInstructionTimings.emplace_back(InstructionTiming{ address, minTStates, maxTStates });
+    addInstructionDebugInfo(address, minTStates, maxTStates);
+
+    mTiming.tStates.min += minTStates;
+    mTiming.tStates.max += maxTStates;
+
+    if (!mTiming.labels.empty()) {
+        auto& label = mTiming.labels.back();
+        label.tStates.min += minTStates;
+        label.tStates.max += maxTStates;
+    }
+}
+
+void CodeEmitter::addLabelTiming(std::string name, int64_t address)
+{
+    mTiming.labels.emplace_back(DebugInformation::LabelTiming{ std::move(name), address, {} });
+}
+
+void CodeEmitter::addBranchTiming(std::string name, int64_t address, bool isShort,
+    const DebugInformation::TStates& tStates, const DebugInformation::TStates& alternative)
+{
+    mTiming.branches.emplace_back(DebugInformation::BranchTiming{
+        std::move(name), address, isShort, tStates, alternative });
+}
+
+void CodeEmitter::addTStatesCheck(const TStatesCheck& check)
+{
+    mTStatesChecks.emplace_back(check);
+}
+
+DebugInformation::TStates CodeEmitter::tStatesInRange(int64_t startAddress, int64_t endAddress) const
+{
+    DebugInformation::TStates tStates;
+    for (const auto& instruction : mInstructionTimings) {
+        if (instruction.address >= startAddress && instruction.address < endAddress) {
+            tStates.min += instruction.minTStates;
+            tStates.max += instruction.maxTStates;
+        }
+    }
+    return tStates;
+}
+
+void CodeEmitter::verifyTStatesChecks(int64_t sectionStart, int64_t sectionEnd) const
+{
+    for (const auto& check : mTStatesChecks) {
+        if (check.endAddress < check.startAddress) {
+            std::stringstream ss;
+            ss << "end address of the range (0x" << std::hex << std::uppercase << check.endAddress
+                << ") is less than start address (0x" << check.startAddress << ").";
+            throw CompilerError(check.location, ss.str());
+        }
+
+        // Only instructions of the current section are counted
+        if (check.startAddress < sectionStart || check.endAddress > sectionEnd) {
+            std::stringstream ss;
+            ss << "range 0x" << std::hex << std::uppercase << std::setw(4) << std::setfill('0')
+                << check.startAddress << "..0x" << std::setw(4) << check.endAddress
+                << " is outside of section 0x" << std::setw(4) << sectionStart
+                << "..0x" << std::setw(4) << sectionEnd << '.';
+            throw CompilerError(check.location, ss.str());
+        }
+
+        auto tStates = tStatesInRange(check.startAddress, check.endAddress);
+        if (check.exact ? (tStates.min != check.tStates || tStates.max != check.tStates) : tStates.max > check.tStates) {
+            std::stringstream ss;
+            ss << "code between 0x" << std::hex << std::uppercase << std::setw(4) << std::setfill('0')
+                << check.startAddress << " and 0x" << std::setw(4) << check.endAddress << std::dec
+                << " takes " << DebugInformation::tStatesToString(tStates) << " T-states, expected "
+                << (check.exact ? "exactly " : "at most ") << check.tStates << '.';
+            throw CompilerError(check.location, ss.str());
+        }
+    }
+}
+
+DebugInformation::Timing CodeEmitter::takeTiming()
+{
+    DebugInformation::Timing timing = std::move(mTiming);
+    mTiming = DebugInformation::Timing();
+    mInstructionTimings.clear();
+    mTStatesChecks.clear();
+    return timing;
+}
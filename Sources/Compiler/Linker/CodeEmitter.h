@@ -1,10 +1,9 @@
 #ifndef COMPILER_LINKER_CODEEMITTER_H
 #define COMPILER_LINKER_CODEEMITTER_H
 
-#include "Common/Common.h"
+#include "Compiler/Linker/DebugInformation.h"
 
 class SourceLocation;
-enum class Compression;
 
 class CodeEmitter
 {
@@ -15,12 +14,33 @@ public:
         uint8_t value;
     };
 
+    struct TStatesCheck
+    {
+        SourceLocation* location;
+        int64_t startAddress;
+        int64_t endAddress;
+        int64_t tStates;
+        bool exact;
+    };
+
     CodeEmitter();
     virtual ~CodeEmitter();
 
     virtual void addEmptySpaceDebugInfo(int64_t start, int64_t size) = 0;
     virtual void addSectionDebugInfo(std::string name, int64_t start,
-        Compression compression, int64_t uncompressedSize, std::optional<int64_t> compressedSize) = 0;
+        Compression compression, int64_t uncompressedSize, std::optional<int64_t> compressedSize,
+        std::optional<DebugInformation::Timing> timing) = 0;
+    virtual void addInstructionDebugInfo(int64_t address, int minTStates, int maxTStates) = 0;
+
+    void resetTiming();
+    void addTStates(int64_t address, int minTStates, int maxTStates);
+    void addLabelTiming(std::string name, int64_t address);
+    void addBranchTiming(std::string name, int64_t address, bool isShort,
+        const DebugInformation::TStates& tStates, const DebugInformation::TStates& alternative);
+    void addTStatesCheck(const TStatesCheck& check);
+    void verifyTStatesChecks(int64_t sectionStart, int64_t sectionEnd) const;
+    DebugInformation::TStates tStatesInRange(int64_t startAddress, int64_t endAddress) const;
+    DebugInformation::Timing takeTiming();
 
     virtual void emitByte(SourceLocation* location, uint8_t byte) = 0;
     virtual void emitBytes(SourceLocation* location, const uint8_t* bytes, size_t count) = 0;
@@ -28,6 +48,18 @@ public:
 
     virtual void copyTo(CodeEmitter* target) const = 0;
 
+private:
+    struct InstructionTiming
+    {
+        int64_t address;
+        int minTStates;
+        int maxTStates;
+    };
+
+    DebugInformation::Timing mTiming;
+    std::vector<InstructionTiming> mInstructionTimings;
+    std::vector<TStatesCheck> mTStatesChecks;
+
     DISABLE_COPY(CodeEmitter);
 };
 
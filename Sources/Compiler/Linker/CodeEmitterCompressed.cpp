@@ -5,6 +5,7 @@
 CodeEmitterCompressed::CodeEmitterCompressed(std::unique_ptr<Compressor> compressor)
     : mLocation(nullptr)
     , mCompressor(std::move(compressor))
+    , mUncompressedSize(0)
     , mCompressed(false)
 {
 }
@@ -27,10 +28,25 @@ const uint8_t* CodeEmitterCompressed::compressedData() const
     return mCompressedBytes.data();
 }
 
+size_t CodeEmitterCompressed::safeDistance() const
+{
+    if (!mCompressed)
+        throw CompilerError(mLocation, "internal compiler error: safe distance is not known at this point.");
+    return size_t(mCompressor->safeDistance());
+}
+
+Compression CodeEmitterCompressed::compression() const
+{
+    if (!mCompressed)
+        throw CompilerError(mLocation, "internal compiler error: compression is not known at this point.");
+    return mCompressor->compression();
+}
+
 void CodeEmitterCompressed::clear()
 {
     mCompressedBytes.clear();
     mUncompressedBytes.clear();
+    mUncompressedSize = 0;
     mCompressed = false;
 }
 
@@ -40,8 +56,8 @@ void CodeEmitterCompressed::addEmptySpaceDebugInfo(int64_t start, int64_t size)
         "internal compiler error: attempted to add empty space in compressed code emitter.");
 }
 
-void CodeEmitterCompressed::addSectionDebugInfo(std::string name, int64_t start,
-    Compression compression, int64_t uncompressedSize, std::optional<int64_t> compressedSize)
+void CodeEmitterCompressed::addSectionDebugInfo(std::string name, int64_t start, Compression compression,
+    int64_t uncompressedSize, std::optional<int64_t> compressedSize, std::optional<DebugInformation::Timing> timing)
 {
     if (mSection) {
         throw CompilerError(mLocation,
@@ -59,6 +75,12 @@ void CodeEmitterCompressed::addSectionDebugInfo(std::string name, int64_t start,
     mSection->compression = compression;
     mSection->uncompressedSize = uncompressedSize;
     mSection->compressedSize = compressedSize;
+    mSection->timing = std::move(timing);
+}
+
+void CodeEmitterCompressed::addInstructionDebugInfo(int64_t, int, int)
+{
+    // Instruction boundaries are lost in compressed stream
 }
 
 void CodeEmitterCompressed::emitByte(SourceLocation* location, uint8_t byte)
@@ -124,6 +146,7 @@ void CodeEmitterCompressed::compress()
     if (mCompressed)
         throw CompilerError(mLocation, "internal compiler error: data is already compressed.");
 
+    mUncompressedSize = mUncompressedBytes.size();
     mCompressor->compress(mLocation, std::move(mUncompressedBytes), mCompressedBytes);
     mCompressed = true;
 }
@@ -137,6 +160,6 @@ void CodeEmitterCompressed::copyTo(CodeEmitter* target) const
 
     if (mSection) {
         target->addSectionDebugInfo(mSection->name, mSection->startAddress,
-            mCompressor->compression(), mSection->uncompressedSize, mCompressedBytes.size());
+            mCompressor->compression(), mSection->uncompressedSize, mCompressedBytes.size(), mSection->timing);
     }
 }
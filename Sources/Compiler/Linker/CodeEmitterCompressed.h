@@ -12,14 +12,19 @@ public:
     explicit CodeEmitterCompressed(std::unique_ptr<Compressor> compressor);
     ~CodeEmitterCompressed();
 
+    size_t uncompressedSize() const { return mUncompressedSize; }
     size_t compressedSize() const;
     const uint8_t* compressedData() const;
+    size_t safeDistance() const;
+    Compression compression() const;
 
     void clear();
 
     void addEmptySpaceDebugInfo(int64_t start, int64_t size) override;
     void addSectionDebugInfo(std::string name, int64_t start,
-        Compression compression, int64_t uncompressedSize, std::optional<int64_t> compressedSize) override;
+        Compression compression, int64_t uncompressedSize, std::optional<int64_t> compressedSize,
+        std::optional<DebugInformation::Timing> timing) override;
+    void addInstructionDebugInfo(int64_t address, int minTStates, int maxTStates) override;
 
     void emitByte(SourceLocation* location, uint8_t byte) override;
     void emitBytes(SourceLocation* location, const uint8_t* bytes, size_t count) override;
@@ -37,6 +42,7 @@ private:
     std::unique_ptr<DebugInformation::Section> mSection;
     std::vector<uint8_t> mCompressedBytes;
     std::vector<uint8_t> mUncompressedBytes;
+    size_t mUncompressedSize;
     bool mCompressed;
 
     DISABLE_COPY(CodeEmitterCompressed);
@@ -11,6 +11,7 @@ CodeEmitterUncompressed::~CodeEmitterUncompressed()
 void CodeEmitterUncompressed::clear()
 {
     mBytes.clear();
+    mInstructions.clear();
 }
 
 void CodeEmitterUncompressed::addEmptySpaceDebugInfo(int64_t start, int64_t size)
@@ -18,11 +19,17 @@ void CodeEmitterUncompressed::addEmptySpaceDebugInfo(int64_t start, int64_t size
     mSections.emplace_back(DebugInformation::createEmptySpace(start, size));
 }
 
-void CodeEmitterUncompressed::addSectionDebugInfo(std::string name, int64_t start,
-    Compression compression, int64_t uncompressedSize, std::optional<int64_t> compressedSize)
+void CodeEmitterUncompressed::addSectionDebugInfo(std::string name, int64_t start, Compression compression,
+    int64_t uncompressedSize, std::optional<int64_t> compressedSize, std::optional<DebugInformation::Timing> timing)
 {
     mSections.emplace_back(DebugInformation::createSection(std::move(name),
-        start, compression, uncompressedSize, std::move(compressedSize)));
+        start, compression, uncompressedSize, std::move(compressedSize), std::move(timing)));
+}
+
+void CodeEmitterUncompressed::addInstructionDebugInfo(int64_t address, int minTStates, int maxTStates)
+{
+    mInstructions.emplace_back(InstructionInfo{
+        uint32_t(mBytes.size()), uint16_t(address), uint16_t(minTStates), uint16_t(maxTStates) });
 }
 
 void CodeEmitterUncompressed::emitByte(SourceLocation* location, uint8_t byte)
@@ -64,14 +71,20 @@ void CodeEmitterUncompressed::emitBytes(const Byte* bytes, size_t count)
 
 void CodeEmitterUncompressed::copyTo(CodeEmitter* target) const
 {
-    target->emitBytes(mBytes.data(), mBytes.size());
+    size_t offset = 0;
+    for (const auto& instruction : mInstructions) {
+        target->emitBytes(mBytes.data() + offset, instruction.offset - offset);
+        target->addInstructionDebugInfo(instruction.address, instruction.minTStates, instruction.maxTStates);
+        offset = instruction.offset;
+    }
+    target->emitBytes(mBytes.data() + offset, mBytes.size() - offset);
 
     for (const auto& section : mSections) {
         if (section.isEmptySpace)
             target->addEmptySpaceDebugInfo(section.startAddress, section.uncompressedSize);
         else {
             target->addSectionDebugInfo(section.name, section.startAddress,
-                section.compression, section.uncompressedSize, section.compressedSize);
+                section.compression, section.uncompressedSize, section.compressedSize, section.timing);
         }
     }
 }
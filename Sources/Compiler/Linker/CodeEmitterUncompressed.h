@@ -7,17 +7,28 @@
 class CodeEmitterUncompressed : public CodeEmitter
 {
 public:
+    struct InstructionInfo
+    {
+        uint32_t offset;        // of the first byte of the instruction
+        uint16_t address;
+        uint16_t minTStates;
+        uint16_t maxTStates;
+    };
+
     CodeEmitterUncompressed();
     ~CodeEmitterUncompressed();
 
     size_t size() const { return mBytes.size(); }
     const Byte* data() const { return mBytes.data(); }
+    const std::vector<InstructionInfo>& instructions() const { return mInstructions; }
 
     void clear();
 
     void addEmptySpaceDebugInfo(int64_t start, int64_t size) override;
     void addSectionDebugInfo(std::string name, int64_t start,
-        Compression compression, int64_t uncompressedSize, std::optional<int64_t> compressedSize) override;
+        Compression compression, int64_t uncompressedSize, std::optional<int64_t> compressedSize,
+        std::optional<DebugInformation::Timing> timing) override;
+    void addInstructionDebugInfo(int64_t address, int minTStates, int maxTStates) override;
 
     void emitByte(SourceLocation* location, uint8_t byte) final override;
     void emitBytes(SourceLocation* location, const uint8_t* bytes, size_t count) final override;
@@ -28,6 +39,7 @@ public:
 private:
     std::vector<DebugInformation::Section> mSections;
     std::vector<Byte> mBytes;
+    std::vector<InstructionInfo> mInstructions;
 
     DISABLE_COPY(CodeEmitterUncompressed);
 };
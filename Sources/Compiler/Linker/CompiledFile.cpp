@@ -2,11 +2,13 @@
 #include "Compiler/Linker/DebugInformation.h"
 
 CompiledFile::CompiledFile(SourceLocation* location, std::string name, std::unique_ptr<DebugInformation> debugInfo)
-    : mLocation(location)
-    , mName(std::move(name))
+    : mName(std::move(name))
     , mDebugInfo(std::move(debugInfo))
     , mLoadAddress(0)
+    , mFingerprint(0)
+    , mLocation(location)
     , mUsedByBasic(false)
+    , mListingEnabled(false)
 {
     registerFinalizer();
 }
@@ -21,13 +23,18 @@ std::unique_ptr<DebugInformation> CompiledFile::takeDebugInfo()
     return info;
 }
 
+void CompiledFile::addWarning(SourceLocation* location, std::string message)
+{
+    mWarnings.emplace_back(Warning{ location, std::move(message) });
+}
+
 void CompiledFile::addEmptySpaceDebugInfo(int64_t start, int64_t size)
 {
     mDebugInfo->addEmptySpace(start, size);
 }
 
-void CompiledFile::addSectionDebugInfo(std::string name, int64_t start,
-    Compression compression, int64_t uncompressedSize, std::optional<int64_t> compressedSize)
+void CompiledFile::addSectionDebugInfo(std::string name, int64_t start, Compression compression,
+    int64_t uncompressedSize, std::optional<int64_t> compressedSize, std::optional<DebugInformation::Timing> timing)
 {
-    mDebugInfo->addSection(std::move(name), start, compression, uncompressedSize, compressedSize);
+    mDebugInfo->addSection(std::move(name), start, compression, uncompressedSize, compressedSize, std::move(timing));
 }
@@ -9,6 +9,12 @@ class DebugInformation;
 class CompiledFile final : public GCObject, public CodeEmitterUncompressed
 {
 public:
+    struct Warning
+    {
+        SourceLocation* location;
+        std::string message;
+    };
+
     CompiledFile(SourceLocation* location, std::string name, std::unique_ptr<DebugInformation> debugInfo);
     ~CompiledFile() override;
 
@@ -18,9 +24,13 @@ public:
     DebugInformation* debugInfo() const { return mDebugInfo.get(); }
     std::unique_ptr<DebugInformation> takeDebugInfo();
 
+    const std::vector<Warning>& warnings() const { return mWarnings; }
+    void addWarning(SourceLocation* location, std::string message);
+
     void addEmptySpaceDebugInfo(int64_t start, int64_t size) override;
     void addSectionDebugInfo(std::string name, int64_t start,
-        Compression compression, int64_t uncompressedSize, std::optional<int64_t> compressedSize) override;
+        Compression compression, int64_t uncompressedSize, std::optional<int64_t> compressedSize,
+        std::optional<DebugInformation::Timing> timing) override;
 
     size_t loadAddress() const { return mLoadAddress; }
     void setLoadAddress(size_t address) { mLoadAddress = address; }
@@ -28,12 +38,26 @@ public:
     bool isUsedByBasic() const { return mUsedByBasic; }
     void setUsedByBasic() { mUsedByBasic = true; }
 
+    bool isListingEnabled() const { return mListingEnabled; }
+    void enableListing() { mListingEnabled = true; }
+
+    const std::vector<size_t>& relocations() const { return mRelocations; }
+    void addRelocation(size_t offset) { mRelocations.emplace_back(offset); }
+
+    // Changes whenever anything generated from this file (code, source map, debug information) changes
+    uint64_t fingerprint() const { return mFingerprint; }
+    void setFingerprint(uint64_t fingerprint) { mFingerprint = fingerprint; }
+
 private:
     std::string mName;
     std::unique_ptr<DebugInformation> mDebugInfo;
+    std::vector<Warning> mWarnings;
+    std::vector<size_t> mRelocations;
     size_t mLoadAddress;
+    uint64_t mFingerprint;
     SourceLocation* mLocation;
     bool mUsedByBasic;
+    bool mListingEnabled;
 
     DISABLE_COPY(CompiledFile);
 };
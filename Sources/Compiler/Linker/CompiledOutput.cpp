@@ -33,3 +33,14 @@ CompiledFile* CompiledOutput::addFile(SourceLocation* location, SourceLocation*
 
     return file;
 }
+
+const std::vector<CompiledFile*>* CompiledOutput::getFileGroup(const std::string& name) const
+{
+    auto it = mFileGroups.find(name);
+    return (it != mFileGroups.end() ? &it->second : nullptr);
+}
+
+void CompiledOutput::addFileToGroup(const std::string& name, CompiledFile* file)
+{
+    mFileGroups[name].emplace_back(file);
+}
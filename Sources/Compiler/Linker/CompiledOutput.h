@@ -17,8 +17,12 @@ public:
     CompiledFile* addFile(SourceLocation* location, SourceLocation* nameLocation,
         const std::string& name, std::unique_ptr<DebugInformation> debugInfo);
 
+    const std::vector<CompiledFile*>* getFileGroup(const std::string& name) const;
+    void addFileToGroup(const std::string& name, CompiledFile* file);
+
 private:
     std::unordered_map<std::string, CompiledFile*> mFiles;
+    std::unordered_map<std::string, std::vector<CompiledFile*>> mFileGroups;
     std::vector<CompiledFile*> mFileList;
 
     DISABLE_COPY(CompiledOutput);
@@ -13,11 +13,21 @@ void DebugInformation::addEmptySpace(int64_t start, int64_t size)
     mSections.emplace_back(createEmptySpace(start, size));
 }
 
-void DebugInformation::addSection(std::string name, int64_t start,
-    Compression compression, int64_t uncompressedSize, std::optional<int64_t> compressedSize)
+void DebugInformation::addSection(std::string name, int64_t start, Compression compression,
+    int64_t uncompressedSize, std::optional<int64_t> compressedSize, std::optional<Timing> timing)
 {
     mSections.emplace_back(createSection(std::move(name),
-        start, compression, uncompressedSize, std::move(compressedSize)));
+        start, compression, uncompressedSize, std::move(compressedSize), std::move(timing)));
+}
+
+void DebugInformation::addMemoryRegion(MemoryRegion region)
+{
+    mMemoryRegions.emplace_back(std::move(region));
+}
+
+void DebugInformation::addRemovedSection(RemovedSection section)
+{
+    mRemovedSections.emplace_back(std::move(section));
 }
 
 DebugInformation::Section DebugInformation::createEmptySpace(int64_t start, int64_t size)
@@ -32,8 +42,8 @@ DebugInformation::Section DebugInformation::createEmptySpace(int64_t start, int6
     return section;
 }
 
-DebugInformation::Section DebugInformation::createSection(std::string name, int64_t start,
-    Compression compression, int64_t uncompressedSize, std::optional<int64_t> compressedSize)
+DebugInformation::Section DebugInformation::createSection(std::string name, int64_t start, Compression compression,
+    int64_t uncompressedSize, std::optional<int64_t> compressedSize, std::optional<Timing> timing)
 {
     Section section;
     section.name = std::move(name);
@@ -41,6 +51,101 @@ DebugInformation::Section DebugInformation::createSection(std::string name, int6
     section.startAddress = start;
     section.uncompressedSize = uncompressedSize;
     section.compressedSize = std::move(compressedSize);
+    section.timing = std::move(timing);
     section.isEmptySpace = false;
     return section;
 }
+
+std::string DebugInformation::tStatesToString(const TStates& tStates)
+{
+    std::stringstream ss;
+    ss << tStates.min;
+    if (tStates.max != tStates.min)
+        ss << ".." << tStates.max;
+    return ss.str();
+}
+
+void DebugInformation::writeTimingReport(std::stringstream& ss) const
+{
+    for (const auto& section : mSections) {
+        if (section.isEmptySpace || !section.timing || section.uncompressedSize == 0)
+            continue;
+
+        ss << "section " << section.name << " at 0x"
+            << std::hex << std::setw(4) << std::setfill('0') << std::uppercase << section.startAddress
+            << std::dec << std::setfill(' ') << ": " << tStatesToString(section.timing->tStates) << " T\n";
+
+        if (section.timing->optimization) {
+            const auto& optimization = *section.timing->optimization;
+            ss << "    peephole: saved " << optimization.bytesSaved << " bytes, "
+                << tStatesToString(optimization.tStatesSaved) << " T (" << optimization.rewrites << " rewrites)\n";
+        }
+
+        for (const auto& label : section.timing->labels) {
+            ss << "    0x" << std::hex << std::setw(4) << std::setfill('0') << std::uppercase << label.address
+                << std::dec << std::setfill(' ') << "  " << std::left << std::setw(32) << label.name
+                << std::right << ' ' << tStatesToString(label.tStates) << " T\n";
+        }
+
+        for (const auto& branch : section.timing->branches) {
+            ss << "    0x" << std::hex << std::setw(4) << std::setfill('0') << std::uppercase << branch.address
+                << std::dec << std::setfill(' ') << "  " << std::left << std::setw(32) << branch.name
+                << std::right << ' ' << tStatesToString(branch.tStates) << " T ("
+                << (branch.isShort ? "jp: " : "jr: ") << tStatesToString(branch.alternative) << " T)\n";
+        }
+    }
+}
+
+std::string DebugInformation::contentionToString(const MemoryRegion& region)
+{
+    std::stringstream ss;
+
+    if (region.contendedBytes == 0)
+        ss << "uncontended";
+    else if (region.contendedBytes == region.size)
+        ss << "contended";
+    else
+        ss << region.contendedBytes << " contended";
+
+    if (region.uncontendedRequired && region.contendedBytes != 0)
+        ss << " (uncontended memory requested)";
+
+    return ss.str();
+}
+
+void DebugInformation::writeMemoryMap(std::stringstream& ss) const
+{
+    int64_t totalSize = 0;
+    int64_t totalContended = 0;
+
+    if (mBank)
+        ss << "bank " << *mBank << '\n';
+
+    for (const auto& region : mMemoryRegions) {
+        ss << "section " << region.name << " at 0x"
+            << std::hex << std::setw(4) << std::setfill('0') << std::uppercase << region.startAddress;
+        if (region.size > 0)
+            ss << "..0x" << std::setw(4) << (region.startAddress + region.size - 1);
+        ss << std::dec << std::setfill(' ') << ": " << region.size << " bytes, " << contentionToString(region) << '\n';
+
+        totalSize += region.size;
+        totalContended += region.contendedBytes;
+    }
+
+    ss << "contended: " << totalContended << " of " << totalSize << " bytes\n";
+    if (mRecoveredGapBytes)
+        ss << "gaps filled: " << *mRecoveredGapBytes << " bytes recovered\n";
+
+    if (!mRemovedSections.empty()) {
+        int64_t totalRemoved = 0;
+        for (const auto& section : mRemovedSections) {
+            ss << "removed section " << section.name << ": ";
+            if (section.size) {
+                ss << *section.size << " bytes\n";
+                totalRemoved += *section.size;
+            } else
+                ss << "size unknown\n";
+        }
+        ss << "removed: " << totalRemoved << " bytes\n";
+    }
+}
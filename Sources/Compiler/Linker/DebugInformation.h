@@ -6,6 +6,58 @@
 class DebugInformation
 {
 public:
+    struct TStates
+    {
+        int64_t min = 0;
+        int64_t max = 0;
+    };
+
+    struct LabelTiming
+    {
+        std::string name;
+        int64_t address;
+        TStates tStates;        // from this label up to the next one (or end of section)
+    };
+
+    struct BranchTiming
+    {
+        std::string name;
+        int64_t address;
+        bool isShort;
+        TStates tStates;
+        TStates alternative;    // of the encoding that was not chosen
+    };
+
+    struct Optimization
+    {
+        int rewrites = 0;
+        int64_t bytesSaved = 0;
+        TStates tStatesSaved;
+    };
+
+    struct Timing
+    {
+        TStates tStates;
+        std::vector<LabelTiming> labels;
+        std::vector<BranchTiming> branches;
+        std::optional<Optimization> optimization;
+    };
+
+    struct MemoryRegion
+    {
+        std::string name;
+        int64_t startAddress;
+        int64_t size;
+        int64_t contendedBytes;
+        bool uncontendedRequired;
+    };
+
+    struct RemovedSection
+    {
+        std::string name;
+        std::optional<int64_t> size;
+    };
+
     struct Section
     {
         std::string name;
@@ -13,6 +65,7 @@ public:
         int64_t startAddress;
         int64_t uncompressedSize;
         std::optional<int64_t> compressedSize;
+        std::optional<Timing> timing;
         bool isEmptySpace;
     };
 
@@ -20,17 +73,36 @@ public:
     ~DebugInformation();
 
     const std::vector<Section>& sections() const { return mSections; }
+    const std::vector<MemoryRegion>& memoryRegions() const { return mMemoryRegions; }
+    const std::vector<RemovedSection>& removedSections() const { return mRemovedSections; }
+
+    const std::optional<int>& bank() const { return mBank; }
+    void setBank(int bank) { mBank = bank; }
+
+    const std::optional<int64_t>& recoveredGapBytes() const { return mRecoveredGapBytes; }
+    void setRecoveredGapBytes(int64_t bytes) { mRecoveredGapBytes = bytes; }
 
     void addEmptySpace(int64_t start, int64_t size);
-    void addSection(std::string name, int64_t start,
-        Compression compression, int64_t uncompressedSize, std::optional<int64_t> compressedSize);
+    void addSection(std::string name, int64_t start, Compression compression,
+        int64_t uncompressedSize, std::optional<int64_t> compressedSize, std::optional<Timing> timing);
+    void addMemoryRegion(MemoryRegion region);
+    void addRemovedSection(RemovedSection section);
 
     static Section createEmptySpace(int64_t start, int64_t size);
-    static Section createSection(std::string name, int64_t start,
-        Compression compression, int64_t uncompressedSize, std::optional<int64_t> compressedSize);
+    static Section createSection(std::string name, int64_t start, Compression compression,
+        int64_t uncompressedSize, std::optional<int64_t> compressedSize, std::optional<Timing> timing);
+
+    static std::string tStatesToString(const TStates& tStates);
+    static std::string contentionToString(const MemoryRegion& region);
+    void writeTimingReport(std::stringstream& ss) const;
+    void writeMemoryMap(std::stringstream& ss) const;
 
 private:
     std::vector<Section> mSections;
+    std::vector<MemoryRegion> mMemoryRegions;
+    std::vector<RemovedSection> mRemovedSections;
+    std::optional<int> mBank;
+    std::optional<int64_t> mRecoveredGapBytes;
 
     DISABLE_COPY(DebugInformation);
 };
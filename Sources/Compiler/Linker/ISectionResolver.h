@@ -13,6 +13,9 @@ public:
     virtual bool tryResolveSectionAddress(SourceLocation* location, const std::string& name, uint64_t& value) const = 0;
     virtual bool tryResolveSectionBase(SourceLocation* location, const std::string& name, uint64_t& value) const = 0;
     virtual bool tryResolveSectionSize(SourceLocation* location, const std::string& name, uint64_t& value) const = 0;
+    virtual bool tryResolveSectionBank(SourceLocation* location, const std::string& name, uint64_t& value) const = 0;
+    virtual bool tryResolveSectionCompression(SourceLocation* location, const std::string& name, uint64_t& value) const = 0;
+    virtual void checkCancelation() const = 0;
 };
 
 #endif
@@ -1,16 +1,24 @@
 #include "Linker.h"
 #include "Common/GC.h"
+#include "Common/Hasher.h"
 #include "Compiler/Tree/Expr.h"
 #include "Compiler/Tree/SourceLocation.h"
 #include "Compiler/Tree/Symbol.h"
 #include "Compiler/Tree/SymbolTable.h"
+#include "Compiler/Tree/SymbolReferences.h"
 #include "Compiler/Linker/CompiledOutput.h"
 #include "Compiler/Linker/CodeEmitterCompressed.h"
 #include "Compiler/Linker/ProgramSection.h"
 #include "Compiler/Linker/Program.h"
 #include "Compiler/Linker/DebugInformation.h"
+#include "Compiler/Linker/MemoryBanks.h"
+#include "Compiler/Linker/Relocator.h"
 #include "Compiler/Assembler/Label.h"
 #include "Compiler/Compression/Compressor.h"
+#include "Compiler/Compression/Decompressor.h"
+#include "Compiler/Assembler/AssemblerParser.h"
+#include "Compiler/Lexer.h"
+#include "Compiler/Output/TurboLoader.h"
 #include "Compiler/Project.h"
 #include "Compiler/ExpressionParser.h"
 #include "Compiler/CompilerError.h"
@@ -25,11 +33,35 @@
 
 namespace
 {
+    class CompressionProgress : public ICompressorListener
+    {
+    public:
+        CompressionProgress(ILinkerListener* listener, std::string message)
+            : mListener(listener)
+            , mMessage(std::move(message))
+        {
+        }
+
+        void compressorProgress(int64_t current, int64_t total) override
+        {
+            if (mListener) {
+                mListener->checkCancelation();
+                mListener->linkerProgress(current, total, mMessage);
+            }
+        }
+
+    private:
+        ILinkerListener* mListener;
+        std::string mMessage;
+    };
+
     struct LinkerSection : public GCObject
     {
         SourceLocation* location;
         ProgramSection* programSection;
         Project::Section::Attachment attachment;
+        Project::Section::Memory memory;
+        SourceLocation* memoryLocation;
         Compression compression;
         SourceLocation* compressionLocation;
         std::unique_ptr<CodeEmitter> code;
@@ -43,30 +75,73 @@ namespace
         bool labelsResolved;
         bool autoFileOffset;
         bool autoFileOffsetNoPadding;
+        bool inPlace;
     };
 }
 
+static uint64_t fingerprint(const CompiledFile* file)
+{
+    Hasher fingerprint;
+    fingerprint.add(int64_t(file->loadAddress()));
+    fingerprint.add(int64_t(file->debugInfo()->bank().value_or(-1)));
+    fingerprint.add(int64_t(file->isListingEnabled()));
+
+    for (const auto& section : file->debugInfo()->sections()) {
+        fingerprint.add(section.name);
+        fingerprint.add(section.startAddress);
+        fingerprint.add(int64_t(section.compression));
+        fingerprint.add(section.uncompressedSize);
+        fingerprint.add(section.compressedSize.value_or(-1));
+        if (section.timing) {
+            for (const auto& label : section.timing->labels) {
+                fingerprint.add(label.name);
+                fingerprint.add(label.address);
+            }
+        }
+    }
+
+    const CodeEmitter::Byte* bytes = file->data();
+    size_t size = file->size();
+    const SourceLocation* location = nullptr;
+    for (size_t i = 0; i < size; i++) {
+        const SourceLocation* current = bytes[i].location;
+        if (i == 0 || current != location) {
+            location = current;
+            fingerprint.add(location ? location->file()->name().string() : std::string());
+            fingerprint.add(int64_t(location ? location->line() : 0));
+        }
+        fingerprint.add(&bytes[i].value, 1);
+    }
+
+    return fingerprint.value();
+}
+
 ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
 class Linker::LinkerFile : public GCObject
 {
 public:
-    LinkerFile(std::unordered_set<std::string>& usedSections,
-            ISectionResolver* sectionResolver, const Project::File* file, Program* program)
+    LinkerFile(std::unordered_set<std::string>& usedSections, const std::unordered_set<std::string>& strippedSections,
+            ISectionResolver* sectionResolver, ILinkerListener* listener, const Project::File* file, Program* program)
         : mProgram(program)
         , mFile(file)
         , mDebugInfo(new DebugInformation())
+        , mBank(bankForFileName(file->name))
         , mSectionResolver(sectionResolver)
+        , mListener(listener)
         , mIsResolved(false)
     {
         registerFinalizer();
 
+        if (mBank)
+            mDebugInfo->setBank(*mBank);
+
         mFileStart = tryParseExpression(file->startLocation, file->start);
         mFileUntil = tryParseExpression(file->untilLocation, file->until);
 
         mSections.reserve(file->sections.size());
         for (const auto& it : file->sections)
-            addSection(usedSections, it.get());
+            addSection(usedSections, strippedSections, it.get());
 
         // try calculate size for all uncompressed sections
 
@@ -144,6 +219,9 @@ public:
                 else if (!section->autoFileOffsetNoPadding && section->compression == Compression::None)
                     section->resolvedFileOffset = *section->resolvedBase;
 
+                if (section->inPlace)
+                    hasSectionWithKnownFileOffset = true;
+
                 if (section->resolvedFileOffset.has_value()) {
                   #if defined(_WIN32) && defined(DEBUG_LINKER) && !defined(NDEBUG)
                     { std::stringstream ss;
@@ -171,11 +249,14 @@ public:
             }
         }
 
+        if (file->fillGaps)
+            fillGaps();
+
         // convert all "lower" sections at the beginning of file to "upper" if file start is unspecified
 
         if (!mFileStart) {
             for (auto section : mSections) {
-                if (section->resolvedFileOffset)
+                if (section->resolvedFileOffset || section->inPlace)
                     break;
                 if (section->attachment == Project::Section::Upper)
                     break;
@@ -187,7 +268,7 @@ public:
 
         if (!mFileUntil) {
             for (auto section : mSections) {
-                if (section->resolvedFileOffset)
+                if (section->resolvedFileOffset || section->inPlace)
                     break;
                 if (section->attachment != Project::Section::Upper)
                     break;
@@ -268,6 +349,8 @@ public:
         // Try to resolve size and labels for sections
 
         for (auto section : mSections) {
+            mSectionResolver->checkCancelation();
+
             if (section->compression == Compression::None && !section->resolvedSize) {
                 size_t size = 0;
                 bool sizeResolved = false;
@@ -359,8 +442,9 @@ public:
                 baseAddress = 0;
             }
 
-            auto compressor = Compressor::create(section->compressionLocation, section->compression);
-            auto code = std::make_unique<CodeEmitterCompressed>(std::move(compressor));
+            auto compressorPtr = Compressor::create(section->compressionLocation, section->compression);
+            Compressor* compressor = compressorPtr.get();
+            auto code = std::make_unique<CodeEmitterCompressed>(std::move(compressorPtr));
 
             if (section->programSection->emitCode(code.get(), baseAddress, mSectionResolver, resolveError)) {
               #if defined(_WIN32) && defined(DEBUG_LINKER) && !defined(NDEBUG)
@@ -370,7 +454,12 @@ public:
                 OutputDebugStringA(ss.str().c_str()); }
               #endif
 
+                std::stringstream ss;
+                ss << "Compressing section \"" << section->programSection->name() << "\"...";
+                CompressionProgress progress(mListener, ss.str());
+                compressor->setListener(&progress);
                 code->compress();
+                compressor->setListener(nullptr);
 
                 section->resolvedSize = code->compressedSize();
               #if defined(_WIN32) && defined(DEBUG_LINKER) && !defined(NDEBUG)
@@ -383,6 +472,9 @@ public:
                 section->compressedCode = code.get();
                 section->code = std::move(code);
                 didResolve = true;
+
+                if (section->inPlace)
+                    placeForInPlaceDecompression(section);
             }
         }
 
@@ -501,6 +593,11 @@ public:
                 } while (targetOffset > offset);
             }
 
+            if (section->compressedCode && section->base)
+                checkDecompressionOverlap(section);
+
+            checkContention(output, section);
+
             if (section->code)
                 section->code->copyTo(output);
             else {
@@ -542,9 +639,119 @@ public:
 
         // FIXME: how system handles sections with wrong order in project file (regarding base address)?
 
+        if (mFile->relocatable)
+            generateRelocations(output, startAddress);
+
         output->setLoadAddress(startAddress);
     }
 
+    void generateRelocations(CompiledFile* output, size_t startAddress)
+    {
+        // Code is generated again with the whole file moved by an odd number of bytes. Words that changed by
+        // exactly that amount are addresses inside of the file, any other change can't be expressed as a fixup.
+
+        const int64_t Shift = 0x0103;
+
+        size_t lowestBase = 0xffff;
+        size_t highestEnd = 0;
+        for (auto section : mSections) {
+            if (section->compression != Compression::None) {
+                std::stringstream ss;
+                ss << "section \"" << section->programSection->name()
+                   << "\" in relocatable file \"" << mFile->name << "\" can't be compressed.";
+                throw CompilerError(section->compressionLocation, ss.str());
+            }
+            lowestBase = std::min(lowestBase, section->resolvedBase.value());
+            highestEnd = std::max(highestEnd, section->resolvedBase.value() + section->resolvedSize.value());
+        }
+
+        int64_t shift;
+        if (highestEnd + Shift <= 0x10000)
+            shift = Shift;
+        else if (lowestBase >= size_t(Shift))
+            shift = -Shift;
+        else {
+            std::stringstream ss;
+            ss << "relocatable file \"" << mFile->name << "\" is too large.";
+            throw CompilerError(mFile->relocatableLocation, ss.str());
+        }
+
+        std::vector<std::unique_ptr<CodeEmitterUncompressed>> shiftedCode;
+        try {
+            moveSections(shift);
+            for (auto section : mSections) {
+                auto code = std::make_unique<CodeEmitterUncompressed>();
+                std::unique_ptr<CompilerError> resolveError;
+                if (!section->programSection->emitCode(code.get(),
+                        section->resolvedBase.value(), mSectionResolver, resolveError)) {
+                    if (resolveError)
+                        throw* resolveError;
+
+                    std::stringstream ss;
+                    ss << "unable to relocate section \"" << section->programSection->name()
+                       << "\" in file \"" << mFile->name << "\".";
+                    throw CompilerError(section->location, ss.str());
+                }
+                shiftedCode.emplace_back(std::move(code));
+            }
+        } catch (...) {
+            moveSections(-shift);
+            throw;
+        }
+        moveSections(-shift);
+
+        const CodeEmitter::Byte* bytes = output->data();
+        for (size_t i = 0; i < mSections.size(); i++) {
+            size_t offset = mSections[i]->resolvedFileOffset.value() - startAddress;
+            const auto* code = shiftedCode[i].get();
+            size_t size = code->size();
+            assert(size == mSections[i]->resolvedSize.value());
+
+            const CodeEmitter::Byte* shifted = code->data();
+            for (size_t j = 0; j < size; j++) {
+                if (shifted[j].value == bytes[offset + j].value)
+                    continue;
+
+                if (j + 1 < size) {
+                    unsigned word = bytes[offset + j].value | (bytes[offset + j + 1].value << 8);
+                    unsigned shiftedWord = shifted[j].value | (shifted[j + 1].value << 8);
+                    if (((shiftedWord - word) & 0xffff) == (unsigned(shift) & 0xffff)) {
+                        output->addRelocation(offset + j);
+                        ++j;
+                        continue;
+                    }
+                }
+
+                std::stringstream ss;
+                ss << "value depends on address of relocatable file \"" << mFile->name << "\" and can't be relocated.";
+                throw CompilerError(bytes[offset + j].location, ss.str());
+            }
+        }
+    }
+
+    void moveSections(int64_t shift)
+    {
+        for (auto section : mSections) {
+            section->programSection->unresolveLabels();
+            section->resolvedBase = size_t(int64_t(section->resolvedBase.value()) + shift);
+            section->resolvedFileOffset = size_t(int64_t(section->resolvedFileOffset.value()) + shift);
+        }
+
+        for (auto section : mSections) {
+            size_t address = section->resolvedBase.value();
+            std::unique_ptr<CompilerError> resolveError;
+            if (!section->programSection->resolveLabels(address, mSectionResolver, resolveError)) {
+                if (resolveError)
+                    throw* resolveError;
+
+                std::stringstream ss;
+                ss << "unable to relocate section \"" << section->programSection->name()
+                   << "\" in file \"" << mFile->name << "\".";
+                throw CompilerError(section->location, ss.str());
+            }
+        }
+    }
+
     bool isValidSectionName(const std::string& name) const
     {
         return mSectionsByName.find(name) != mSectionsByName.end();
@@ -578,6 +785,34 @@ public:
         return true;
     }
 
+    bool tryResolveSectionBank(const std::string& sectionName, uint64_t& value) const
+    {
+        if (!mBank || mSectionsByName.find(sectionName) == mSectionsByName.end())
+            return false;
+
+        value = uint64_t(*mBank);
+        return true;
+    }
+
+    bool tryResolveSectionCompression(const std::string& sectionName, uint64_t& value) const
+    {
+        auto it = mSectionsByName.find(sectionName);
+        if (it == mSectionsByName.end())
+            return false;
+
+        // "best" modes select the codec when the section is compressed
+        LinkerSection* section = it->second;
+        Compression compression = section->compression;
+        if (compression == Compression::Best || compression == Compression::BestFast) {
+            if (!section->compressedCode)
+                return false;
+            compression = section->compressedCode->compression();
+        }
+
+        value = uint64_t(decompressorCodec(compression));
+        return true;
+    }
+
     bool tryResolveSectionSize(const std::string& sectionName, uint64_t& value) const
     {
         auto it = mSectionsByName.find(sectionName);
@@ -596,15 +831,18 @@ private:
     Program* mProgram;
     const Project::File* mFile;
     std::unique_ptr<DebugInformation> mDebugInfo;
+    std::optional<int> mBank;
     std::unordered_set<ProgramSection*> mSectionSet;
     std::vector<LinkerSection*> mSections;
     std::unordered_map<std::string, LinkerSection*> mSectionsByName;
     ISectionResolver* mSectionResolver;
+    ILinkerListener* mListener;
     Expr* mFileStart;
     Expr* mFileUntil;
     bool mIsResolved;
 
-    void addSection(std::unordered_set<std::string>& usedSections, const Project::Section* sectionInfo)
+    void addSection(std::unordered_set<std::string>& usedSections,
+        const std::unordered_set<std::string>& strippedSections, const Project::Section* sectionInfo)
     {
         if (sectionInfo->condition.has_value()) {
             Expr* expr = parseExpression(sectionInfo->conditionLocation, *sectionInfo->condition);
@@ -622,9 +860,22 @@ private:
             throw CompilerError(sectionInfo->location, ss.str());
         }
 
+        if (strippedSections.find(sectionInfo->name) != strippedSections.end()) {
+            DebugInformation::RemovedSection removed;
+            removed.name = sectionInfo->name;
+            size_t size = 0;
+            std::unique_ptr<CompilerError> error;
+            if (section->calculateSizeInBytes(size, mSectionResolver, error))
+                removed.size = int64_t(size);
+            mDebugInfo->addRemovedSection(std::move(removed));
+            return;
+        }
+
         if (!usedSections.emplace(sectionInfo->name).second)
             section = section->clone();
 
+        section->setPreferSpeed(sectionInfo->optimization == Project::Section::OptimizeSpeed);
+
         bool autoOffset = false;
         bool autoOffsetNoPadding = false;
         if (sectionInfo->fileOffset.has_value()) {
@@ -645,11 +896,14 @@ private:
             (autoOffset ? nullptr : tryParseExpression(sectionInfo->fileOffsetLocation, sectionInfo->fileOffset));
         linkerSection->alignment = tryParseExpression(sectionInfo->alignmentLocation, sectionInfo->alignment);
         linkerSection->attachment = sectionInfo->attachment;
+        linkerSection->memory = sectionInfo->memory;
+        linkerSection->memoryLocation = sectionInfo->memoryLocation;
         linkerSection->compression = sectionInfo->compression;
         linkerSection->compressionLocation = sectionInfo->compressionLocation;
         linkerSection->labelsResolved = false;
         linkerSection->autoFileOffset = autoOffset;
         linkerSection->autoFileOffsetNoPadding = autoOffsetNoPadding;
+        linkerSection->inPlace = sectionInfo->inPlace;
         mSections.emplace_back(linkerSection);
 
         mSectionsByName[sectionInfo->name] = linkerSection;
@@ -659,6 +913,109 @@ private:
             ss << "section \"" << sectionInfo->name << "\" has file offset without base address.";
             throw CompilerError(sectionInfo->nameLocation, ss.str());
         }
+
+        if (linkerSection->inPlace) {
+            if (linkerSection->compression == Compression::None) {
+                std::stringstream ss;
+                ss << "section \"" << sectionInfo->name << "\" is not compressed and can't be decompressed in place.";
+                throw CompilerError(sectionInfo->location, ss.str());
+            }
+            if (!linkerSection->base) {
+                std::stringstream ss;
+                ss << "section \"" << sectionInfo->name << "\" should have base address to be decompressed in place.";
+                throw CompilerError(sectionInfo->location, ss.str());
+            }
+            if (sectionInfo->fileOffset.has_value()) {
+                std::stringstream ss;
+                ss << "section \"" << sectionInfo->name
+                   << "\" can't have file offset because it is decompressed in place.";
+                throw CompilerError(sectionInfo->fileOffsetLocation, ss.str());
+            }
+        }
+    }
+
+    size_t placementAddress(LinkerSection* section, size_t address) const
+    {
+        if (section->alignment) {
+            size_t alignment = section->alignment->evaluateUnsignedWord(nullptr, mSectionResolver);
+            if (alignment == 0) {
+                std::stringstream ss;
+                ss << "section \"" << section->programSection->name()
+                   << "\" has invalid alignment in file \"" << mFile->name << "\".";
+                throw CompilerError(section->alignment->location(), ss.str());
+            }
+            address += alignment - 1;
+            address /= alignment;
+            address *= alignment;
+        }
+
+        if (section->memory == Project::Section::UncontendedMemory && !section->resolvedBase && !mBank) {
+            size_t size = std::max<size_t>(section->resolvedSize.value_or(0), 1);
+            if (contendedBytes(std::nullopt, address, size) > 0)
+                address = 0x8000;
+        }
+
+        return address;
+    }
+
+    bool isMovableIntoGap(LinkerSection* section) const
+    {
+        return !section->base && !section->fileOffset && !section->alignment && !section->inPlace
+            && section->compression == Compression::None && section->attachment != Project::Section::Upper
+            && section->memory == Project::Section::AnyMemory && section->resolvedSize.value_or(0) > 0;
+    }
+
+    void fillGaps()
+    {
+        std::optional<size_t> start;
+        if (mFileStart)
+            start = mFileStart->evaluateUnsignedWord(nullptr, mSectionResolver);
+        else if (!mSections.empty())
+            start = mSections[0]->resolvedFileOffset;
+        if (!start)
+            return;
+
+        // Simulate sequential layout and pull best-fitting sections from further down the list into
+        // the holes left by alignment or fixed addresses. Layout is left untouched if it can't be predicted.
+
+        std::vector<LinkerSection*> pending = mSections;
+        std::vector<LinkerSection*> order;
+        order.reserve(pending.size());
+
+        size_t address = *start;
+        int64_t recovered = 0;
+        for (size_t i = 0; i < pending.size(); i++) {
+            auto section = pending[i];
+            if (!section->resolvedSize || section->inPlace || section->attachment == Project::Section::Upper)
+                return;
+
+            size_t target = section->resolvedFileOffset.value_or(placementAddress(section, address));
+            if (target < address)
+                return;
+
+            while (target > address) {
+                size_t best = 0;
+                for (size_t j = i + 1; j < pending.size(); j++) {
+                    auto candidate = pending[j];
+                    if (isMovableIntoGap(candidate) && *candidate->resolvedSize <= target - address
+                            && (best == 0 || *candidate->resolvedSize > *pending[best]->resolvedSize))
+                        best = j;
+                }
+                if (best == 0)
+                    break;
+
+                address += *pending[best]->resolvedSize;
+                recovered += int64_t(*pending[best]->resolvedSize);
+                order.emplace_back(pending[best]);
+                pending.erase(pending.begin() + ptrdiff_t(best));
+            }
+
+            order.emplace_back(section);
+            address = target + *section->resolvedSize;
+        }
+
+        mSections = std::move(order);
+        mDebugInfo->setRecoveredGapBytes(recovered);
     }
 
     bool resolveSectionsFrom(size_t address, size_t i)
@@ -668,24 +1025,13 @@ private:
         size_t n = mSections.size();
         for (; i < n; i++) {
             auto section = mSections[i];
-            if (section->attachment == Project::Section::Attachment::Upper || section->resolvedFileOffset)
+            if (section->attachment == Project::Section::Attachment::Upper
+                    || section->resolvedFileOffset || section->inPlace)
                 break;
 
             resolvedSomething = true;
 
-            if (section->alignment) {
-                size_t alignment = section->alignment->evaluateUnsignedWord(nullptr, mSectionResolver);
-                if (alignment == 0) {
-                    std::stringstream ss;
-                    ss << "section \"" << section->programSection->name()
-                       << "\" has invalid alignment in file \"" << mFile->name << "\".";
-                    throw CompilerError(section->alignment->location(), ss.str());
-                }
-                address += alignment - 1;
-                address /= alignment;
-                address *= alignment;
-            }
-
+            address = placementAddress(section, address);
             section->resolvedFileOffset = address;
           #if defined(_WIN32) && defined(DEBUG_LINKER) && !defined(NDEBUG)
             { std::stringstream ss;
@@ -722,7 +1068,8 @@ private:
 
         while (i-- > 0) {
             auto section = mSections[i];
-            if (section->attachment == Project::Section::Attachment::Lower || section->resolvedFileOffset)
+            if (section->attachment == Project::Section::Attachment::Lower
+                    || section->resolvedFileOffset || section->inPlace)
                 break;
             if (!section->resolvedSize)
                 break;
@@ -768,6 +1115,67 @@ private:
         return resolvedSomething;
     }
 
+    void placeForInPlaceDecompression(LinkerSection* section)
+    {
+        size_t compressedSize = section->compressedCode->compressedSize();
+        size_t end = section->resolvedBase.value()
+            + section->compressedCode->uncompressedSize() + section->compressedCode->safeDistance();
+        if (end > 0x10000 || end < compressedSize) {
+            std::stringstream ss;
+            ss << "not enough memory to decompress section \"" << section->programSection->name()
+               << "\" in place in file \"" << mFile->name << "\".";
+            throw CompilerError(section->location, ss.str());
+        }
+
+        section->resolvedFileOffset = end - compressedSize;
+        section->compressedCode->setSectionBase(int64_t(*section->resolvedFileOffset));
+      #if defined(_WIN32) && defined(DEBUG_LINKER) && !defined(NDEBUG)
+        { std::stringstream ss;
+        ss << "resolved file offset 0x" << std::hex << *section->resolvedFileOffset
+           << " for in-place \"" << section->programSection->name() << "\" in file \"" << file()->name << "\".\n";
+        OutputDebugStringA(ss.str().c_str()); }
+      #endif
+    }
+
+    void checkContention(CompiledFile* output, LinkerSection* section) const
+    {
+        size_t base = section->resolvedBase.value();
+        size_t size = (section->compressedCode ?
+            section->compressedCode->uncompressedSize() : section->resolvedSize.value());
+        size_t contended = contendedBytes(mBank, base, size);
+        bool uncontendedRequired = (section->memory == Project::Section::UncontendedMemory);
+
+        output->debugInfo()->addMemoryRegion(DebugInformation::MemoryRegion{ section->programSection->name(),
+            int64_t(base), int64_t(size), int64_t(contended), uncontendedRequired });
+
+        if (uncontendedRequired && contended > 0) {
+            std::stringstream ss;
+            ss << "section \"" << section->programSection->name() << "\" in file \"" << mFile->name
+               << "\" is placed in contended memory (" << contended << " of " << size << " bytes are contended).";
+            output->addWarning(section->memoryLocation, ss.str());
+        }
+    }
+
+    void checkDecompressionOverlap(LinkerSection* section) const
+    {
+        // Forward decompressors may overwrite compressed data that was not read yet, unless compressed
+        // data ends at least "safe distance" bytes after the end of decompressed data.
+
+        size_t dataStart = section->resolvedFileOffset.value();
+        size_t dataEnd = dataStart + section->compressedCode->compressedSize();
+        size_t targetStart = section->resolvedBase.value();
+        size_t targetEnd = targetStart + section->compressedCode->uncompressedSize();
+        size_t safeEnd = targetEnd + section->compressedCode->safeDistance();
+
+        if (dataStart < targetEnd && targetStart < dataEnd && dataEnd < safeEnd) {
+            std::stringstream ss;
+            ss << "compressed data of section \"" << section->programSection->name() << "\" in file \""
+               << mFile->name << "\" overlaps its decompression target (compressed data should end at 0x"
+               << std::hex << std::uppercase << safeEnd << " or later).";
+            throw CompilerError(section->location, ss.str());
+        }
+    }
+
     Expr* parseExpression(SourceLocation* location, const std::string& str)
     {
         ExpressionParser parser(heap(), nullptr, nullptr, nullptr);
@@ -805,9 +1213,10 @@ static void checkAmbiguous(SourceLocation* location, const std::string& name, bo
 
 ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
-Linker::Linker(GCHeap* heap, const Project* project)
+Linker::Linker(GCHeap* heap, const Project* project, ILinkerListener* listener)
     : mHeap(heap)
     , mProject(project)
+    , mListener(listener)
     , mProgram(nullptr)
 {
 }
@@ -816,14 +1225,33 @@ Linker::~Linker()
 {
 }
 
+void Linker::addFileUsedByBasic(std::string name)
+{
+    mFilesUsedByBasic.emplace(std::move(name));
+}
+
 CompiledOutput* Linker::link(Program* program)
 {
     mProgram = program;
+    addDecompressors();
+    addTurboLoader();
+    addRelocator();
+    runPeepholeOptimizer();
+    stripUnusedSections();
+    allocateBanks();
 
     auto output = new (mHeap) CompiledOutput();
 
-    mFiles.reserve(mFiles.size() + mProject->files.size());
+    std::vector<const Project::File*> files;
     for (const auto& file : mProject->files) {
+        if (file->banks.empty())
+            files.emplace_back(file.get());
+    }
+    for (const auto& file : mBankFiles)
+        files.emplace_back(file.get());
+
+    mFiles.reserve(mFiles.size() + files.size());
+    for (const auto* file : files) {
       #if defined(_WIN32) && defined(DEBUG_LINKER) && !defined(NDEBUG)
         { std::stringstream ss;
         ss << ">>> initializing file \"" << file->name << "\".\n";
@@ -834,14 +1262,21 @@ CompiledOutput* Linker::link(Program* program)
             ss << "duplicate file name \"" << file->name << "\".";
             throw CompilerError(file->nameLocation, ss.str());
         }
-        mFiles.emplace_back(new (mHeap) LinkerFile(mUsedSections, this, file.get(), mProgram));
+        mFiles.emplace_back(new (mHeap) LinkerFile(mUsedSections, mStrippedSections, this, mListener, file, mProgram));
     }
 
-    for (;;) {
+    for (int pass = 1; ; pass++) {
         bool resolvedAll = true;
         bool didResolve = false;
         std::unique_ptr<CompilerError> resolveError;
 
+        if (mListener) {
+            std::stringstream ss;
+            ss << "Linking (pass " << pass << ")...";
+            mListener->checkCancelation();
+            mListener->linkerProgress(0, 0, ss.str());
+        }
+
         for (const auto& file : mFiles) {
           #if defined(_WIN32) && defined(DEBUG_LINKER) && !defined(NDEBUG)
             { std::stringstream ss;
@@ -875,14 +1310,38 @@ CompiledOutput* Linker::link(Program* program)
         }
     }
 
+    int64_t fileIndex = 0;
     for (auto& file : mFiles) {
       #if defined(_WIN32) && defined(DEBUG_LINKER) && !defined(NDEBUG)
         { std::stringstream ss;
         ss << ">>> generating code for file \"" << file->file()->name << "\".\n";
         OutputDebugStringA(ss.str().c_str()); }
       #endif
-        file->generateCode(output->addFile(file->file()->location, file->file()->nameLocation,
-            file->file()->name, file->takeDebugInfo()));
+        if (mListener) {
+            std::stringstream ss;
+            ss << "Generating code for \"" << file->file()->name << "\"...";
+            mListener->checkCancelation();
+            mListener->linkerProgress(fileIndex++, int64_t(mFiles.size()), ss.str());
+        }
+        auto compiledFile = output->addFile(file->file()->location, file->file()->nameLocation,
+            file->file()->name, file->takeDebugInfo());
+        if (file->file()->listing)
+            compiledFile->enableListing();
+        file->generateCode(compiledFile);
+        compiledFile->setFingerprint(fingerprint(compiledFile));
+
+        if (file->file()->relocatable) {
+            std::vector<uint8_t> table;
+            writeRelocationTable(compiledFile->relocations(), table);
+            auto tableFile = output->addFile(file->file()->relocatableLocation, file->file()->nameLocation,
+                file->file()->name + ".reloc", std::make_unique<DebugInformation>());
+            tableFile->emitBytes(file->file()->relocatableLocation, table.data(), table.size());
+            tableFile->setFingerprint(fingerprint(tableFile));
+        }
+
+        auto it = mBankFileOrigins.find(file->file());
+        if (it != mBankFileOrigins.end())
+            output->addFileToGroup(it->second->name, compiledFile);
     }
 
     struct TestOnlySectionResolver : public ISectionResolver
@@ -896,6 +1355,12 @@ CompiledOutput* Linker::link(Program* program)
             { return isValidSectionName(location, n); }
         bool tryResolveSectionSize(SourceLocation* location, const std::string& n, uint64_t&) const override
             { return isValidSectionName(location, n); }
+        bool tryResolveSectionBank(SourceLocation* location, const std::string& n, uint64_t&) const override
+            { return isValidSectionName(location, n); }
+        bool tryResolveSectionCompression(SourceLocation* location, const std::string& n, uint64_t&) const override
+            { return isValidSectionName(location, n); }
+        void checkCancelation() const override
+            {}
 
         bool isValidSectionName(SourceLocation* location, const std::string& name) const override
         {
@@ -913,33 +1378,46 @@ CompiledOutput* Linker::link(Program* program)
         }
     };
 
+    // Labels in sections that are not included in the build or were stripped never get an address
+    std::optional<std::unordered_set<const Label*>> builtLabels;
+    auto checkLabelAddress = [this, &builtLabels](const Symbol* symbol, const Label* label) {
+            if (label->hasAddress())
+                return;
+
+            if (!builtLabels) {
+                SymbolReferences refs;
+                for (const auto& name : mUsedSections)
+                    mProgram->getOrAddSection(name)->collectReferences(refs);
+                builtLabels = std::move(refs.definedLabels);
+            }
+
+            if (builtLabels->find(label) != builtLabels->end()) {
+                std::stringstream ss;
+                ss << "unable to resolve address for label \"" << symbol->name() << "\".";
+                throw CompilerError(symbol->location(), ss.str());
+            }
+        };
+
     for (const auto& it : mProgram->globals()->symbols()) {
         Symbol* symbol = it.second;
         switch (symbol->type()) {
-            /* FIXME these checks cause errors for code not included in the build
             case Symbol::Label:
-                if (!static_cast<LabelSymbol*>(symbol)->label()->hasAddress()) {
-                    std::stringstream ss;
-                    ss << "unable to resolve address for label \"" << symbol->name() << "\".";
-                    throw CompilerError(symbol->location(), ss.str());
-                }
+                checkLabelAddress(symbol, static_cast<LabelSymbol*>(symbol)->label());
                 break;
 
             case Symbol::ConditionalLabel: {
                 int64_t addr = 0;
-                TestOnlySectionResolver testOnlyResolver(files);
+                TestOnlySectionResolver testOnlyResolver(mFiles);
                 Label* label = static_cast<ConditionalLabelSymbol*>(symbol)->
                     label(symbol->location(), &addr, &testOnlyResolver);
-                if (label && !label->hasAddress()) {
-                    std::stringstream ss;
-                    ss << "unable to resolve address for label \"" << symbol->name() << "\".";
-                    throw CompilerError(symbol->location(), ss.str());
-                }
+                if (label)
+                    checkLabelAddress(symbol, label);
                 break;
             }
-            */
 
             case Symbol::Constant: {
+                if (referencesStrippedCode(symbol))
+                    break;
                 int64_t addr = 0;
                 TestOnlySectionResolver testOnlyResolver(mFiles);
                 static_cast<ConstantSymbol*>(symbol)->value()->evaluateValue(&addr, &testOnlyResolver);
@@ -947,6 +1425,8 @@ CompiledOutput* Linker::link(Program* program)
             }
 
             case Symbol::ConditionalConstant: {
+                if (referencesStrippedCode(symbol))
+                    break;
                 int64_t addr = 0;
                 TestOnlySectionResolver testOnlyResolver(mFiles);
                 auto conditionalSymbol = static_cast<ConditionalConstantSymbol*>(symbol);
@@ -962,6 +1442,551 @@ CompiledOutput* Linker::link(Program* program)
     return output;
 }
 
+void Linker::addDecompressors()
+{
+    const Project::Section* target = nullptr;
+    std::vector<const Project::Section*> compressedSections;
+
+    for (const auto& file : mProject->files) {
+        for (const auto& section : file->sections) {
+            if (section->compression != Compression::None)
+                compressedSections.emplace_back(section.get());
+
+            if (section->decompressors != DecompressorVariant::None) {
+                if (target) {
+                    std::stringstream ss;
+                    ss << "decompressors are already emitted into section \"" << target->name << "\".";
+                    throw CompilerError(section->decompressorsLocation, ss.str());
+                }
+                if (section->compression != Compression::None) {
+                    std::stringstream ss;
+                    ss << "section \"" << section->name << "\" with decompressors can't be compressed.";
+                    throw CompilerError(section->decompressorsLocation, ss.str());
+                }
+                target = section.get();
+            }
+        }
+    }
+
+    if (!target)
+        return;
+
+    // Sections with "best" compression get the decompressor of the codec selected while linking. Each compressed
+    // section also gets a "decompress_<section>" label at the entry point of its decompressor.
+
+    for (auto codec : { Compression::Zx0, Compression::Zx7, Compression::Lzsa2 }) {
+        std::stringstream condition;
+        std::stringstream labels;
+        bool alwaysUsed = false;
+        bool used = false;
+
+        for (auto section : compressedSections) {
+            std::vector<Compression> codecs;
+            decompressorCodecs(section->compression, codecs);
+            if (std::find(codecs.begin(), codecs.end(), codec) == codecs.end())
+                continue;
+
+            std::stringstream check;
+            check << "compressionof(" << section->name << ") == " << int(codec);
+
+            if (codecs.size() == 1) {
+                alwaysUsed = true;
+                labels << "decompress_" << section->name << ":\n";
+            } else
+                labels << "#if " << check.str() << "\ndecompress_" << section->name << ":\n#endif\n";
+
+            condition << (used ? " || " : "") << check.str();
+            used = true;
+        }
+
+        if (!used)
+            continue;
+
+        std::stringstream ss;
+        ss << "#section " << target->name << '\n';
+        if (!alwaysUsed)
+            ss << "#if " << condition.str() << '\n';
+        ss << labels.str();
+        ss << decompressorSource(codec, target->decompressors);
+        if (!alwaysUsed)
+            ss << "#endif\n";
+        std::string source = ss.str();
+
+        std::string fileName = std::string(decompressorSymbol(codec)) + ".asm";
+        auto fileID = new (mHeap) FileID(fileName, mProject->path(), true);
+        Lexer lexer(mHeap, Lexer::Mode::Assembler);
+        lexer.scan(fileID, source.c_str(), 0);
+        AssemblerParser parser(mHeap, mProgram);
+        parser.parse(lexer.firstToken());
+    }
+}
+
+void Linker::addTurboLoader()
+{
+    const Project::Section* target = nullptr;
+    for (const auto& file : mProject->files) {
+        for (const auto& section : file->sections) {
+            if (!section->turboLoader)
+                continue;
+            if (target) {
+                std::stringstream ss;
+                ss << "turbo loader is already emitted into section \"" << target->name << "\".";
+                throw CompilerError(section->turboLoaderLocation, ss.str());
+            }
+            if (section->compression != Compression::None) {
+                std::stringstream ss;
+                ss << "section \"" << section->name << "\" with turbo loader can't be compressed.";
+                throw CompilerError(section->turboLoaderLocation, ss.str());
+            }
+            target = section.get();
+        }
+    }
+
+    if (!target)
+        return;
+
+    // Loader is shared, so all TZX outputs should use the same pulse lengths
+    const Project::Output* tzx = nullptr;
+    for (const auto& output : mProject->outputs) {
+        if (output->type != Project::Output::ZXSpectrumTZX)
+            continue;
+        if (tzx && *tzx->turbo != *output->turbo)
+            throw CompilerError(output->location, "all TZX outputs should use the same turbo timings.");
+        tzx = output.get();
+    }
+
+    if (!tzx)
+        throw CompilerError(target->turboLoaderLocation, "turbo loader requires TZX output.");
+
+    std::stringstream ss;
+    ss << "#section " << target->name << '\n';
+    ss << turboLoaderSource(tzx->location, *tzx->turbo);
+    std::string source = ss.str();
+
+    std::string fileName = std::string(turboLoaderSymbol()) + ".asm";
+    auto fileID = new (mHeap) FileID(fileName, mProject->path(), true);
+    Lexer lexer(mHeap, Lexer::Mode::Assembler);
+    lexer.scan(fileID, source.c_str(), 0);
+    AssemblerParser parser(mHeap, mProgram);
+    parser.parse(lexer.firstToken());
+}
+
+void Linker::addRelocator()
+{
+    const Project::Section* target = nullptr;
+    for (const auto& file : mProject->files) {
+        for (const auto& section : file->sections) {
+            if (!section->relocator)
+                continue;
+            if (target) {
+                std::stringstream ss;
+                ss << "relocator is already emitted into section \"" << target->name << "\".";
+                throw CompilerError(section->relocatorLocation, ss.str());
+            }
+            if (section->compression != Compression::None) {
+                std::stringstream ss;
+                ss << "section \"" << section->name << "\" with relocator can't be compressed.";
+                throw CompilerError(section->relocatorLocation, ss.str());
+            }
+            target = section.get();
+        }
+    }
+
+    if (!target)
+        return;
+
+    std::stringstream ss;
+    ss << "#section " << target->name << '\n';
+    ss << relocatorSource();
+    std::string source = ss.str();
+
+    std::string fileName = std::string(relocatorSymbol()) + ".asm";
+    auto fileID = new (mHeap) FileID(fileName, mProject->path(), true);
+    Lexer lexer(mHeap, Lexer::Mode::Assembler);
+    lexer.scan(fileID, source.c_str(), 0);
+    AssemblerParser parser(mHeap, mProgram);
+    parser.parse(lexer.firstToken());
+}
+
+void Linker::runPeepholeOptimizer()
+{
+    // Optimized code is shared by all files that reference the section
+    for (const auto& file : mProject->files) {
+        for (const auto& section : file->sections) {
+            if (section->peephole)
+                mProgram->getOrAddSection(section->name)->runPeepholeOptimizer();
+        }
+    }
+}
+
+void Linker::stripUnusedSections()
+{
+    bool enabled = false;
+    for (const auto& file : mProject->files) {
+        if (file->stripUnused)
+            enabled = true;
+    }
+    if (!enabled)
+        return;
+
+    std::unordered_map<std::string, SymbolReferences> sectionReferences;
+    std::unordered_map<const Label*, std::string> labelSections;
+    for (const auto& file : mProject->files) {
+        for (const auto& section : file->sections) {
+            auto result = sectionReferences.emplace(section->name, SymbolReferences());
+            if (!result.second)
+                continue;
+
+            SymbolReferences& refs = result.first->second;
+            mProgram->getOrAddSection(section->name)->collectReferences(refs);
+            for (auto label : refs.definedLabels)
+                labelSections.emplace(label, section->name);
+        }
+    }
+
+    std::unordered_set<std::string> reachable;
+    std::vector<std::string> pending;
+
+    auto markReachable = [&reachable, &pending](const std::string& name) {
+            if (reachable.emplace(name).second)
+                pending.emplace_back(name);
+        };
+
+    auto markReferences = [&labelSections, &markReachable](const SymbolReferences& refs) {
+            for (auto label : refs.labels) {
+                auto it = labelSections.find(label);
+                if (it != labelSections.end())
+                    markReachable(it->second);
+            }
+            for (const auto& name : refs.sections)
+                markReachable(name);
+        };
+
+    // Roots: everything in files that are not stripped or are embedded into BASIC programs,
+    // entry points (first section of a file), sections marked with keep="true" and tables generated by the linker
+
+    for (const auto& file : mProject->files) {
+        bool usedByBasic = (mFilesUsedByBasic.find(file->name) != mFilesUsedByBasic.end());
+        for (const auto& section : file->sections) {
+            bool isEntryPoint = (file->banks.empty() && section == file->sections.front());
+            if (!file->stripUnused || usedByBasic || isEntryPoint || section->keep)
+                markReachable(section->name);
+        }
+        if (file->bankTable)
+            markReachable(*file->bankTable);
+    }
+
+    for (const auto& output : mProject->outputs) {
+        if (!output->z80)
+            continue;
+
+        const Project::Output::Z80* z80 = output->z80.get();
+        for (const auto* value : { &z80->pc, &z80->sp, &z80->bc, &z80->de, &z80->hl,
+                &z80->shadowBC, &z80->shadowDE, &z80->shadowHL, &z80->ix, &z80->iy }) {
+            if (value->value) {
+                SymbolReferences refs;
+                value->parseExpression(mProgram)->collectReferences(refs);
+                markReferences(refs);
+            }
+        }
+    }
+
+    while (!pending.empty()) {
+        std::string name = std::move(pending.back());
+        pending.pop_back();
+
+        auto it = sectionReferences.find(name);
+        if (it != sectionReferences.end())
+            markReferences(it->second);
+    }
+
+    for (const auto& file : mProject->files) {
+        if (!file->stripUnused)
+            continue;
+
+        for (const auto& section : file->sections) {
+            if (reachable.find(section->name) == reachable.end()) {
+                mStrippedSections.emplace(section->name);
+                for (auto label : sectionReferences[section->name].definedLabels)
+                    mStrippedLabels.emplace(label);
+            }
+        }
+    }
+}
+
+bool Linker::referencesStrippedCode(const Symbol* symbol) const
+{
+    if (mStrippedSections.empty())
+        return false;
+
+    SymbolReferences refs;
+    symbol->collectReferences(refs);
+
+    for (auto label : refs.labels) {
+        if (mStrippedLabels.find(label) != mStrippedLabels.end())
+            return true;
+    }
+    for (const auto& name : refs.sections) {
+        if (mStrippedSections.find(name) != mStrippedSections.end())
+            return true;
+    }
+
+    return false;
+}
+
+void Linker::allocateBanks()
+{
+    const size_t BankSize = 0x4000;
+    std::unordered_set<int> allocatedBanks;
+
+    for (const auto& file : mProject->files) {
+        if (file->banks.empty())
+            continue;
+
+        if (file->relocatable)
+            throw CompilerError(file->relocatableLocation, "relocatable file can't be distributed among banks.");
+
+        for (int bank : file->banks) {
+            if (!allocatedBanks.emplace(bank).second) {
+                std::stringstream ss;
+                ss << "bank " << bank << " is allocated automatically for multiple files.";
+                throw CompilerError(file->banksLocation, ss.str());
+            }
+        }
+
+        for (const auto& other : mProject->files) {
+            auto bank = bankForFileName(other->name);
+            if (bank && std::find(file->banks.begin(), file->banks.end(), *bank) != file->banks.end()) {
+                std::stringstream ss;
+                ss << "bank " << *bank << " is already used by file \"" << other->name << "\".";
+                throw CompilerError(file->banksLocation, ss.str());
+            }
+        }
+
+        std::vector<const Project::Section*> sections;
+        std::vector<const Project::Section*> strippedSections;
+        for (const auto& section : file->sections) {
+            if (section->base || section->fileOffset || section->alignment
+                    || section->compression != Compression::None) {
+                std::stringstream ss;
+                ss << "section \"" << section->name << "\" in file \"" << file->name
+                   << "\" is allocated to a bank automatically and can't have base, file offset, alignment "
+                      "or compression.";
+                throw CompilerError(section->location, ss.str());
+            }
+
+            if (section->condition) {
+                ExpressionParser parser(mHeap, nullptr, nullptr, nullptr);
+                Expr* expr = parser.tryParseExpression(section->conditionLocation,
+                    section->condition->c_str(), mProgram->projectVariables());
+                if (!expr) {
+                    std::stringstream ss;
+                    ss << "unable to parse expression \"" << *section->condition << "\": " << parser.error();
+                    throw CompilerError(parser.errorLocation(), ss.str());
+                }
+                if (expr->evaluateValue(nullptr, nullptr).number == 0)
+                    continue;
+            }
+
+            if (mStrippedSections.find(section->name) != mStrippedSections.end()) {
+                strippedSections.emplace_back(section.get());
+                continue;
+            }
+
+            sections.emplace_back(section.get());
+        }
+
+        if (file->bankTable) {
+            std::stringstream ss;
+            ss << "#section " << *file->bankTable << "\nbank_table:\n";
+            for (auto section : sections)
+                ss << "db bankof(" << section->name << ")\n";
+            std::string source = ss.str();
+
+            auto fileID = new (mHeap) FileID("bank_table.asm", mProject->path(), true);
+            Lexer lexer(mHeap, Lexer::Mode::Assembler);
+            lexer.scan(fileID, source.c_str(), 0);
+            AssemblerParser parser(mHeap, mProgram);
+            parser.parse(lexer.firstToken());
+        }
+
+        // Sections that call each other or share the same affinity are kept together so that code in them
+        // can call each other without switching banks
+
+        std::vector<SymbolReferences> references(sections.size());
+        std::unordered_map<const Label*, size_t> labelSections;
+        for (size_t i = 0; i < sections.size(); i++) {
+            mProgram->getOrAddSection(sections[i]->name)->collectReferences(references[i]);
+            for (auto label : references[i].definedLabels)
+                labelSections.emplace(label, i);
+        }
+
+        std::vector<size_t> parents(sections.size());
+        for (size_t i = 0; i < sections.size(); i++)
+            parents[i] = i;
+
+        auto findRoot = [&parents](size_t index) {
+                while (parents[index] != index)
+                    index = parents[index] = parents[parents[index]];
+                return index;
+            };
+
+        auto join = [&parents, &findRoot](size_t a, size_t b) {
+                a = findRoot(a);
+                b = findRoot(b);
+                if (a != b)
+                    parents[std::max(a, b)] = std::min(a, b);
+            };
+
+        std::unordered_map<std::string, size_t> affinities;
+        for (size_t i = 0; i < sections.size(); i++) {
+            if (sections[i]->affinity)
+                join(affinities.emplace(*sections[i]->affinity, i).first->second, i);
+            for (auto label : references[i].labels) {
+                auto it = labelSections.find(label);
+                if (it != labelSections.end())
+                    join(it->second, i);
+            }
+        }
+
+        struct Group
+        {
+            std::vector<const Project::Section*> sections;
+            size_t size = 0;
+            bool uncontended = false;
+        };
+
+        std::vector<Group> groups;
+        std::unordered_map<size_t, size_t> rootGroups;
+        std::unordered_map<const Project::Section*, size_t> sizes;
+        for (size_t i = 0; i < sections.size(); i++) {
+            auto section = sections[i];
+
+            size_t size = 0;
+            std::unique_ptr<CompilerError> resolveError;
+            if (!mProgram->getOrAddSection(section->name)->calculateSizeInBytes(size, this, resolveError)) {
+                std::stringstream ss;
+                ss << "unable to calculate size of section \"" << section->name << "\" for bank allocation.";
+                throw CompilerError(section->location, ss.str());
+            }
+            if (size > BankSize) {
+                std::stringstream ss;
+                ss << "section \"" << section->name << "\" does not fit into a bank.";
+                throw CompilerError(section->location, ss.str());
+            }
+            sizes[section] = size;
+
+            size_t index = rootGroups.emplace(findRoot(i), groups.size()).first->second;
+            if (index == groups.size())
+                groups.emplace_back();
+
+            groups[index].sections.emplace_back(section);
+            groups[index].size += size;
+            if (section->memory == Project::Section::UncontendedMemory)
+                groups[index].uncontended = true;
+        }
+
+        // Odd banks are always contended, so groups that require uncontended memory are placed first
+        std::stable_sort(groups.begin(), groups.end(), [](const Group& a, const Group& b) {
+                if (a.uncontended != b.uncontended)
+                    return a.uncontended;
+                return a.size > b.size;
+            });
+
+        size_t used[8] = {};
+        std::vector<const Project::Section*> bankSections[8];
+        for (auto& group : groups) {
+            bool placed = false;
+            for (int bank : file->banks) {
+                if (group.uncontended && contendedBytes(bank, 0xc000, 1) != 0)
+                    continue;
+                if (used[bank] + group.size <= BankSize) {
+                    auto& list = bankSections[bank];
+                    list.insert(list.end(), group.sections.begin(), group.sections.end());
+                    used[bank] += group.size;
+                    placed = true;
+                    break;
+                }
+            }
+            if (placed)
+                continue;
+
+            // Group does not fit into a single bank, split it
+            std::stable_sort(group.sections.begin(), group.sections.end(),
+                [&sizes](const Project::Section* a, const Project::Section* b) {
+                    bool uncontendedA = (a->memory == Project::Section::UncontendedMemory);
+                    bool uncontendedB = (b->memory == Project::Section::UncontendedMemory);
+                    if (uncontendedA != uncontendedB)
+                        return uncontendedA;
+                    return sizes[a] > sizes[b];
+                });
+
+            for (auto section : group.sections) {
+                bool uncontended = (section->memory == Project::Section::UncontendedMemory);
+                placed = false;
+                for (int bank : file->banks) {
+                    if (uncontended && contendedBytes(bank, 0xc000, 1) != 0)
+                        continue;
+                    if (used[bank] + sizes[section] <= BankSize) {
+                        bankSections[bank].emplace_back(section);
+                        used[bank] += sizes[section];
+                        placed = true;
+                        break;
+                    }
+                }
+                if (!placed) {
+                    std::stringstream ss;
+                    if (uncontended)
+                        ss << "not enough uncontended memory in banks to place section \"" << section->name << "\".";
+                    else
+                        ss << "not enough memory in banks to place section \"" << section->name << "\".";
+                    throw CompilerError(section->location, ss.str());
+                }
+            }
+        }
+
+        for (int bank = 0; bank < 8; bank++) {
+            if (bankSections[bank].empty())
+                continue;
+
+            std::stable_sort(bankSections[bank].begin(), bankSections[bank].end(),
+                [&sections](const Project::Section* a, const Project::Section* b) {
+                    return std::find(sections.begin(), sections.end(), a)
+                         < std::find(sections.begin(), sections.end(), b);
+                });
+
+            auto bankFile = std::make_unique<Project::File>();
+            bankFile->location = file->location;
+            bankFile->name = "BANK" + std::to_string(bank);
+            bankFile->nameLocation = file->nameLocation;
+            bankFile->start = "0xc000";
+            bankFile->startLocation = file->banksLocation;
+            bankFile->untilLocation = nullptr;
+            bankFile->fillGaps = file->fillGaps;
+            bankFile->stripUnused = file->stripUnused;
+            bankFile->listing = file->listing;
+            bankFile->banksLocation = nullptr;
+            bankFile->bankTableLocation = nullptr;
+
+            // Stripped sections are listed in the first bank so that they show up in its memory map
+            for (auto section : bankSections[bank]) {
+                auto copy = std::make_unique<Project::Section>(*section);
+                copy->file = bankFile.get();
+                bankFile->sections.emplace_back(std::move(copy));
+            }
+            for (auto section : strippedSections) {
+                auto copy = std::make_unique<Project::Section>(*section);
+                copy->file = bankFile.get();
+                bankFile->sections.emplace_back(std::move(copy));
+            }
+            strippedSections.clear();
+
+            mBankFileOrigins[bankFile.get()] = file.get();
+            mBankFiles.emplace_back(std::move(bankFile));
+        }
+    }
+}
+
 bool Linker::isValidSectionName(SourceLocation* location, const std::string& name) const
 {
     bool ambiguous = false;
@@ -1021,3 +2046,44 @@ bool Linker::tryResolveSectionSize(SourceLocation* location, const std::string&
 
     return result;
 }
+
+bool Linker::tryResolveSectionBank(SourceLocation* location, const std::string& name, uint64_t& value) const
+{
+    bool ambiguous = false;
+    bool result = false;
+
+    for (const auto& file : mFiles) {
+        if (file->tryResolveSectionBank(name, value)) {
+            checkAmbiguous(location, name, ambiguous);
+            result = true;
+        }
+    }
+
+    return result;
+}
+
+bool Linker::tryResolveSectionCompression(SourceLocation* location, const std::string& name, uint64_t& value) const
+{
+    if (mStrippedSections.find(name) != mStrippedSections.end()) {
+        value = uint64_t(Compression::None);
+        return true;
+    }
+
+    bool ambiguous = false;
+    bool result = false;
+
+    for (const auto& file : mFiles) {
+        if (file->tryResolveSectionCompression(name, value)) {
+            checkAmbiguous(location, name, ambiguous);
+            result = true;
+        }
+    }
+
+    return result;
+}
+
+void Linker::checkCancelation() const
+{
+    if (mListener)
+        mListener->checkCancelation();
+}
@@ -3,34 +3,65 @@
 
 #include "Common/Common.h"
 #include "Compiler/Linker/ISectionResolver.h"
+#include "Compiler/Project.h"
 
 class GCHeap;
-class Project;
 class Program;
 class CompiledOutput;
+class Label;
+class Symbol;
+
+class ILinkerListener
+{
+public:
+    virtual ~ILinkerListener() = default;
+    virtual void checkCancelation() const = 0;
+    virtual void linkerProgress(int64_t current, int64_t total, const std::string& message) = 0;
+};
 
 class Linker : public ISectionResolver
 {
 public:
-    Linker(GCHeap* heap, const Project* project);
+    Linker(GCHeap* heap, const Project* project, ILinkerListener* listener = nullptr);
     ~Linker();
 
+    // Files embedded into BASIC programs are kept whole when unused sections are stripped
+    void addFileUsedByBasic(std::string name);
+
     CompiledOutput* link(Program* program);
 
     bool isValidSectionName(SourceLocation* location, const std::string& name) const override;
     bool tryResolveSectionAddress(SourceLocation* location, const std::string& name, uint64_t& value) const override;
     bool tryResolveSectionBase(SourceLocation* location, const std::string& name, uint64_t& value) const override;
     bool tryResolveSectionSize(SourceLocation* location, const std::string& name, uint64_t& value) const override;
+    bool tryResolveSectionBank(SourceLocation* location, const std::string& name, uint64_t& value) const override;
+    bool tryResolveSectionCompression(SourceLocation* location, const std::string& name, uint64_t& value) const override;
+    void checkCancelation() const override;
 
 private:
     class LinkerFile;
 
+    void addDecompressors();
+    void addTurboLoader();
+    void addRelocator();
+    void runPeepholeOptimizer();
+    void stripUnusedSections();
+    void allocateBanks();
+
+    bool referencesStrippedCode(const Symbol* symbol) const;
+
     GCHeap* mHeap;
     const Project* mProject;
+    ILinkerListener* mListener;
     Program* mProgram;
     std::unordered_set<std::string> mFileNames;
+    std::unordered_set<std::string> mFilesUsedByBasic;
     std::unordered_set<std::string> mUsedSections;
+    std::unordered_set<std::string> mStrippedSections;
+    std::unordered_set<const Label*> mStrippedLabels;
     std::vector<LinkerFile*> mFiles;
+    std::vector<std::unique_ptr<Project::File>> mBankFiles;
+    std::unordered_map<const Project::File*, const Project::File*> mBankFileOrigins;
 
     DISABLE_COPY(Linker);
 };
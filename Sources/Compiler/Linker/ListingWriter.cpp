@@ -0,0 +1,150 @@
+#include "ListingWriter.h"
+#include "Compiler/Linker/CompiledFile.h"
+#include "Compiler/Linker/DebugInformation.h"
+#include "Compiler/Tree/SourceLocation.h"
+#include "Common/IO.h"
+
+static bool isSameLine(const SourceLocation* a, const SourceLocation* b)
+{
+    if (!a || !b)
+        return a == b;
+    return a->file() == b->file() && a->line() == b->line();
+}
+
+ListingWriter::ListingWriter(const CompiledFile* file)
+    : mFile(file)
+    , mOffset(0)
+    , mRowEnd(0)
+    , mInstruction(0)
+    , mAddress(int64_t(file->loadAddress()))
+{
+    // Source text is released after the last line that refers to it
+    const auto* bytes = file->data();
+    for (size_t i = 0; i < file->size(); i++) {
+        if (bytes[i].location)
+            mLastOffsets[bytes[i].location->file()] = i;
+    }
+}
+
+ListingWriter::~ListingWriter()
+{
+}
+
+bool ListingWriter::nextLine(std::string& line)
+{
+    if (mOffset >= mFile->size())
+        return false;
+
+    const auto* bytes = mFile->data();
+    const auto& instructions = mFile->instructions();
+    SourceLocation* location = bytes[mOffset].location;
+
+    const CodeEmitterUncompressed::InstructionInfo* instruction = nullptr;
+    bool isFirstLineOfRow = (mOffset >= mRowEnd);
+    if (isFirstLineOfRow) {
+        while (mInstruction < instructions.size() && instructions[mInstruction].offset < mOffset)
+            ++mInstruction;
+        if (mInstruction < instructions.size() && instructions[mInstruction].offset == mOffset) {
+            instruction = &instructions[mInstruction++];
+            mAddress = instruction->address;
+        }
+        mRowEnd = findRowEnd();
+    }
+
+    std::stringstream ss;
+    ss << std::hex << std::uppercase << std::setfill('0') << std::setw(4) << (mAddress & 0xffff) << "  ";
+
+    const auto& bank = mFile->debugInfo()->bank();
+    if (bank)
+        ss << std::setw(2) << *bank << "  ";
+    else
+        ss << "--  ";
+
+    if (!location) {
+        ss << "; " << std::dec << (mRowEnd - mOffset) << " bytes of empty space";
+        mOffset = mRowEnd;
+        mAddress = int64_t(mFile->loadAddress() + mOffset);
+        line = ss.str();
+        return true;
+    }
+
+    size_t count = std::min(mRowEnd - mOffset, BytesPerLine);
+    for (size_t i = 0; i < BytesPerLine; i++) {
+        if (i < count)
+            ss << std::setw(2) << unsigned(bytes[mOffset + i].value) << ' ';
+        else
+            ss << "   ";
+    }
+
+    if (isFirstLineOfRow) {
+        std::string tStates;
+        if (instruction) {
+            DebugInformation::TStates t;
+            t.min = instruction->minTStates;
+            t.max = instruction->maxTStates;
+            tStates = DebugInformation::tStatesToString(t);
+        }
+
+        std::string fileName = location->file()->name().string();
+        ss << ' ' << std::setfill(' ') << std::left << std::setw(8) << tStates
+           << std::setw(16) << (fileName + ':' + std::to_string(location->line())) << ' '
+           << sourceLine(location->file(), location->line());
+
+        if (mLastOffsets[location->file()] < mRowEnd)
+            mSources.erase(location->file());
+    }
+
+    mOffset += count;
+    mAddress += int64_t(count);
+
+    line = ss.str();
+    while (!line.empty() && isspace(uint8_t(line.back())))
+        line.pop_back();
+
+    return true;
+}
+
+size_t ListingWriter::findRowEnd() const
+{
+    const auto* bytes = mFile->data();
+    const auto& instructions = mFile->instructions();
+
+    size_t limit = mFile->size();
+    if (mInstruction < instructions.size())
+        limit = std::min<size_t>(limit, instructions[mInstruction].offset);
+
+    SourceLocation* location = bytes[mOffset].location;
+    size_t end = mOffset + 1;
+    while (end < limit && isSameLine(bytes[end].location, location))
+        ++end;
+
+    return end;
+}
+
+std::string ListingWriter::sourceLine(const FileID* file, int line)
+{
+    auto& source = mSources[file];
+    if (!source) {
+        source = std::make_unique<SourceText>();
+
+        std::error_code error;
+        if (!file->isGenerated() && std::filesystem::is_regular_file(file->path(), error)) {
+            source->text = loadFile(file->path());
+            source->lines.emplace_back(0);
+            for (size_t i = 0; i < source->text.size(); i++) {
+                if (source->text[i] == '\n')
+                    source->lines.emplace_back(i + 1);
+            }
+        }
+    }
+
+    if (line < 1 || size_t(line) > source->lines.size())
+        return std::string();
+
+    size_t start = source->lines[line - 1];
+    size_t end = (size_t(line) < source->lines.size() ? source->lines[line] : source->text.size());
+    while (end > start && isspace(uint8_t(source->text[end - 1])))
+        --end;
+
+    return source->text.substr(start, end - start);
+}
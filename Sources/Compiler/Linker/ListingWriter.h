@@ -0,0 +1,45 @@
+#ifndef COMPILER_LINKER_LISTINGWRITER_H
+#define COMPILER_LINKER_LISTINGWRITER_H
+
+#include "Common/Common.h"
+
+class CompiledFile;
+class FileID;
+
+/*
+ * Generates assembler listing (.lst) line by line, so it never has to be kept in memory as a whole.
+ * Each line contains address, bank, up to four bytes, T-states, source file:line and source text.
+ * Instructions longer than four bytes continue on the following lines without source.
+ */
+class ListingWriter
+{
+public:
+    static constexpr size_t BytesPerLine = 4;
+
+    explicit ListingWriter(const CompiledFile* file);
+    ~ListingWriter();
+
+    bool nextLine(std::string& line);
+
+private:
+    struct SourceText
+    {
+        std::string text;
+        std::vector<size_t> lines;
+    };
+
+    const CompiledFile* mFile;
+    std::unordered_map<const FileID*, std::unique_ptr<SourceText>> mSources;
+    std::unordered_map<const FileID*, size_t> mLastOffsets;
+    size_t mOffset;
+    size_t mRowEnd;
+    size_t mInstruction;
+    int64_t mAddress;
+
+    size_t findRowEnd() const;
+    std::string sourceLine(const FileID* file, int line);
+
+    DISABLE_COPY(ListingWriter);
+};
+
+#endif
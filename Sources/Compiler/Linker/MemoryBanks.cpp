@@ -0,0 +1,26 @@
+#include "MemoryBanks.h"
+#include "Compiler/LexerUtils.h"
+#include "Common/Strings.h"
+
+std::optional<int> bankForFileName(const std::string& name)
+{
+    if (name.length() != 5 || !startsWith(toUpper(name), "BANK") || !isDigit(name[4]))
+        return std::nullopt;
+
+    int bank = charToInt(name[4]);
+    if (bank < 0 || bank > 7)
+        return std::nullopt;
+
+    return bank;
+}
+
+size_t contendedBytes(std::optional<int> bank, size_t startAddress, size_t size)
+{
+    // On 128K machines odd banks are contended wherever they are paged in; bank 5 is the one at 0x4000
+    if (bank)
+        return ((*bank & 1) != 0 ? size : 0);
+
+    size_t start = std::max<size_t>(startAddress, 0x4000);
+    size_t end = std::min<size_t>(startAddress + size, 0x8000);
+    return (start < end ? end - start : 0);
+}
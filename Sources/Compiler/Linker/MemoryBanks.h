@@ -0,0 +1,11 @@
+#ifndef COMPILER_LINKER_MEMORYBANKS_H
+#define COMPILER_LINKER_MEMORYBANKS_H
+
+#include "Common/Common.h"
+
+// Files named BANK0..BANK7 are loaded into the corresponding 128K memory bank
+std::optional<int> bankForFileName(const std::string& name);
+
+size_t contendedBytes(std::optional<int> bank, size_t startAddress, size_t size);
+
+#endif
@@ -3,9 +3,14 @@
 #include "Compiler/Linker/CodeEmitter.h"
 #include "Compiler/Assembler/Instruction.h"
 #include "Compiler/Assembler/Label.h"
+#include "Compiler/Assembler/RelaxedJump.h"
+#include "Compiler/Assembler/PeepholeOptimizer.h"
 
 ProgramSection::ProgramSection(std::string name)
     : mName(std::move(name))
+    , mHasRelaxableBranches(false)
+    , mPreferSpeed(false)
+    , mBranchesRelaxed(false)
 {
     registerFinalizer();
 }
@@ -17,6 +22,8 @@ ProgramSection::~ProgramSection()
 bool ProgramSection::calculateSizeInBytes(size_t& outSize,
     ISectionResolver* sectionResolver, std::unique_ptr<CompilerError>& resolveError) const
 {
+    relaxBranches(sectionResolver);
+
     for (const auto& instruction : mInstructions)
         instruction->resetCounters();
 
@@ -35,6 +42,8 @@ bool ProgramSection::calculateSizeInBytes(size_t& outSize,
 bool ProgramSection::resolveLabels(size_t& address,
     ISectionResolver* sectionResolver, std::unique_ptr<CompilerError>& resolveError)
 {
+    relaxBranches(sectionResolver);
+
     for (const auto& instruction : mInstructions)
         instruction->resetCounters();
 
@@ -57,6 +66,23 @@ void ProgramSection::addInstruction(Instruction* instruction)
     mInstructions.emplace_back(instruction);
 }
 
+void ProgramSection::runPeepholeOptimizer()
+{
+    if (mOptimization)
+        return;
+
+    PeepholeOptimizer optimizer(mInstructions);
+    optimizer.run();
+    mOptimization = optimizer.result();
+    mCalculatedSize.reset();
+}
+
+void ProgramSection::collectReferences(SymbolReferences& refs) const
+{
+    for (const auto& instruction : mInstructions)
+        instruction->collectReferences(refs);
+}
+
 bool ProgramSection::canEmitCodeWithoutBaseAddress(ISectionResolver* sectionResolver) const
 {
     for (const auto& instruction : mInstructions) {
@@ -73,9 +99,13 @@ bool ProgramSection::emitCode(CodeEmitter* emitter, size_t baseAddress, ISection
     int64_t nextAddress = int64_t(baseAddress);
     int64_t startAddress = nextAddress;
 
+    relaxBranches(sectionResolver);
+
     for (const auto& instruction : mInstructions)
         instruction->resetCounters();
 
+    emitter->resetTiming();
+
     for (const auto& instruction : mInstructions) {
         if (nextAddress > 0xffff) {
             resolveError = std::make_unique<CompilerError>(instruction->location(), "address is over 64K.");
@@ -99,13 +129,124 @@ bool ProgramSection::emitCode(CodeEmitter* emitter, size_t baseAddress, ISection
         return false;
     }
 
-    emitter->addSectionDebugInfo(mName, startAddress, Compression::None, (nextAddress - startAddress), {});
+    emitter->verifyTStatesChecks(startAddress, nextAddress);
+
+    DebugInformation::Timing timing = emitter->takeTiming();
+    timing.optimization = mOptimization;
+
+    emitter->addSectionDebugInfo(mName, startAddress,
+        Compression::None, (nextAddress - startAddress), {}, std::move(timing));
     return true;
 }
 
 ProgramSection* ProgramSection::clone() const
 {
     ProgramSection* copy = new (heap()) ProgramSection(mName);
+    copy->mHasRelaxableBranches = mHasRelaxableBranches;
+    copy->mOptimization = mOptimization;
     Instruction::copyInstructions(copy->mInstructions, mInstructions);
     return copy;
 }
+
+void ProgramSection::relaxBranches(ISectionResolver* sectionResolver) const
+{
+    if (mBranchesRelaxed)
+        return;
+
+    if (!mHasRelaxableBranches || mPreferSpeed) {
+        mBranchesRelaxed = true;
+        return;
+    }
+
+    // All jumps start as JP and are only shortened when their displacement is the same for two different
+    // section bases (i.e. target is in this section) and fits into a byte. A jump that had to be lengthened
+    // again is never shortened twice, so this loop always terminates.
+
+    std::unordered_set<const RelaxedJump*> jumps;
+    std::unordered_set<const RelaxedJump*> keepLong;
+
+    for (;;) {
+        std::unique_ptr<CompilerError> resolveError;
+        std::vector<BranchDisplacement> displacements1;
+        std::vector<BranchDisplacement> displacements2;
+        if (!collectBranchDisplacements(0, displacements1, sectionResolver, resolveError)
+                || !collectBranchDisplacements(1, displacements2, sectionResolver, resolveError)
+                || displacements1.size() != displacements2.size()) {
+            // section size depends on something that is not known yet; try again later
+            for (auto jump : jumps)
+                jump->setShort(false);
+            return;
+        }
+
+        std::unordered_map<const RelaxedJump*, bool> fits;
+        size_t n = displacements1.size();
+        for (size_t i = 0; i < n; i++) {
+            const auto& d1 = displacements1[i];
+            const auto& d2 = displacements2[i];
+            bool fit = (d1.jump == d2.jump && d1.displacement && d2.displacement
+                && *d1.displacement == *d2.displacement && *d1.displacement >= -128 && *d1.displacement <= 127);
+            jumps.emplace(d1.jump);
+            auto it = fits.emplace(d1.jump, fit);
+            if (!it.second)
+                it.first->second = it.first->second && fit;
+        }
+
+        bool changed = false;
+        for (const auto& it : fits) {
+            const RelaxedJump* jump = it.first;
+            bool shouldBeShort = (it.second && jump->canBeShort() && keepLong.find(jump) == keepLong.end());
+            if (jump->isShort() != shouldBeShort) {
+                if (!shouldBeShort)
+                    keepLong.emplace(jump);
+                jump->setShort(shouldBeShort);
+                changed = true;
+            }
+        }
+
+        if (!changed)
+            break;
+    }
+
+    mBranchesRelaxed = true;
+}
+
+bool ProgramSection::collectBranchDisplacements(size_t baseAddress, std::vector<BranchDisplacement>& displacements,
+    ISectionResolver* sectionResolver, std::unique_ptr<CompilerError>& resolveError) const
+{
+    bool result = true;
+
+    try {
+        for (const auto& instruction : mInstructions)
+            instruction->resetCounters();
+
+        size_t address = baseAddress;
+        for (const auto& instruction : mInstructions) {
+            if (!instruction->resolveLabel(address, sectionResolver, resolveError)) {
+                result = false;
+                break;
+            }
+        }
+
+        if (result) {
+            for (const auto& instruction : mInstructions)
+                instruction->resetCounters();
+
+            int64_t nextAddress = int64_t(baseAddress);
+            for (const auto& instruction : mInstructions) {
+                if (!instruction->collectBranchDisplacements(displacements, nextAddress, sectionResolver, resolveError)) {
+                    result = false;
+                    break;
+                }
+            }
+        }
+    } catch (...) {
+        for (const auto& instruction : mInstructions)
+            instruction->unresolveLabel();
+        throw;
+    }
+
+    for (const auto& instruction : mInstructions)
+        instruction->unresolveLabel();
+
+    return result;
+}
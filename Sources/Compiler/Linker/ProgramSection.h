@@ -2,12 +2,14 @@
 #define COMPILER_LINKER_PROGRAMSECTION_H
 
 #include "Common/GC.h"
-#include "Compiler/Compression/Compression.h"
+#include "Compiler/Linker/DebugInformation.h"
 
 class Instruction;
 class CodeEmitter;
 class CompilerError;
 class ISectionResolver;
+struct BranchDisplacement;
+struct SymbolReferences;
 
 class ProgramSection : public GCObject
 {
@@ -17,6 +19,9 @@ public:
 
     const std::string& name() const { return mName; }
 
+    void setHasRelaxableBranches() { mHasRelaxableBranches = true; }
+    void setPreferSpeed(bool flag) { mPreferSpeed = flag; }
+
     bool calculateSizeInBytes(size_t& outSize,
         ISectionResolver* sectionResolver, std::unique_ptr<CompilerError>& resolveError) const;
 
@@ -26,6 +31,10 @@ public:
 
     void addInstruction(Instruction* instruction);
 
+    void runPeepholeOptimizer();
+
+    void collectReferences(SymbolReferences& refs) const;
+
     bool canEmitCodeWithoutBaseAddress(ISectionResolver* sectionResolver) const;
     bool emitCode(CodeEmitter* emitter, size_t baseAddress,
         ISectionResolver* sectionResolver, std::unique_ptr<CompilerError>& resolveError) const;
@@ -36,6 +45,14 @@ private:
     std::string mName;
     std::vector<Instruction*> mInstructions;
     mutable std::optional<size_t> mCalculatedSize;
+    bool mHasRelaxableBranches;
+    bool mPreferSpeed;
+    mutable bool mBranchesRelaxed;
+    std::optional<DebugInformation::Optimization> mOptimization;
+
+    void relaxBranches(ISectionResolver* sectionResolver) const;
+    bool collectBranchDisplacements(size_t baseAddress, std::vector<BranchDisplacement>& displacements,
+        ISectionResolver* sectionResolver, std::unique_ptr<CompilerError>& resolveError) const;
 
     DISABLE_COPY(ProgramSection);
 };
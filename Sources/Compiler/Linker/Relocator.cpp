@@ -0,0 +1,58 @@
+#include "Relocator.h"
+
+static const char relocatorTemplate[] = R"(relocate:
+        ld      a, (de)
+        inc     de
+        or      a
+        ret     z                       ; end of table
+        inc     a
+        jr      z, relocate_skip
+        sub     2
+        add     a, l
+        ld      l, a
+        jr      nc, relocate_patch
+        inc     h
+relocate_patch:
+        ld      a, (hl)
+        add     a, c
+        ld      (hl), a
+        inc     hl
+        ld      a, (hl)
+        adc     a, b
+        ld      (hl), a
+        inc     hl
+        jr      relocate
+relocate_skip:
+        ld      a, l
+        add     a, 0xfe
+        ld      l, a
+        jr      nc, relocate
+        inc     h
+        jr      relocate
+)";
+
+void writeRelocationTable(const std::vector<size_t>& offsets, std::vector<uint8_t>& dst)
+{
+    size_t position = 0;
+    for (size_t offset : offsets) {
+        assert(offset >= position);
+        size_t distance = offset - position;
+        while (distance >= 0xfe) {
+            dst.emplace_back(0xff);
+            distance -= 0xfe;
+        }
+        dst.emplace_back(uint8_t(distance + 1));
+        position = offset + 2;
+    }
+    dst.emplace_back(0x00);
+}
+
+const char* relocatorSymbol()
+{
+    return "relocate";
+}
+
+const char* relocatorSource()
+{
+    return relocatorTemplate;
+}
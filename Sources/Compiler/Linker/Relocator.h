@@ -0,0 +1,21 @@
+#ifndef COMPILER_LINKER_RELOCATOR_H
+#define COMPILER_LINKER_RELOCATOR_H
+
+#include "Common/Common.h"
+
+/*
+ * Relocation table lists offsets of words in the module that should be adjusted when module is loaded
+ * to a different address. Each byte of the table is:
+ *
+ *    0x00          end of table
+ *    0x01..0xFE    skip (value - 1) bytes, then patch the word and skip over it
+ *    0xFF          skip 254 bytes
+ */
+void writeRelocationTable(const std::vector<size_t>& offsets, std::vector<uint8_t>& dst);
+
+const char* relocatorSymbol();
+
+// HL = address of the module, DE = address of relocation table, BC = value to add to each word
+const char* relocatorSource();
+
+#endif
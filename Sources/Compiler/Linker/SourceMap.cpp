@@ -0,0 +1,327 @@
+#include "SourceMap.h"
+#include "Compiler/Linker/CompiledFile.h"
+#include "Compiler/Linker/DebugInformation.h"
+#include "Compiler/Tree/SourceLocation.h"
+#include "Common/BuildManifest.h"
+
+namespace
+{
+    const size_t HeaderSize = 44;
+    const uint16_t Version = 1;
+
+    class Reader
+    {
+    public:
+        Reader(const uint8_t* data, size_t size) : mData(data), mSize(size), mOffset(0) {}
+
+        bool seek(size_t offset)
+        {
+            if (offset > mSize)
+                return false;
+            mOffset = offset;
+            return true;
+        }
+
+        bool readWord(uint16_t& value)
+        {
+            if (mSize - mOffset < 2)
+                return false;
+            value = uint16_t(mData[mOffset] | (mData[mOffset + 1] << 8));
+            mOffset += 2;
+            return true;
+        }
+
+        bool readDWord(uint32_t& value)
+        {
+            if (mSize - mOffset < 4)
+                return false;
+            const uint8_t* p = &mData[mOffset];
+            value = uint32_t(p[0]) | (uint32_t(p[1]) << 8) | (uint32_t(p[2]) << 16) | (uint32_t(p[3]) << 24);
+            mOffset += 4;
+            return true;
+        }
+
+        bool readLeb128(uint64_t& value)
+        {
+            value = 0;
+            for (int shift = 0; shift < 64; shift += 7) {
+                if (mOffset >= mSize)
+                    return false;
+                uint8_t byte = mData[mOffset++];
+                value |= uint64_t(byte & 0x7f) << shift;
+                if ((byte & 0x80) == 0)
+                    return true;
+            }
+            return false;
+        }
+
+        bool readZigzag(int64_t& value)
+        {
+            uint64_t encoded;
+            if (!readLeb128(encoded))
+                return false;
+            value = int64_t(encoded >> 1) ^ -int64_t(encoded & 1);
+            return true;
+        }
+
+        bool readString(size_t offset, std::string& value) const
+        {
+            if (offset >= mSize)
+                return false;
+            const uint8_t* start = &mData[offset];
+            const uint8_t* end = static_cast<const uint8_t*>(memchr(start, 0, mSize - offset));
+            if (!end)
+                return false;
+            value.assign(reinterpret_cast<const char*>(start), size_t(end - start));
+            return true;
+        }
+
+    private:
+        const uint8_t* mData;
+        size_t mSize;
+        size_t mOffset;
+    };
+}
+
+static void writeDWordAt(std::vector<uint8_t>& dst, size_t offset, uint32_t value)
+{
+    dst[offset + 0] = uint8_t(value & 0xff);
+    dst[offset + 1] = uint8_t((value >> 8) & 0xff);
+    dst[offset + 2] = uint8_t((value >> 16) & 0xff);
+    dst[offset + 3] = uint8_t((value >> 24) & 0xff);
+}
+
+static void writeLeb128(std::vector<uint8_t>& dst, uint64_t value)
+{
+    while (value >= 0x80) {
+        dst.emplace_back(uint8_t((value & 0x7f) | 0x80));
+        value >>= 7;
+    }
+    dst.emplace_back(uint8_t(value));
+}
+
+static void writeZigzag(std::vector<uint8_t>& dst, int64_t value)
+{
+    writeLeb128(dst, (uint64_t(value) << 1) ^ uint64_t(value >> 63));
+}
+
+SourceMap::SourceMap()
+    : mBank(NoBank)
+    , mLoadAddress(0)
+    , mSize(0)
+{
+}
+
+SourceMap::~SourceMap()
+{
+}
+
+const SourceMap::Run* SourceMap::findRun(int64_t address) const
+{
+    auto it = std::upper_bound(mRuns.begin(), mRuns.end(), address,
+        [](int64_t address, const Run& run) { return address < run.address; });
+    if (it == mRuns.begin())
+        return nullptr;
+
+    --it;
+    if (address >= it->address + it->size)
+        return nullptr;
+
+    return &*it;
+}
+
+void SourceMap::build(const CompiledFile* file)
+{
+    mFiles.clear();
+    mRuns.clear();
+    mSymbols.clear();
+
+    const auto& bank = file->debugInfo()->bank();
+    mBank = (bank ? uint16_t(*bank) : NoBank);
+    mLoadAddress = int64_t(file->loadAddress());
+    mSize = int64_t(file->size());
+
+    std::unordered_map<const FileID*, int> fileIndices;
+    const SourceLocation* lastLocation = nullptr;
+    const CodeEmitter::Byte* bytes = file->data();
+    for (size_t i = 0, n = file->size(); i < n; i++) {
+        const SourceLocation* location = bytes[i].location;
+        if (!mRuns.empty() && location == lastLocation) {
+            ++mRuns.back().size;
+            continue;
+        }
+
+        int fileIndex = -1;
+        int line = 0;
+        if (location) {
+            auto it = fileIndices.find(location->file());
+            if (it == fileIndices.end()) {
+                it = fileIndices.emplace(location->file(), int(mFiles.size())).first;
+                mFiles.emplace_back(location->file()->name().string());
+            }
+            fileIndex = it->second;
+            line = location->line();
+        }
+
+        lastLocation = location;
+        if (!mRuns.empty() && mRuns.back().file == fileIndex && mRuns.back().line == line)
+            ++mRuns.back().size;
+        else
+            mRuns.emplace_back(Run{ mLoadAddress + int64_t(i), 1, fileIndex, line });
+    }
+
+    for (const auto& section : file->debugInfo()->sections()) {
+        if (section.timing) {
+            for (const auto& label : section.timing->labels)
+                mSymbols.emplace_back(Symbol{ label.name, label.address });
+        }
+    }
+
+    std::sort(mSymbols.begin(), mSymbols.end(), [](const Symbol& a, const Symbol& b) {
+            return (a.address != b.address ? a.address < b.address : a.name < b.name);
+        });
+    mSymbols.erase(std::unique(mSymbols.begin(), mSymbols.end(), [](const Symbol& a, const Symbol& b) {
+            return a.address == b.address && a.name == b.name;
+        }), mSymbols.end());
+}
+
+bool SourceMap::update(BuildManifest& manifest, const std::filesystem::path& path, const CompiledFile* file)
+{
+    if (manifest.isUpToDate(path, file->fingerprint()))
+        return false;
+
+    SourceMap sourceMap;
+    sourceMap.build(file);
+
+    std::vector<uint8_t> data;
+    sourceMap.write(data);
+    manifest.writeFile(path, data.data(), data.size(), file->fingerprint());
+    return true;
+}
+
+void SourceMap::write(std::vector<uint8_t>& dst) const
+{
+    std::vector<uint8_t> strings;
+    auto addString = [&strings](const std::string& str) -> uint32_t {
+            uint32_t offset = uint32_t(strings.size());
+            strings.insert(strings.end(), str.begin(), str.end());
+            strings.emplace_back(0);
+            return offset;
+        };
+
+    size_t fileTable = HeaderSize;
+    size_t symbolTable = fileTable + mFiles.size() * 4;
+    size_t runStream = symbolTable + mSymbols.size() * 8;
+
+    dst.clear();
+    dst.resize(runStream);
+
+    memcpy(dst.data(), "RSMP", 4);
+    dst[4] = uint8_t(Version & 0xff);
+    dst[5] = uint8_t(Version >> 8);
+    dst[6] = uint8_t(mBank & 0xff);
+    dst[7] = uint8_t(mBank >> 8);
+    writeDWordAt(dst, 8, uint32_t(mLoadAddress));
+    writeDWordAt(dst, 12, uint32_t(mSize));
+    writeDWordAt(dst, 16, uint32_t(mFiles.size()));
+    writeDWordAt(dst, 20, uint32_t(fileTable));
+    writeDWordAt(dst, 24, uint32_t(mSymbols.size()));
+    writeDWordAt(dst, 28, uint32_t(symbolTable));
+    writeDWordAt(dst, 32, uint32_t(mRuns.size()));
+    writeDWordAt(dst, 36, uint32_t(runStream));
+
+    for (size_t i = 0; i < mFiles.size(); i++)
+        writeDWordAt(dst, fileTable + i * 4, addString(mFiles[i]));
+
+    for (size_t i = 0; i < mSymbols.size(); i++) {
+        writeDWordAt(dst, symbolTable + i * 8, uint32_t(mSymbols[i].address));
+        writeDWordAt(dst, symbolTable + i * 8 + 4, addString(mSymbols[i].name));
+    }
+
+    int64_t lastFile = 0;
+    int64_t lastLine = 0;
+    for (const auto& run : mRuns) {
+        writeLeb128(dst, uint64_t(run.size));
+        writeZigzag(dst, int64_t(run.file + 1) - lastFile);
+        writeZigzag(dst, int64_t(run.line) - lastLine);
+        lastFile = run.file + 1;
+        lastLine = run.line;
+    }
+
+    // String offsets are relative to the string table, keep it 4-byte aligned
+    dst.resize((dst.size() + 3) & ~size_t(3));
+    size_t stringTable = dst.size();
+    writeDWordAt(dst, 40, uint32_t(stringTable));
+    dst.insert(dst.end(), strings.begin(), strings.end());
+}
+
+bool SourceMap::read(const uint8_t* data, size_t size)
+{
+    mFiles.clear();
+    mRuns.clear();
+    mSymbols.clear();
+
+    if (size < HeaderSize || memcmp(data, "RSMP", 4) != 0)
+        return false;
+
+    Reader reader(data, size);
+    uint16_t version, bank;
+    uint32_t loadAddress, codeSize, fileCount, fileTable, symbolCount, symbolTable, runCount, runStream, stringTable;
+    if (!reader.seek(4)
+            || !reader.readWord(version) || !reader.readWord(bank)
+            || !reader.readDWord(loadAddress) || !reader.readDWord(codeSize)
+            || !reader.readDWord(fileCount) || !reader.readDWord(fileTable)
+            || !reader.readDWord(symbolCount) || !reader.readDWord(symbolTable)
+            || !reader.readDWord(runCount) || !reader.readDWord(runStream)
+            || !reader.readDWord(stringTable))
+        return false;
+    if (version != Version)
+        return false;
+
+    mBank = bank;
+    mLoadAddress = loadAddress;
+    mSize = codeSize;
+
+    if (!reader.seek(fileTable))
+        return false;
+    for (uint32_t i = 0; i < fileCount; i++) {
+        uint32_t offset;
+        std::string name;
+        if (!reader.readDWord(offset) || !reader.readString(size_t(stringTable) + offset, name))
+            return false;
+        mFiles.emplace_back(std::move(name));
+    }
+
+    if (!reader.seek(symbolTable))
+        return false;
+    for (uint32_t i = 0; i < symbolCount; i++) {
+        uint32_t address, offset;
+        std::string name;
+        if (!reader.readDWord(address) || !reader.readDWord(offset)
+                || !reader.readString(size_t(stringTable) + offset, name))
+            return false;
+        mSymbols.emplace_back(Symbol{ std::move(name), int64_t(address) });
+    }
+
+    if (!reader.seek(runStream))
+        return false;
+    int64_t address = mLoadAddress;
+    int64_t file = 0;
+    int64_t line = 0;
+    for (uint32_t i = 0; i < runCount; i++) {
+        uint64_t length;
+        int64_t fileDelta, lineDelta;
+        if (!reader.readLeb128(length) || !reader.readZigzag(fileDelta) || !reader.readZigzag(lineDelta))
+            return false;
+
+        file += fileDelta;
+        line += lineDelta;
+        if (file < 0 || file > int64_t(mFiles.size()))
+            return false;
+
+        mRuns.emplace_back(Run{ address, int64_t(length), int(file - 1), int(line) });
+        address += int64_t(length);
+    }
+
+    return true;
+}
@@ -0,0 +1,83 @@
+#ifndef COMPILER_LINKER_SOURCEMAP_H
+#define COMPILER_LINKER_SOURCEMAP_H
+
+#include "Common/Common.h"
+
+class CompiledFile;
+class BuildManifest;
+
+/*
+ * Binary source map (.srcmap). All values are little-endian, offsets are from the start of the file.
+ *
+ *    0  char[4]  "RSMP"
+ *    4  uint16   version (1)
+ *    6  uint16   bank (0xffff if the file is not in a bank)
+ *    8  uint32   load address
+ *   12  uint32   size of the code in bytes
+ *   16  uint32   number of source files       20  uint32  offset of the file table
+ *   24  uint32   number of symbols            28  uint32  offset of the symbol table
+ *   32  uint32   number of runs               36  uint32  offset of the run stream
+ *   40  uint32   offset of the string table
+ *
+ * File table contains string offsets, one uint32 per file. Symbol table contains 8-byte entries sorted
+ * by address: uint32 address, uint32 string offset. String table contains NUL-terminated names.
+ *
+ * Run stream describes consecutive bytes generated from the same source line, starting at the load
+ * address. Each run is three LEB128 values: length in bytes, zigzag-encoded delta of (file index + 1)
+ * and zigzag-encoded delta of the line number. File index + 1 equal to 0 means there is no source.
+ *
+ * Run addresses are where the bytes are loaded, symbol addresses are values of the labels; they differ
+ * for sections that are copied or decompressed elsewhere at runtime.
+ */
+class SourceMap
+{
+public:
+    static constexpr uint16_t NoBank = 0xffff;
+
+    struct Run
+    {
+        int64_t address;
+        int64_t size;
+        int file;               // -1 if there is no source
+        int line;
+    };
+
+    struct Symbol
+    {
+        std::string name;
+        int64_t address;
+    };
+
+    SourceMap();
+    ~SourceMap();
+
+    const std::vector<std::string>& files() const { return mFiles; }
+    const std::vector<Run>& runs() const { return mRuns; }
+    const std::vector<Symbol>& symbols() const { return mSymbols; }
+
+    uint16_t bank() const { return mBank; }
+    int64_t loadAddress() const { return mLoadAddress; }
+    int64_t size() const { return mSize; }
+
+    const Run* findRun(int64_t address) const;
+
+    void build(const CompiledFile* file);
+
+    // Source map is rebuilt only if fingerprint of the file changed since it was written; returns true if it was
+    static bool update(BuildManifest& manifest, const std::filesystem::path& path, const CompiledFile* file);
+
+    void write(std::vector<uint8_t>& dst) const;
+    bool read(const uint8_t* data, size_t size);
+
+private:
+    std::vector<std::string> mFiles;
+    std::vector<Run> mRuns;
+    std::vector<Symbol> mSymbols;
+    uint16_t mBank;
+    int64_t mLoadAddress;
+    int64_t mSize;
+
+    DISABLE_COPY(SourceMap);
+};
+
+#endif
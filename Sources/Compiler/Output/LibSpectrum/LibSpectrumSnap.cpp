@@ -0,0 +1,27 @@
+#include "LibSpectrumSnap.h"
+#include "Compiler/Output/LibSpectrum/LibSpectrumBuffer.h"
+#include "Compiler/CompilerError.h"
+
+LibSpectrumSnap::LibSpectrumSnap(LibSpectrum& lib)
+    : mLibSpectrum(lib)
+{
+    mSnap = libspectrum_snap_alloc();
+    if (!mSnap) {
+        mLibSpectrum.throwIfError();
+        throw CompilerError(nullptr, "Unable to initialize snapshot writer.");
+    }
+}
+
+LibSpectrumSnap::~LibSpectrumSnap()
+{
+    libspectrum_snap_free(mSnap);
+}
+
+void LibSpectrumSnap::write(LibSpectrumBuffer& buffer, size_t* length, libspectrum_id_t type)
+{
+    int outFlags = 0;
+    auto error = libspectrum_snap_write(buffer, length, &outFlags, mSnap, type, nullptr, 0);
+    mLibSpectrum.throwIfError();
+    if (error != LIBSPECTRUM_ERROR_NONE)
+        throw CompilerError(nullptr, "Unable to write snapshot data.");
+}
@@ -0,0 +1,26 @@
+#ifndef COMPILER_OUTPUT_LIBSPECTRUM_LIBSPECTRUMSNAP_H
+#define COMPILER_OUTPUT_LIBSPECTRUM_LIBSPECTRUMSNAP_H
+
+#include "Compiler/Output/LibSpectrum/LibSpectrum.h"
+
+class LibSpectrum;
+class LibSpectrumBuffer;
+
+class LibSpectrumSnap
+{
+public:
+    explicit LibSpectrumSnap(LibSpectrum& lib);
+    ~LibSpectrumSnap();
+
+    void write(LibSpectrumBuffer& buffer, size_t* length, libspectrum_id_t type);
+
+    operator libspectrum_snap*() const { return mSnap; }
+
+private:
+    LibSpectrum& mLibSpectrum;
+    libspectrum_snap* mSnap;
+
+    DISABLE_COPY(LibSpectrumSnap);
+};
+
+#endif
@@ -1,14 +1,11 @@
 #include "LibSpectrumTape.h"
 #include "Common/IO.h"
-#include "Compiler/Output/LibSpectrum/VirtualFile.h"
 #include "Compiler/Output/LibSpectrum/LibSpectrumTapeBlock.h"
 #include "Compiler/Output/LibSpectrum/LibSpectrumBuffer.h"
+#include "Compiler/Output/TurboLoader.h"
+#include "Compiler/Output/WavWriter.h"
 #include "Compiler/CompilerError.h"
 
-extern "C" {
-int write_tape(AFvirtualfile* vf, libspectrum_tape* tape, int sample_rate); // tape2wav
-}
-
 LibSpectrumTape::LibSpectrumTape(LibSpectrum& lib)
     : mLibSpectrum(lib)
 {
@@ -39,6 +36,17 @@ void LibSpectrumTape::appendBlockRaw(const void* data, size_t length, uint8_t fl
     appendBlock(block);
 }
 
+void LibSpectrumTape::appendBlockTurbo(const void* data, size_t length, uint8_t flag, const TurboTiming& timing)
+{
+    LibSpectrumTapeBlock block(mLibSpectrum, LIBSPECTRUM_TAPE_BLOCK_TURBO);
+    block.setPilot(timing.pilot, timing.pilotPulses);
+    block.setSync(timing.sync1, timing.sync2);
+    block.setBits(timing.zero, timing.one);
+    block.setPause(timing.pause);
+    block.setDataWithChecksum(data, length, flag);
+    appendBlock(block);
+}
+
 void LibSpectrumTape::appendBlockString(const std::string& data, uint8_t flag, int pauseMs)
 {
     appendBlockRaw(data.data(), data.length(), flag, pauseMs);
@@ -61,13 +69,35 @@ void LibSpectrumTape::writeFile(libspectrum_id_t type, const std::filesystem::pa
     ::writeFile(path, buffer.constData(), length, 0);
 }
 
-void LibSpectrumTape::writeWavFile(const std::filesystem::path& path)
+void LibSpectrumTape::writeWavFile(const std::filesystem::path& path, const WavFormat& format)
 {
-    VirtualFile vf;
-    auto result = write_tape(vf, mTape, 44100);
-    mLibSpectrum.throwIfError();
-    if (result != 0)
-        throw CompilerError(nullptr, "Unable to write tape data.");
+    WavWriter wav(path, format);
+
+    bool level = false;
+    libspectrum_dword pulseTStates = 0;
+    int flags = 0;
+
+    while (!(flags & LIBSPECTRUM_TAPE_FLAGS_TAPE)) {
+        libspectrum_dword tstates = 0;
+        auto error = libspectrum_tape_get_next_edge(&tstates, &flags, mTape);
+        mLibSpectrum.throwIfError();
+        if (error != LIBSPECTRUM_ERROR_NONE)
+            throw CompilerError(nullptr, "Unable to write tape data.");
+
+        pulseTStates += tstates;
+        if (flags & LIBSPECTRUM_TAPE_FLAGS_NO_EDGE)
+            continue;
+
+        wav.addPulse(pulseTStates, level);
+        pulseTStates = 0;
+
+        if (flags & LIBSPECTRUM_TAPE_FLAGS_LEVEL_LOW)
+            level = false;
+        else if (flags & LIBSPECTRUM_TAPE_FLAGS_LEVEL_HIGH)
+            level = true;
+        else
+            level = !level;
+    }
 
-    ::writeFile(path, vf.data(), vf.length(), 0);
+    wav.finish();
 }
@@ -6,6 +6,8 @@
 class LibSpectrum;
 class LibSpectrumTapeBlock;
 class LibSpectrumBuffer;
+struct TurboTiming;
+struct WavFormat;
 
 class LibSpectrumTape
 {
@@ -15,11 +17,12 @@ public:
 
     void appendBlock(LibSpectrumTapeBlock& block);
     void appendBlockRaw(const void* data, size_t length, uint8_t flag = 0, int pauseMs = 1000);
+    void appendBlockTurbo(const void* data, size_t length, uint8_t flag, const TurboTiming& timing);
     void appendBlockString(const std::string& data, uint8_t flag = 0, int pauseMs = 1000);
 
     void write(LibSpectrumBuffer& buffer, size_t* length, libspectrum_id_t type);
     void writeFile(libspectrum_id_t type, const std::filesystem::path& path);
-    void writeWavFile(const std::filesystem::path& path);
+    void writeWavFile(const std::filesystem::path& path, const WavFormat& format);
 
     operator libspectrum_tape*() const { return mTape; }
 
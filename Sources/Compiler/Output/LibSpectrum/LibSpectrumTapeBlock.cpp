@@ -23,6 +23,28 @@ void LibSpectrumTapeBlock::setPause(int ms)
     mLibSpectrum.throwIfError();
 }
 
+void LibSpectrumTapeBlock::setPilot(int pulseLength, int pulseCount)
+{
+    libspectrum_tape_block_set_pilot_length(mBlock, libspectrum_dword(pulseLength));
+    libspectrum_tape_block_set_pilot_pulses(mBlock, size_t(pulseCount));
+    mLibSpectrum.throwIfError();
+}
+
+void LibSpectrumTapeBlock::setSync(int pulse1Length, int pulse2Length)
+{
+    libspectrum_tape_block_set_sync1_length(mBlock, libspectrum_dword(pulse1Length));
+    libspectrum_tape_block_set_sync2_length(mBlock, libspectrum_dword(pulse2Length));
+    mLibSpectrum.throwIfError();
+}
+
+void LibSpectrumTapeBlock::setBits(int zeroLength, int oneLength, int bitsInLastByte)
+{
+    libspectrum_tape_block_set_bit0_length(mBlock, libspectrum_dword(zeroLength));
+    libspectrum_tape_block_set_bit1_length(mBlock, libspectrum_dword(oneLength));
+    libspectrum_tape_block_set_bits_in_last_byte(mBlock, size_t(bitsInLastByte));
+    mLibSpectrum.throwIfError();
+}
+
 void LibSpectrumTapeBlock::setDataWithChecksum(const void* data, size_t length, uint8_t flag)
 {
     auto error = libspectrum_tape_block_set_data_length(mBlock, length + 2);
@@ -13,6 +13,9 @@ public:
     ~LibSpectrumTapeBlock();
 
     void setPause(int ms);
+    void setPilot(int pulseLength, int pulseCount);
+    void setSync(int pulse1Length, int pulse2Length);
+    void setBits(int zeroLength, int oneLength, int bitsInLastByte = 8);
     void setDataWithChecksum(const void* data, size_t length, uint8_t flag = 0);
 
     operator libspectrum_tape_block*() const { return mBlock; }
@@ -1,9 +1,65 @@
 #include "SpectrumSnapshotWriter.h"
 #include "Compiler/LexerUtils.h"
 #include "Compiler/CompilerError.h"
+#include "Compiler/Linker/MemoryBanks.h"
 #include "Common/Strings.h"
 #include "Common/StreamUtils.h"
 #include "Common/IO.h"
+#include "Compiler/Compression/Deflate.h"
+#include "Compiler/Compression/Lz4.h"
+#include "Compiler/Output/LibSpectrum/LibSpectrumSnap.h"
+#include "Compiler/Output/LibSpectrum/LibSpectrumBuffer.h"
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+static const size_t PageSize = 16384;
+
+// Runs of 5 or more equal bytes (2 or more for 0xED) are encoded as ED ED count byte.
+// Byte following a single 0xED is always written as is.
+static std::string compressZ80Block(const uint8_t* data, size_t size)
+{
+    std::string result;
+    result.reserve(size);
+
+    size_t i = 0;
+    while (i < size) {
+        uint8_t byte = data[i];
+        size_t run = 1;
+        while (i + run < size && run < 255 && data[i + run] == byte)
+            ++run;
+
+        if (run >= 5 || (byte == 0xed && run >= 2)) {
+            result += '\xed';
+            result += '\xed';
+            result += char(run);
+            result += char(byte);
+            i += run;
+        } else if (byte == 0xed) {
+            result += '\xed';
+            if (++i < size)
+                result += char(data[i++]);
+        } else {
+            result += char(byte);
+            ++i;
+        }
+    }
+
+    return result;
+}
+
+static void writeZ80Page(std::stringstream& ss, const uint8_t* data, uint8_t page)
+{
+    std::string compressed = compressZ80Block(data, PageSize);
+    if (compressed.length() < PageSize) {
+        writeWordLE(ss, uint16_t(compressed.length()));
+        writeByte(ss, page);
+        ss << compressed;
+    } else {
+        writeWordLE(ss, 0xffff);
+        writeByte(ss, page);
+        ss.write(reinterpret_cast<const char*>(data), PageSize);
+    }
+}
 
 ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
@@ -54,9 +110,10 @@ void SpectrumSnapshotWriter::addCodeFile(SourceLocation* location, std::string n
     if (startsWith(toUpper(name), "BANK") && name.length() > 4 && isDigit(name[4])) {
         hasBank = true;
 
-        bank = charToInt(name[4]);
-        if (bank < 0 || bank > 7 || name.length() != 5)
+        auto fileBank = bankForFileName(name);
+        if (!fileBank)
             throw CompilerError(location, "invalid bank number (should be in range 0 to 7).");
+        bank = *fileBank;
 
         if (mZ80Format == Z80Format::Auto)
             mZ80Format = Z80Format::Version2;
@@ -197,6 +254,12 @@ void SpectrumSnapshotWriter::setWriteZ80File(SourceLocation* loc, std::filesyste
     mZ80Location = loc;
 }
 
+void SpectrumSnapshotWriter::setWriteSzxFile(SourceLocation* loc, std::filesystem::path path)
+{
+    mZ80Location = loc;
+    mSzxFile = std::move(path);
+}
+
 void SpectrumSnapshotWriter::addWriteExeFile(
     SourceLocation* loc, std::filesystem::path input, std::filesystem::path output)
 {
@@ -211,6 +274,8 @@ void SpectrumSnapshotWriter::writeOutput()
 {
     if (mZ80File)
         writeZ80File(*mZ80File);
+    if (mSzxFile)
+        writeSzxFile(*mSzxFile);
 
     for (const auto& it : mExeFiles)
         writeExeFile(it.location, it.input, it.output);
@@ -294,10 +359,31 @@ void SpectrumSnapshotWriter::writeZ80File(const std::filesystem::path& path)
     writeByte(ss, mI);                                                  // 10
     writeByte(ss, mR);                                                  // 11
 
+    std::unique_ptr<uint8_t[]> memory{new uint8_t[8 * PageSize]};
+    buildMemory(memory.get());
+
+    // Version 1 stores 48K of memory as a single block terminated by 00 ED ED 00
+    std::string compressed48k;
+    if (format == Z80Format::Version1) {
+        std::unique_ptr<uint8_t[]> ram{new uint8_t[3 * PageSize]};
+        memcpy(&ram[0 * PageSize], &memory[5 * PageSize], PageSize);
+        memcpy(&ram[1 * PageSize], &memory[2 * PageSize], PageSize);
+        memcpy(&ram[2 * PageSize], &memory[0 * PageSize], PageSize);
+        compressed48k = compressZ80Block(ram.get(), 3 * PageSize);
+        if (compressed48k.length() + 4 < 3 * PageSize)
+            compressed48k.append("\x00\xed\xed\x00", 4);
+        else {
+            compressed48k.clear();
+            compressed48k.append(reinterpret_cast<const char*>(ram.get()), 3 * PageSize);
+        }
+    }
+
     uint8_t flags1 = 0;
     flags1 |= (mBorderColor & 7) << 1;
     if ((mR & 0x80) != 0)
         flags1 |= 0x01;
+    if (format == Z80Format::Version1 && compressed48k.length() != 3 * PageSize)
+        flags1 |= 0x20;
     writeByte(ss, flags1);                                              // 12
 
     writeWordLE(ss, mDE);                                               // 13
@@ -373,51 +459,138 @@ void SpectrumSnapshotWriter::writeZ80File(const std::filesystem::path& path)
             throw CompilerError(mZ80Location, "internal compiler error: unsupported z80 format.");
     }
 
-    std::unique_ptr<uint8_t[]> memory{new uint8_t[8 * 16384]};
-    buildMemory(memory.get());
-
-    if (format == Z80Format::Version1) {
-        ss.write(reinterpret_cast<const char*>(&memory[5 * 16384]), 16384);
-        ss.write(reinterpret_cast<const char*>(&memory[2 * 16384]), 16384);
-        ss.write(reinterpret_cast<const char*>(&memory[0 * 16384]), 16384);
-    } else {
-        writeWordLE(ss, 0xffff);
-        writeByte(ss, 8);               // bank 5: 0x4000 - 0x7fff
-        ss.write(reinterpret_cast<const char*>(&memory[5 * 16384]), 16384);
+    if (format == Z80Format::Version1)
+        ss << compressed48k;
+    else {
+        writeZ80Page(ss, &memory[5 * PageSize], 8);                    // bank 5: 0x4000 - 0x7fff
+        writeZ80Page(ss, &memory[2 * PageSize], (is48k ? 4 : 5));      // bank 2: 0x8000 - 0xbfff
+        writeZ80Page(ss, &memory[0 * PageSize], (is48k ? 5 : 3));      // bank 0: 0xc000 - 0xffff
+        if (!is48k) {
+            writeZ80Page(ss, &memory[1 * PageSize], 4);                // bank 1: 0xc000 - 0xffff
+            writeZ80Page(ss, &memory[3 * PageSize], 6);                // bank 3: 0xc000 - 0xffff
+            writeZ80Page(ss, &memory[4 * PageSize], 7);                // bank 4: 0xc000 - 0xffff
+            writeZ80Page(ss, &memory[6 * PageSize], 9);                // bank 6: 0xc000 - 0xffff
+            writeZ80Page(ss, &memory[7 * PageSize], 10);               // bank 7: 0xc000 - 0xffff
+        }
+    }
 
-        writeWordLE(ss, 0xffff);
-        writeByte(ss, (is48k ? 4 : 5)); // bank 2: 0x8000 - 0xbfff
-        ss.write(reinterpret_cast<const char*>(&memory[2 * 16384]), 16384);
+    std::string data = ss.str();
+    return writeFile(path, data);
+}
 
-        writeWordLE(ss, 0xffff);
-        writeByte(ss, (is48k ? 5 : 3)); // bank 0: 0xc000 - 0xffff
-        ss.write(reinterpret_cast<const char*>(&memory[0 * 16384]), 16384);
+void SpectrumSnapshotWriter::writeSzxFile(const std::filesystem::path& path)
+{
+    libspectrum_machine machine = LIBSPECTRUM_MACHINE_UNKNOWN;
+    switch (mZ80Machine) {
+        case Z80Machine::Auto: break;
+        case Z80Machine::Spectrum16k: machine = LIBSPECTRUM_MACHINE_16; break;
+        case Z80Machine::Spectrum48k: machine = LIBSPECTRUM_MACHINE_48; break;
+        case Z80Machine::Spectrum128k: machine = LIBSPECTRUM_MACHINE_128; break;
+        case Z80Machine::SpectrumPlus3: machine = LIBSPECTRUM_MACHINE_PLUS3; break;
+        case Z80Machine::Pentagon: machine = LIBSPECTRUM_MACHINE_PENT; break;
+        case Z80Machine::Scorpion: machine = LIBSPECTRUM_MACHINE_SCORP; break;
+        case Z80Machine::DidaktikKompakt: machine = LIBSPECTRUM_MACHINE_48; break;
+        case Z80Machine::SpectrumPlus2: machine = LIBSPECTRUM_MACHINE_PLUS2; break;
+        case Z80Machine::SpectrumPlus2A: machine = LIBSPECTRUM_MACHINE_PLUS2A; break;
+        case Z80Machine::TC2048: machine = LIBSPECTRUM_MACHINE_TC2048; break;
+        case Z80Machine::TC2068: machine = LIBSPECTRUM_MACHINE_TC2068; break;
+        case Z80Machine::TS2068: machine = LIBSPECTRUM_MACHINE_TS2068; break;
+    }
 
-        if (!is48k) {
-            writeWordLE(ss, 0xffff);
-            writeByte(ss, 4);           // bank 1: 0xc000 - 0xffff
-            ss.write(reinterpret_cast<const char*>(&memory[1 * 16384]), 16384);
+    if (machine == LIBSPECTRUM_MACHINE_UNKNOWN) {
+        machine = LIBSPECTRUM_MACHINE_48;
+        if (mPort1FFD != 0xffff)
+            machine = LIBSPECTRUM_MACHINE_PLUS3;
+        else if (mPort7FFD != 0)
+            machine = LIBSPECTRUM_MACHINE_128;
+        else {
+            for (const auto& it : mFiles) {
+                if (it.bank != 0 && it.bank != 2 && it.bank != 5) {
+                    machine = LIBSPECTRUM_MACHINE_128;
+                    break;
+                }
+            }
+        }
+    }
 
-            writeWordLE(ss, 0xffff);
-            writeByte(ss, 6);           // bank 3: 0xc000 - 0xffff
-            ss.write(reinterpret_cast<const char*>(&memory[3 * 16384]), 16384);
+    int capabilities = libspectrum_machine_capabilities(machine);
+    bool is128k = (capabilities & LIBSPECTRUM_MACHINE_CAPABILITY_128_MEMORY) != 0;
 
-            writeWordLE(ss, 0xffff);
-            writeByte(ss, 7);           // bank 4: 0xc000 - 0xffff
-            ss.write(reinterpret_cast<const char*>(&memory[4 * 16384]), 16384);
+    if (mPort1FFD != 0xffff && (capabilities & LIBSPECTRUM_MACHINE_CAPABILITY_PLUS3_MEMORY) == 0)
+        throw CompilerError(mZ80Location, "port 0x1ffd requires +2A or +3 machine.");
+    if (!is128k) {
+        for (const auto& it : mFiles) {
+            if (it.bank != 0 && it.bank != 2 && it.bank != 5)
+                throw CompilerError(it.location, "Invalid bank for 48k machine.");
+        }
+    }
 
-            writeWordLE(ss, 0xffff);
-            writeByte(ss, 9);           // bank 6: 0xc000 - 0xffff
-            ss.write(reinterpret_cast<const char*>(&memory[6 * 16384]), 16384);
+    LibSpectrum lib;
+    LibSpectrumSnap snap(lib);
+
+    libspectrum_snap_set_machine(snap, machine);
+    libspectrum_snap_set_a(snap, mA);
+    libspectrum_snap_set_f(snap, mF);
+    libspectrum_snap_set_bc(snap, mBC);
+    libspectrum_snap_set_de(snap, mDE);
+    libspectrum_snap_set_hl(snap, mHL);
+    libspectrum_snap_set_a_(snap, mShadowA);
+    libspectrum_snap_set_f_(snap, mShadowF);
+    libspectrum_snap_set_bc_(snap, mShadowBC);
+    libspectrum_snap_set_de_(snap, mShadowDE);
+    libspectrum_snap_set_hl_(snap, mShadowHL);
+    libspectrum_snap_set_ix(snap, mIX);
+    libspectrum_snap_set_iy(snap, mIY);
+    libspectrum_snap_set_i(snap, mI);
+    libspectrum_snap_set_r(snap, mR);
+    libspectrum_snap_set_sp(snap, mSP);
+    libspectrum_snap_set_pc(snap, mPC);
+    libspectrum_snap_set_iff1(snap, (mInterruptsEnabled ? 1 : 0));
+    libspectrum_snap_set_iff2(snap, (mInterruptsEnabled ? 1 : 0));
+    libspectrum_snap_set_im(snap, (mInterruptMode <= 2 ? mInterruptMode : 0));
+    libspectrum_snap_set_out_ula(snap, mBorderColor & 7);
+    libspectrum_snap_set_out_128_memoryport(snap, mPort7FFD);
+    libspectrum_snap_set_out_plus3_memoryport(snap, (mPort1FFD == 0xffff ? 0 : uint8_t(mPort1FFD)));
+    libspectrum_snap_set_out_ay_registerport(snap, mPortFFFD);
+    for (int i = 0; i < 16; i++)
+        libspectrum_snap_set_ay_registers(snap, i, mSoundChipRegisters[i]);
+
+    // libspectrum is built without zlib and would store pages uncompressed, so pages are not attached
+    // to the snapshot; RAMP chunks are appended below straight from the memory buffer.
+    size_t length = 0;
+    LibSpectrumBuffer buffer;
+    snap.write(buffer, &length, LIBSPECTRUM_ID_SNAPSHOT_SZX);
+
+    std::unique_ptr<uint8_t[]> memory{new uint8_t[8 * PageSize]};
+    buildMemory(memory.get());
 
-            writeWordLE(ss, 0xffff);
-            writeByte(ss, 10);          // bank 7: 0xc000 - 0xffff
-            ss.write(reinterpret_cast<const char*>(&memory[7 * 16384]), 16384);
-        }
+    std::stringstream ss;
+    ss.write(buffer.constData(), std::streamsize(length));
+
+    std::vector<uint8_t> compressed;
+    std::initializer_list<uint8_t> pages48k = { 5, 2, 0 };
+    std::initializer_list<uint8_t> pages128k = { 5, 2, 0, 1, 3, 4, 6, 7 };
+    for (uint8_t page : (is128k ? pages128k : pages48k)) {
+        if (machine == LIBSPECTRUM_MACHINE_16 && page != 5)
+            continue;
+
+        const uint8_t* data = &memory[page * PageSize];
+        zlibCompress(data, PageSize, compressed);
+        bool isCompressed = compressed.size() < PageSize;
+        size_t dataSize = (isCompressed ? compressed.size() : PageSize);
+
+        ss.write("RAMP", 4);
+        writeWordLE(ss, uint16_t((3 + dataSize) & 0xffff));
+        writeWordLE(ss, uint16_t((3 + dataSize) >> 16));
+        writeWordLE(ss, (isCompressed ? 1 : 0));  // ZXSTRF_COMPRESSED
+        writeByte(ss, page);
+        if (isCompressed)
+            ss.write(reinterpret_cast<const char*>(compressed.data()), std::streamsize(compressed.size()));
+        else
+            ss.write(reinterpret_cast<const char*>(data), PageSize);
     }
 
-    std::string data = ss.str();
-    return writeFile(path, data);
+    writeFile(path, ss.str());
 }
 
 void SpectrumSnapshotWriter::writeExeFile(SourceLocation* loc,
@@ -425,61 +598,66 @@ void SpectrumSnapshotWriter::writeExeFile(SourceLocation* loc,
 {
     std::string data = loadFile(input);
 
-    size_t off = 0, len = data.size(), memOff = size_t(-1), regOff = size_t(-1);
-    while (off <= len - 4) {
-        if (memcmp(&data[off], "MEMORY\x1A\x1A", 8) == 0) {
-            memOff = off;
-            if (regOff != size_t(-1))
-                break;
-        }
-        if (memcmp(&data[off], "REGISTERS\x1A\x1A", 11) == 0) {
-            regOff = off;
-            if (memOff != size_t(-1))
-                break;
-        }
-        ++off;
-    }
+    std::unique_ptr<uint8_t[]> memory{new uint8_t[8 * PageSize]};
+    buildMemory(memory.get());
+
+    std::vector<uint8_t> compressed;
+    lz4Compress(memory.get(), 8 * PageSize, compressed);
 
-    if (regOff == size_t(-1) || memOff == size_t(-1) || regOff + 31 > len || memOff + 8 * 16384 > len) {
+    // Runtime finds the data through the trailer at the end of the executable (see Emulator/GameImage.h)
+    size_t stateOffset = data.size();
+    if (stateOffset + 32 + compressed.size() + 16 > 0xffffffff) {
         std::stringstream ss;
         ss << "unable to embed memory data into file \"" << input << "\".";
         throw CompilerError(loc, ss.str());
     }
 
-    buildMemory(&data[memOff]);
-
-    data[regOff +  0] = mA;
-    data[regOff +  1] = mF;
-    data[regOff +  2] = (mBC >> 8) & 0xff;
-    data[regOff +  3] = mBC & 0xff;
-    data[regOff +  4] = (mDE >> 8) & 0xff;
-    data[regOff +  5] = mDE & 0xff;
-    data[regOff +  6] = mHL & 0xff;
-    data[regOff +  7] = (mHL >> 8) & 0xff;
-    data[regOff +  8] = mShadowA;
-    data[regOff +  9] = mShadowF;
-    data[regOff + 10] = (mShadowBC >> 8) & 0xff;
-    data[regOff + 11] = mShadowBC & 0xff;
-    data[regOff + 12] = (mShadowDE >> 8) & 0xff;
-    data[regOff + 13] = mShadowDE & 0xff;
-    data[regOff + 14] = mShadowHL & 0xff;
-    data[regOff + 15] = (mShadowHL >> 8) & 0xff;
-    data[regOff + 16] = (mIX >> 8) & 0xff;
-    data[regOff + 17] = mIX & 0xff;
-    data[regOff + 18] = (mIY >> 8) & 0xff;
-    data[regOff + 19] = mIY & 0xff;
-    data[regOff + 20] = mI;
-    data[regOff + 21] = mR;
-    data[regOff + 22] = mInterruptMode;
-    data[regOff + 23] = (mInterruptsEnabled ? 0 : 1);
-    data[regOff + 24] = mPC & 0xff;
-    data[regOff + 25] = (mPC >> 8) & 0xff;
-    data[regOff + 26] = mSP & 0xff;
-    data[regOff + 27] = (mSP >> 8) & 0xff;
-    data[regOff + 28] = (mPort1FFD == 0xffff ? 0 : uint8_t(mPort1FFD));
-    data[regOff + 29] = mPort7FFD;
-    data[regOff + 30] = mPortFFFD;
-    data[regOff + 31] = mBorderColor;
+    uint8_t state[32];
+    state[ 0] = mA;
+    state[ 1] = mF;
+    state[ 2] = (mBC >> 8) & 0xff;
+    state[ 3] = mBC & 0xff;
+    state[ 4] = (mDE >> 8) & 0xff;
+    state[ 5] = mDE & 0xff;
+    state[ 6] = mHL & 0xff;
+    state[ 7] = (mHL >> 8) & 0xff;
+    state[ 8] = mShadowA;
+    state[ 9] = mShadowF;
+    state[10] = (mShadowBC >> 8) & 0xff;
+    state[11] = mShadowBC & 0xff;
+    state[12] = (mShadowDE >> 8) & 0xff;
+    state[13] = mShadowDE & 0xff;
+    state[14] = mShadowHL & 0xff;
+    state[15] = (mShadowHL >> 8) & 0xff;
+    state[16] = (mIX >> 8) & 0xff;
+    state[17] = mIX & 0xff;
+    state[18] = (mIY >> 8) & 0xff;
+    state[19] = mIY & 0xff;
+    state[20] = mI;
+    state[21] = mR;
+    state[22] = mInterruptMode;
+    state[23] = (mInterruptsEnabled ? 0 : 1);
+    state[24] = mPC & 0xff;
+    state[25] = (mPC >> 8) & 0xff;
+    state[26] = mSP & 0xff;
+    state[27] = (mSP >> 8) & 0xff;
+    state[28] = (mPort1FFD == 0xffff ? 0 : uint8_t(mPort1FFD));
+    state[29] = mPort7FFD;
+    state[30] = mPortFFFD;
+    state[31] = mBorderColor;
+
+    uint8_t trailer[16];
+    uint8_t* p = trailer;
+    writeWordLE(p, uint16_t(stateOffset & 0xffff));
+    writeWordLE(p, uint16_t(stateOffset >> 16));
+    writeWordLE(p, uint16_t(compressed.size() & 0xffff));
+    writeWordLE(p, uint16_t(compressed.size() >> 16));
+    memcpy(p, "GAMEDATA", 8);
+
+    data.reserve(stateOffset + sizeof(state) + compressed.size() + sizeof(trailer));
+    data.append(reinterpret_cast<const char*>(state), sizeof(state));
+    data.append(reinterpret_cast<const char*>(compressed.data()), compressed.size());
+    data.append(reinterpret_cast<const char*>(trailer), sizeof(trailer));
 
     writeFile(output, data);
 }
@@ -55,7 +55,7 @@ public:
     void setR(uint8_t r) { mR = r; }
 
     void setPort7FFD(uint8_t v) { mPort7FFD = v; }
-    void setPortFFFD(uint8_t v) { mPort7FFD = v; }
+    void setPortFFFD(uint8_t v) { mPortFFFD = v; }
     void setPort1FFD(uint8_t v) { mPort1FFD = v; }
 
     void setBorderColor(uint8_t c) { mBorderColor = c; }
@@ -69,6 +69,7 @@ public:
         const std::string& originalName, const CodeEmitter::Byte* data, size_t size, size_t startAddress) override;
 
     void setWriteZ80File(SourceLocation* loc, std::filesystem::path path, Z80Format format = Z80Format::Auto);
+    void setWriteSzxFile(SourceLocation* loc, std::filesystem::path path);
     void addWriteExeFile(SourceLocation* loc, std::filesystem::path input, std::filesystem::path output);
 
     void writeOutput() override;
@@ -93,6 +94,7 @@ private:
 
     std::vector<File> mFiles;
     std::optional<std::filesystem::path> mZ80File;
+    std::optional<std::filesystem::path> mSzxFile;
     std::vector<ExeFile> mExeFiles;
     SourceLocation* mZ80Location;
     Z80Format mZ80Format;
@@ -122,6 +124,7 @@ private:
     bool mInterruptsEnabled;
 
     void writeZ80File(const std::filesystem::path& path);
+    void writeSzxFile(const std::filesystem::path& path);
     void writeExeFile(SourceLocation* loc, const std::filesystem::path& input, const std::filesystem::path& output);
 
     void buildMemory(void* dst);
@@ -11,9 +11,12 @@
 class SpectrumTapeWriter::DiskFile
 {
 public:
-    explicit DiskFile(uint8_t type) : mType(type) {}
+    explicit DiskFile(uint8_t type) : mType(type), mTurbo(false) {}
     virtual ~DiskFile() {}
 
+    bool isTurbo() const { return mTurbo; }
+    void setTurbo(bool flag) { mTurbo = flag; }
+
     size_t dataSize() const { return mData.size(); }
 
     DiskFile& setName(std::string name)
@@ -35,11 +38,14 @@ public:
 
     void writeHeader(LibSpectrumTape& tape) const
     {
-        std::stringstream ss;
-        writeByte(ss, mType);
-        ss.write(mName.data(), 10);
-        writeParams(ss);
-        tape.appendBlockString(ss.str(), 0);
+        uint8_t header[17];
+        uint8_t* p = header;
+        writeByte(p, mType);
+        memcpy(p, mName.data(), 10);
+        p += 10;
+        writeParams(p);
+        assert(p == header + sizeof(header));
+        tape.appendBlockRaw(header, sizeof(header), 0);
     }
 
     void writeData(LibSpectrumTape& tape) const
@@ -47,13 +53,19 @@ public:
         tape.appendBlockRaw(mData.data(), mData.size(), 255, 100);
     }
 
+    void writeTurboData(LibSpectrumTape& tape, const TurboTiming& timing) const
+    {
+        tape.appendBlockTurbo(mData.data(), mData.size(), 255, timing);
+    }
+
 protected:
-    virtual void writeParams(std::stringstream& ss) const = 0;
+    virtual void writeParams(uint8_t*& p) const = 0;
 
 private:
     std::string mName;
     std::vector<char> mData;
     uint8_t mType;
+    bool mTurbo;
 
     DISABLE_COPY(DiskFile);
 };
@@ -74,13 +86,13 @@ public:
     void setAutoStartLine(int line) { mAutoStartLine = line; }
 
 protected:
-    void writeParams(std::stringstream& ss) const override
+    void writeParams(uint8_t*& p) const override
     {
         size_t onTapeSize = dataSize();
         size_t inMemorySize = std::max(onTapeSize, mInMemorySize);
-        writeWordLE(ss, uint16_t(inMemorySize));
-        writeWordLE(ss, uint16_t(int16_t(mAutoStartLine)));
-        writeWordLE(ss, uint16_t(onTapeSize));
+        writeWordLE(p, uint16_t(inMemorySize));
+        writeWordLE(p, uint16_t(int16_t(mAutoStartLine)));
+        writeWordLE(p, uint16_t(onTapeSize));
     }
 
 private:
@@ -104,12 +116,12 @@ public:
     void setStartAddress(unsigned size) { mStartAddress = size; }
 
 protected:
-    void writeParams(std::stringstream& ss) const override
+    void writeParams(uint8_t*& p) const override
     {
-        writeWordLE(ss, uint16_t(dataSize()));
-        writeWordLE(ss, uint16_t(mStartAddress));
-        ss << '\x00';
-        ss << '\x80';
+        writeWordLE(p, uint16_t(dataSize()));
+        writeWordLE(p, uint16_t(mStartAddress));
+        writeByte(p, 0x00);
+        writeByte(p, 0x80);
     }
 
 private:
@@ -139,10 +151,11 @@ void SpectrumTapeWriter::addBasicFile(SourceLocation*, std::string name, const s
 }
 
 void SpectrumTapeWriter::addCodeFile(SourceLocation*, std::string name,
-    const std::string&, const CodeEmitter::Byte* data, size_t size, size_t startAddress)
+    const std::string& originalName, const CodeEmitter::Byte* data, size_t size, size_t startAddress)
 {
     auto codeFile = std::make_unique<CodeFile>();
     codeFile->setName(std::move(name));
+    codeFile->setTurbo(mTurboFileNames.find(originalName) != mTurboFileNames.end());
     codeFile->setStartAddress(startAddress);
     for (size_t i = 0; i < size; i++)
         codeFile->appendByte(data[i].value);
@@ -151,14 +164,25 @@ void SpectrumTapeWriter::addCodeFile(SourceLocation*, std::string name,
     mFiles.emplace_back(std::move(codeFile));
 }
 
+void SpectrumTapeWriter::addTurboFile(std::string originalName)
+{
+    mTurboFileNames.emplace(std::move(originalName));
+}
+
 void SpectrumTapeWriter::setWriteTapFile(std::filesystem::path path)
 {
     mTapFile = std::move(path);
 }
 
-void SpectrumTapeWriter::setWriteWavFile(std::filesystem::path path)
+void SpectrumTapeWriter::setWriteTzxFile(std::filesystem::path path)
+{
+    mTzxFile = std::move(path);
+}
+
+void SpectrumTapeWriter::setWriteWavFile(std::filesystem::path path, const WavFormat& format)
 {
     mWavFile = std::move(path);
+    mWavFormat = format;
 }
 
 void SpectrumTapeWriter::writeOutput()
@@ -166,16 +190,23 @@ void SpectrumTapeWriter::writeOutput()
     LibSpectrum lib;
     LibSpectrumTape tape(lib);
 
+    // Turbo blocks have no header, loader knows address and length of the data
     for (const auto& file : mFiles) {
-        file->writeHeader(tape);
-        file->writeData(tape);
+        if (file->isTurbo())
+            file->writeTurboData(tape, mTurboTiming);
+        else {
+            file->writeHeader(tape);
+            file->writeData(tape);
+        }
     }
 
     if (mTapFile)
         tape.writeFile(LIBSPECTRUM_ID_TAPE_TAP, *mTapFile);
+    if (mTzxFile)
+        tape.writeFile(LIBSPECTRUM_ID_TAPE_TZX, *mTzxFile);
 
     if (mWavFile)
-        tape.writeWavFile(*mWavFile);
+        tape.writeWavFile(*mWavFile, mWavFormat);
 
     lib.throwIfError();
 }
@@ -2,6 +2,8 @@
 #define COMPILER_OUTPUT_SPECTRUMTAPEWRITER_H
 
 #include "Compiler/Output/IOutputWriter.h"
+#include "Compiler/Output/TurboLoader.h"
+#include "Compiler/Output/WavWriter.h"
 
 class SpectrumTapeWriter final : public IOutputWriter
 {
@@ -15,8 +17,12 @@ public:
     void addCodeFile(SourceLocation* location, std::string name,
         const std::string& originalName, const CodeEmitter::Byte* data, size_t size, size_t startAddress) override;
 
+    void setTurboTiming(const TurboTiming& timing) { mTurboTiming = timing; }
+    void addTurboFile(std::string originalName);
+
     void setWriteTapFile(std::filesystem::path path);
-    void setWriteWavFile(std::filesystem::path path);
+    void setWriteTzxFile(std::filesystem::path path);
+    void setWriteWavFile(std::filesystem::path path, const WavFormat& format = WavFormat());
 
     void writeOutput() override;
 
@@ -26,8 +32,12 @@ private:
     class CodeFile;
 
     std::vector<std::unique_ptr<DiskFile>> mFiles;
+    std::unordered_set<std::string> mTurboFileNames;
+    TurboTiming mTurboTiming;
     std::optional<std::filesystem::path> mTapFile;
+    std::optional<std::filesystem::path> mTzxFile;
     std::optional<std::filesystem::path> mWavFile;
+    WavFormat mWavFormat;
 
     DISABLE_COPY(SpectrumTapeWriter);
 };
@@ -2,6 +2,7 @@
 #include "Common/Strings.h"
 #include "Common/StreamUtils.h"
 #include "Common/IO.h"
+#include "Compiler/CompilerError.h"
 
 enum
 {
@@ -9,6 +10,10 @@ enum
     MaxFiles = 128,
     SectorsPerTrack = 16,
     TotalSectors = (80 * 2 * SectorsPerTrack),
+    FileHeaderSize = 14,
+    CatalogEntrySize = 16,
+    SclHeaderSize = 9,
+    SclChecksumSize = 4,
 };
 
 ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -16,9 +21,12 @@ enum
 class TRDOSWriter::DiskFile
 {
 public:
-    explicit DiskFile(uint8_t type) : mType(type) {}
+    explicit DiskFile(uint8_t type) : mLocation(nullptr), mType(type) {}
     virtual ~DiskFile() {}
 
+    SourceLocation* location() const { return mLocation; }
+    void setLocation(SourceLocation* location) { mLocation = location; }
+
     size_t dataSize() const { return mData.size(); }
     size_t sizeInSectors() const { return (dataSize() + SectorSize - 1) / SectorSize; }
 
@@ -41,30 +49,27 @@ public:
 
     virtual void finalizeData() {}
 
-    void writeHeader(std::stringstream& ss) const
+    void writeHeader(uint8_t* p) const
     {
-        ss.write(mName.data(), 8);
-        writeByte(ss, mType);
-        writeParams(ss);
-        writeByte(ss, sizeInSectors());
+        memcpy(p, mName.data(), 8);
+        p += 8;
+        writeByte(p, mType);
+        writeParams(p);
+        writeByte(p, uint8_t(sizeInSectors()));
     }
 
-    void writeData(std::stringstream& ss) const
+    // Destination is zero-filled, padding of the last sector is not written
+    void writeData(uint8_t* p) const
     {
-        size_t dataSize = mData.size();
-        size_t fullSize = sizeInSectors() * SectorSize;
-
-        std::unique_ptr<char[]> buf{new char[fullSize]};
-        memcpy(buf.get(), mData.data(), dataSize);
-        memset(buf.get() + dataSize, 0, fullSize - dataSize);
-
-        ss.write(buf.get(), fullSize);
+        if (!mData.empty())
+            memcpy(p, mData.data(), mData.size());
     }
 
 protected:
-    virtual void writeParams(std::stringstream& ss) const = 0;
+    virtual void writeParams(uint8_t*& p) const = 0;
 
 private:
+    SourceLocation* mLocation;
     std::string mName;
     std::vector<char> mData;
     uint8_t mType;
@@ -97,10 +102,10 @@ public:
     }
 
 protected:
-    void writeParams(std::stringstream& ss) const override
+    void writeParams(uint8_t*& p) const override
     {
-        writeWordLE(ss, uint16_t(std::max(dataSize(), mInMemorySize)));
-        writeWordLE(ss, uint16_t(dataSize()));
+        writeWordLE(p, uint16_t(std::max(dataSize(), mInMemorySize)));
+        writeWordLE(p, uint16_t(dataSize()));
     }
 
 private:
@@ -124,10 +129,10 @@ public:
     void setStartAddress(unsigned size) { mStartAddress = size; }
 
 protected:
-    void writeParams(std::stringstream& ss) const override
+    void writeParams(uint8_t*& p) const override
     {
-        writeWordLE(ss, uint16_t(mStartAddress));
-        writeWordLE(ss, uint16_t(dataSize()));
+        writeWordLE(p, uint16_t(mStartAddress));
+        writeWordLE(p, uint16_t(dataSize()));
     }
 
 private:
@@ -136,6 +141,92 @@ private:
     DISABLE_COPY(CodeFile);
 };
 
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// Both images are allocated once and filled in a single pass over the files
+class TRDOSWriter::DiskImage
+{
+public:
+    DiskImage(bool trd, bool scl, size_t fileCount, size_t dataSectors)
+        : mFileCount(0)
+        , mSector(SectorsPerTrack)
+    {
+        if (trd)
+            mTrd.resize(TotalSectors * SectorSize);
+        if (scl) {
+            mSclData = SclHeaderSize + fileCount * FileHeaderSize;
+            mScl.resize(mSclData + dataSectors * SectorSize + SclChecksumSize);
+            memcpy(mScl.data(), "SINCLAIR", 8);
+            mScl[8] = uint8_t(fileCount);
+        }
+    }
+
+    const std::vector<uint8_t>& trd() const { return mTrd; }
+    const std::vector<uint8_t>& scl() const { return mScl; }
+
+    void addFile(const DiskFile& file)
+    {
+        size_t size = file.sizeInSectors() * SectorSize;
+
+        if (!mTrd.empty()) {
+            uint8_t* entry = &mTrd[mFileCount * CatalogEntrySize];
+            file.writeHeader(entry);
+            entry[14] = uint8_t(mSector % SectorsPerTrack);
+            entry[15] = uint8_t(mSector / SectorsPerTrack);
+            file.writeData(&mTrd[mSector * SectorSize]);
+        }
+
+        if (!mScl.empty()) {
+            file.writeHeader(&mScl[SclHeaderSize + mFileCount * FileHeaderSize]);
+            file.writeData(&mScl[mSclData]);
+            mSclData += size;
+        }
+
+        mSector += size / SectorSize;
+        ++mFileCount;
+    }
+
+    void finish(std::string volumeName)
+    {
+        if (!mTrd.empty()) {
+            if (volumeName.length() < 8)
+                volumeName.resize(8, ' ');
+
+            for (size_t i = mFileCount; i < MaxFiles; i++)
+                mTrd[i * CatalogEntrySize] = 1;
+
+            uint8_t* p = &mTrd[8 * SectorSize + 225];
+            writeByte(p, uint8_t(mSector % SectorsPerTrack));   // 225: next free sector
+            writeByte(p, uint8_t(mSector / SectorsPerTrack));   // 226: next free track
+            writeByte(p, uint8_t(0x16));                        // 227: disk type (80 track, 2 side)
+            writeByte(p, uint8_t(mFileCount));                  // 228: file count
+            writeWordLE(p, uint16_t(TotalSectors - mSector));   // 229: free sectors count
+            writeByte(p, uint8_t(SectorsPerTrack));             // 231: sectors per track
+            memcpy(p + 2, "         ", 9);                      // 232: reserved
+            memcpy(p + 13, volumeName.data(), 8);               // 245: volume name
+        }
+
+        if (!mScl.empty()) {
+            uint32_t checksum = 0;
+            for (size_t i = 0; i < mSclData; i++)
+                checksum += mScl[i];
+
+            uint8_t* p = &mScl[mSclData];
+            writeWordLE(p, uint16_t(checksum & 0xffff));
+            writeWordLE(p, uint16_t(checksum >> 16));
+        }
+    }
+
+private:
+    std::vector<uint8_t> mTrd;
+    std::vector<uint8_t> mScl;
+    size_t mSclData;
+    size_t mFileCount;
+    size_t mSector;
+
+    DISABLE_COPY(DiskImage);
+};
+
 ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
 TRDOSWriter::TRDOSWriter()
@@ -146,9 +237,10 @@ TRDOSWriter::~TRDOSWriter()
 {
 }
 
-void TRDOSWriter::addBasicFile(SourceLocation*, std::string name, const std::string& data, int startLine)
+void TRDOSWriter::addBasicFile(SourceLocation* location, std::string name, const std::string& data, int startLine)
 {
     auto basicFile = std::make_unique<BasicFile>();
+    basicFile->setLocation(location);
     basicFile->setName(std::move(name));
     if (startLine >= 0)
         basicFile->setAutoStartLine(startLine);
@@ -157,10 +249,11 @@ void TRDOSWriter::addBasicFile(SourceLocation*, std::string name, const std::str
     mFiles.emplace_back(std::move(basicFile));
 }
 
-void TRDOSWriter::addCodeFile(SourceLocation*, std::string name,
+void TRDOSWriter::addCodeFile(SourceLocation* location, std::string name,
     const std::string&, const CodeEmitter::Byte* data, size_t size, size_t startAddress)
 {
     auto codeFile = std::make_unique<CodeFile>();
+    codeFile->setLocation(location);
     codeFile->setName(std::move(name));
     codeFile->setStartAddress(startAddress);
     for (size_t i = 0; i < size; i++)
@@ -182,75 +275,28 @@ void TRDOSWriter::setWriteTrdFile(std::filesystem::path path, std::string volume
 
 void TRDOSWriter::writeOutput()
 {
-    if (mSclFile)
-        writeSclFile(*mSclFile);
-
-    if (mTrdFile)
-        writeTrdFile(*mTrdFile, mVolumeName.value());
-}
-
-void TRDOSWriter::writeSclFile(const std::filesystem::path& path)
-{
-    std::stringstream ss;
-    ss.write("SINCLAIR", 8);
-    writeByte(ss, uint8_t(mFiles.size()));
-    for (const auto& file : mFiles)
-        file->writeHeader(ss);
-    for (const auto& file : mFiles)
-        file->writeData(ss);
-
-    std::string data = ss.str();
-    return writeFile(path, data);
-}
-
-void TRDOSWriter::writeTrdFile(const std::filesystem::path& path, std::string volumeName)
-{
-    if (volumeName.length() < 8)
-        volumeName.resize(8, ' ');
-
-    std::stringstream ss;
-
-    // sectors 0..7
-    size_t sector = SectorsPerTrack;
-    for (size_t i = 0; i < MaxFiles; i++) {
-        if (i >= mFiles.size())
-            ss.write("\1\0\0\0\0\0\0\0\0\0\0\0\0\0\0\0", 16);
-        else {
-            mFiles[i]->writeHeader(ss);
-            writeByte(ss, uint8_t(sector % SectorsPerTrack));
-            writeByte(ss, uint8_t(sector / SectorsPerTrack));
-            sector += mFiles[i]->sizeInSectors();
-        }
+    if (!mSclFile && !mTrdFile)
+        return;
+
+    size_t dataSectors = 0;
+    for (size_t i = 0; i < mFiles.size(); i++) {
+        const auto& file = mFiles[i];
+        if (i >= MaxFiles)
+            throw CompilerError(file->location(), "too many files for TR-DOS disk.");
+        if (file->sizeInSectors() > 255)
+            throw CompilerError(file->location(), "file is too large for TR-DOS disk.");
+        dataSectors += file->sizeInSectors();
+        if (SectorsPerTrack + dataSectors > TotalSectors)
+            throw CompilerError(file->location(), "not enough space on TR-DOS disk.");
     }
 
-    // sector 8
-    char buf[SectorSize] = {0};
-    ss.write(buf, 225);
-    writeByte(ss, uint8_t(sector % SectorsPerTrack));   // 225: next free sector
-    writeByte(ss, uint8_t(sector / SectorsPerTrack));   // 226: next free track
-    writeByte(ss, uint8_t(0x16));                       // 227: disk type (80 track, 2 side)
-    writeByte(ss, uint8_t(mFiles.size()));              // 228: file count
-    writeWordLE(ss, uint16_t(TotalSectors - sector));   // 229: free sectors count
-    writeByte(ss, uint8_t(SectorsPerTrack));            // 231: sectors per track
-    ss.write("\0\0         ", 12);                      // 232: reserved
-    writeByte(ss, uint8_t(0));                          // 244: deleted files count
-    ss.write(volumeName.c_str(), 8);                    // 245: volume name
-    ss.write("\0\0\0", 3);                              // 253: reserved
-
-    // sector 9..15
-    memset(buf, 0, sizeof(buf));
-    for (size_t i = 9; i < 16; i++)
-        ss.write(buf, 256);
-
-    // sectors 16... (with data)
+    DiskImage image(mTrdFile.has_value(), mSclFile.has_value(), mFiles.size(), dataSectors);
     for (const auto& file : mFiles)
-        file->writeData(ss);
-
-    // remaining empty sectors
-    for (size_t i = sector; i < TotalSectors; i++)
-        ss.write(buf, SectorSize);
+        image.addFile(*file);
+    image.finish(mVolumeName.value_or(std::string()));
 
-    std::string data = ss.str();
-    assert(data.size() == TotalSectors * SectorSize);
-    writeFile(path, data);
+    if (mSclFile)
+        writeFile(*mSclFile, image.scl().data(), image.scl().size());
+    if (mTrdFile)
+        writeFile(*mTrdFile, image.trd().data(), image.trd().size());
 }
@@ -24,15 +24,13 @@ private:
     class DiskFile;
     class BasicFile;
     class CodeFile;
+    class DiskImage;
 
     std::vector<std::unique_ptr<DiskFile>> mFiles;
     std::optional<std::filesystem::path> mSclFile;
     std::optional<std::filesystem::path> mTrdFile;
     std::optional<std::string> mVolumeName;
 
-    void writeSclFile(const std::filesystem::path& path);
-    void writeTrdFile(const std::filesystem::path& path, std::string volumeName);
-
     DISABLE_COPY(TRDOSWriter);
 };
 
@@ -0,0 +1,241 @@
+#include "TurboLoader.h"
+#include "Compiler/CompilerError.h"
+
+/*
+ * Loader is the ROM LD-BYTES routine (0x0556) without the VERIFY branch. Its timing constants are
+ * recalculated for the configured pulse lengths. Overheads below are T-states between detecting an
+ * edge and the first sample of the next one, not counting the delay loop.
+ */
+
+namespace
+{
+    const int SampleTStates = 59;
+    const int WaitLoopTStates = 3349;
+
+    const int BitFirstEdgeOverhead = 180;
+    const int BitSecondEdgeOverhead = 110;
+    const int LeaderFirstEdgeOverhead = 187;
+    const int SyncEdgeOverhead = 159;
+
+    struct Counter
+    {
+        int start;
+        int threshold;
+    };
+}
+
+static const char turboLoaderTemplate[] = R"(turbo_load:
+        call    tload_bytes
+        ei
+        ret
+tload_bytes:
+        inc     d                       ; reset zero flag
+        ex      af, af'
+        dec     d
+        di
+        ld      a, 0x0f                 ; border white, MIC off
+        out     (0xfe), a
+        in      a, (0xfe)
+        rra
+        and     0x20
+        or      0x02                    ; border red
+        ld      c, a
+        cp      a
+tload_break:
+        ret     nz                      ; BREAK pressed
+tload_start:
+        call    tload_edge_1
+        jr      nc, tload_break
+        ld      hl, {WAIT}              ; make sure the signal is stable
+tload_wait:
+        djnz    tload_wait
+        dec     hl
+        ld      a, h
+        or      l
+        jr      nz, tload_wait
+        call    tload_edge_2
+        jr      nc, tload_break
+tload_leader:
+        ld      b, {LEADER_START}
+        call    tload_edge_2
+        jr      nc, tload_break
+        ld      a, {LEADER_MAX}
+        cp      b
+        jr      nc, tload_start
+        inc     h
+        jr      nz, tload_leader
+tload_sync:
+        ld      b, {SYNC_START}
+        call    tload_edge_1
+        jr      nc, tload_break
+        ld      a, b
+        cp      {SYNC_MAX}
+        jr      nc, tload_sync
+        call    tload_edge_1
+        ret     nc
+        ld      a, c                    ; border blue/yellow
+        xor     0x03
+        ld      c, a
+        ld      h, 0
+        ld      b, {BIT_START}
+        jr      tload_marker
+tload_loop:
+        ex      af, af'
+        jr      nz, tload_flag
+        ld      (ix+0), l
+        jr      tload_next
+tload_flag:
+        rl      c
+        xor     l
+        ret     nz                      ; wrong flag byte
+        ld      a, c
+        rra
+        ld      c, a
+        inc     de
+        jr      tload_dec
+tload_next:
+        inc     ix
+tload_dec:
+        dec     de
+        ex      af, af'
+        ld      b, {BYTE_START}
+tload_marker:
+        ld      l, 0x01
+tload_8_bits:
+        call    tload_edge_2
+        ret     nc
+        ld      a, {BIT_THRESHOLD}
+        cp      b
+        rl      l
+        ld      b, {BIT_START}
+        jp      nc, tload_8_bits
+        ld      a, h                    ; parity
+        xor     l
+        ld      h, a
+        ld      a, d
+        or      e
+        jr      nz, tload_loop
+        ld      a, h
+        cp      0x01                    ; carry is set if parity is correct
+        ret
+tload_edge_2:
+        call    tload_edge_1
+        ret     nc
+tload_edge_1:
+        ld      a, {EDGE_DELAY}
+tload_delay:
+        dec     a
+        jr      nz, tload_delay
+        and     a
+tload_sample:
+        inc     b
+        ret     z                       ; timeout
+        ld      a, 0x7f
+        in      a, (0xfe)
+        rra
+        ret     nc                      ; BREAK pressed
+        xor     c
+        and     0x20
+        jr      z, tload_sample
+        ld      a, c
+        cpl
+        ld      c, a
+        and     0x07
+        or      0x08
+        out     (0xfe), a
+        scf
+        ret
+)";
+
+bool TurboTiming::operator==(const TurboTiming& other) const
+{
+    return pilot == other.pilot
+        && pilotPulses == other.pilotPulses
+        && sync1 == other.sync1
+        && sync2 == other.sync2
+        && zero == other.zero
+        && one == other.one
+        && pause == other.pause;
+}
+
+const char* turboLoaderSymbol()
+{
+    return "turbo_load";
+}
+
+// Expected value of the counter after two edges (counter is incremented before each sample)
+static int countPair(int pulse, int overhead1, int overhead2)
+{
+    return std::max(1, (2 * pulse - overhead1 - overhead2) / SampleTStates + 3);
+}
+
+static int countSingle(int pulse, int overhead)
+{
+    return std::max(1, (2 * (pulse - overhead) / SampleTStates + 3) / 2);
+}
+
+// Distinguishes short and long pulses; counter should not overflow even for pulses 1.5 times longer
+static Counter counter(SourceLocation* location, int shortCount, int longCount, int minDistance, const char* error)
+{
+    if (longCount - shortCount < minDistance)
+        throw CompilerError(location, error);
+
+    Counter result;
+    result.start = 256 - longCount * 3 / 2 - 4;
+    result.threshold = result.start + (shortCount + longCount) / 2;
+    if (result.start < 1)
+        throw CompilerError(location, "turbo loader pulses are too long.");
+
+    return result;
+}
+
+static void replace(std::string& source, const char* name, int value)
+{
+    std::stringstream ss;
+    ss << "0x" << std::hex << std::setw(2) << std::setfill('0') << value;
+
+    std::string placeholder = std::string("{") + name + "}";
+    for (size_t pos; (pos = source.find(placeholder)) != std::string::npos; )
+        source.replace(pos, placeholder.length(), ss.str());
+}
+
+std::string turboLoaderSource(SourceLocation* location, const TurboTiming& timing)
+{
+    if (timing.pilotPulses < 768)
+        throw CompilerError(location, "turbo pilot tone should have at least 768 pulses.");
+
+    int edgeDelay = std::clamp((timing.zero * 5 / 8 - BitFirstEdgeOverhead - 6) / 16, 1, 255);
+    int delayTStates = 16 * edgeDelay + 6;
+    if (timing.zero < BitFirstEdgeOverhead + delayTStates)
+        throw CompilerError(location, "turbo pulse for bit 0 is too short.");
+
+    int bit0 = countPair(timing.zero, BitFirstEdgeOverhead + delayTStates, BitSecondEdgeOverhead + delayTStates);
+    int bit1 = countPair(timing.one, BitFirstEdgeOverhead + delayTStates, BitSecondEdgeOverhead + delayTStates);
+    Counter bits = counter(location, bit0, bit1, 4, "turbo pulses for bits 0 and 1 are too close.");
+
+    int leaderBit1 = countPair(timing.one, LeaderFirstEdgeOverhead + delayTStates, BitSecondEdgeOverhead + delayTStates);
+    int leaderPilot = countPair(timing.pilot, LeaderFirstEdgeOverhead + delayTStates, BitSecondEdgeOverhead + delayTStates);
+    Counter leader = counter(location, leaderBit1, leaderPilot, 4, "turbo pilot pulse is too short.");
+
+    int syncPulse = countSingle(timing.sync1, SyncEdgeOverhead + delayTStates);
+    int syncPilot = countSingle(timing.pilot, SyncEdgeOverhead + delayTStates);
+    Counter sync = counter(location, syncPulse, syncPilot, 3, "turbo sync pulse is too long.");
+    if (sync.threshold + countSingle(timing.sync2, SyncEdgeOverhead + delayTStates) * 3 / 2 > 255)
+        throw CompilerError(location, "second turbo sync pulse is too long.");
+
+    // Leader is accepted after 256 pilot pulse pairs, wait for a quarter of the pilot tone before that
+    int64_t pilotTStates = int64_t(timing.pilot) * timing.pilotPulses;
+    int wait = int(std::clamp<int64_t>(pilotTStates / 4 / WaitLoopTStates, 1, 0x415));
+
+    std::string source = turboLoaderTemplate;
+    replace(source, "WAIT", wait);
+    replace(source, "LEADER_START", leader.start);
+    replace(source, "LEADER_MAX", leader.threshold);
+    replace(source, "SYNC_START", sync.start);
+    replace(source, "SYNC_MAX", sync.threshold);
+    replace(source, "BIT_START", bits.start);
+    replace(source, "BYTE_START", bits.start + 2);
+    replace(source, "BIT_THRESHOLD", bits.threshold);
+    replace(source, "EDGE_DELAY", edgeDelay);
+    return source;
+}
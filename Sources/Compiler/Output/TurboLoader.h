@@ -0,0 +1,29 @@
+#ifndef COMPILER_OUTPUT_TURBOLOADER_H
+#define COMPILER_OUTPUT_TURBOLOADER_H
+
+#include "Common/Common.h"
+
+class SourceLocation;
+
+// Pulse lengths are in T-states, pause is in milliseconds
+struct TurboTiming
+{
+    int pilot = 1084;
+    int pilotPulses = 1600;
+    int sync1 = 333;
+    int sync2 = 367;
+    int zero = 285;
+    int one = 570;
+    int pause = 500;
+
+    bool operator==(const TurboTiming& other) const;
+    bool operator!=(const TurboTiming& other) const { return !(*this == other); }
+};
+
+const char* turboLoaderSymbol();
+
+// Loader has the interface of the ROM LD-BYTES routine: IX = address, DE = length, A = flag byte.
+// Carry flag is set on return if the block was loaded successfully.
+std::string turboLoaderSource(SourceLocation* location, const TurboTiming& timing);
+
+#endif
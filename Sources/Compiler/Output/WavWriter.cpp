@@ -0,0 +1,137 @@
+#include "WavWriter.h"
+
+static const uint32_t ClockFrequency = 3500000;
+static const size_t BufferSize = 65536;
+static const size_t HeaderSize = 44;
+
+static void writeDWordLE(uint8_t* p, uint32_t value)
+{
+    p[0] = uint8_t(value & 0xff);
+    p[1] = uint8_t((value >> 8) & 0xff);
+    p[2] = uint8_t((value >> 16) & 0xff);
+    p[3] = uint8_t((value >> 24) & 0xff);
+}
+
+static void writeWordLE(uint8_t* p, uint16_t value)
+{
+    p[0] = uint8_t(value & 0xff);
+    p[1] = uint8_t((value >> 8) & 0xff);
+}
+
+WavWriter::WavWriter(std::filesystem::path path, const WavFormat& format)
+    : mFile(std::move(path))
+    , mFormat(format)
+    , mBuffer(BufferSize)
+    , mBufferUsed(0)
+    , mBytesPerSample(size_t(format.bitsPerSample / 8))
+    , mDataSize(0)
+    , mRemainder(0)
+{
+    assert(format.bitsPerSample == 8 || format.bitsPerSample == 16);
+    assert(format.sampleRate > 0);
+
+    // Runs of samples are copied from these, so a pulse costs one memcpy per buffer
+    if (mBytesPerSample == 1) {
+        mHighSamples.resize(BufferSize, 0xff);
+        mLowSamples.resize(BufferSize, 0x00);
+    } else {
+        mHighSamples.resize(BufferSize);
+        mLowSamples.resize(BufferSize);
+        for (size_t i = 0; i < BufferSize; i += 2) {
+            writeWordLE(&mHighSamples[i], uint16_t(int16_t(32767)));
+            writeWordLE(&mLowSamples[i], uint16_t(int16_t(-32767)));
+        }
+    }
+
+    // Header is written when the size of the data is known
+    uint8_t header[HeaderSize] = {};
+    mFile.write(header, HeaderSize);
+}
+
+WavWriter::~WavWriter()
+{
+}
+
+const WavWriter::Run& WavWriter::run(uint32_t tStates)
+{
+    auto it = mRuns.find(tStates);
+    if (it != mRuns.end())
+        return it->second;
+
+    uint64_t scaled = uint64_t(tStates) * uint64_t(mFormat.sampleRate);
+    Run run;
+    run.samples = uint32_t(scaled / ClockFrequency);
+    run.remainder = uint32_t(scaled % ClockFrequency);
+    return mRuns.emplace(tStates, run).first->second;
+}
+
+void WavWriter::addPulse(uint32_t tStates, bool high)
+{
+    // Fractions of a sample are carried over into the next pulse, so total length of the tape is exact
+    const Run& pulse = run(tStates);
+    uint64_t samples = pulse.samples;
+    mRemainder += pulse.remainder;
+    if (mRemainder >= ClockFrequency) {
+        mRemainder -= ClockFrequency;
+        ++samples;
+    }
+
+    const uint8_t* source = (high ? mHighSamples.data() : mLowSamples.data());
+    size_t bytes = size_t(samples * mBytesPerSample);
+    while (bytes > 0) {
+        size_t n = std::min(bytes, BufferSize - mBufferUsed);
+        memcpy(mBuffer.data() + mBufferUsed, source, n);
+        mBufferUsed += n;
+        bytes -= n;
+        if (mBufferUsed == BufferSize)
+            flush();
+    }
+}
+
+void WavWriter::finish()
+{
+    flush();
+
+    if (mDataSize > 0xffffffffu - HeaderSize)
+        throw std::runtime_error("Tape is too long for a WAV file.");
+
+    uint8_t padding = 0;
+    if (mDataSize & 1)
+        mFile.write(&padding, 1);
+
+    writeHeader(mDataSize);
+    mFile.commit();
+}
+
+void WavWriter::flush()
+{
+    if (mBufferUsed == 0)
+        return;
+
+    mFile.write(mBuffer.data(), mBufferUsed);
+    mDataSize += mBufferUsed;
+    mBufferUsed = 0;
+}
+
+void WavWriter::writeHeader(uint64_t dataSize)
+{
+    uint32_t blockAlign = uint32_t(mBytesPerSample);
+    uint32_t byteRate = uint32_t(mFormat.sampleRate) * blockAlign;
+
+    uint8_t header[HeaderSize];
+    memcpy(header + 0, "RIFF", 4);
+    writeDWordLE(header + 4, uint32_t(HeaderSize - 8 + dataSize + (dataSize & 1)));
+    memcpy(header + 8, "WAVE", 4);
+    memcpy(header + 12, "fmt ", 4);
+    writeDWordLE(header + 16, 16);
+    writeWordLE(header + 20, 1); // PCM
+    writeWordLE(header + 22, 1); // mono
+    writeDWordLE(header + 24, uint32_t(mFormat.sampleRate));
+    writeDWordLE(header + 28, byteRate);
+    writeWordLE(header + 32, uint16_t(blockAlign));
+    writeWordLE(header + 34, uint16_t(mFormat.bitsPerSample));
+    memcpy(header + 36, "data", 4);
+    writeDWordLE(header + 40, uint32_t(dataSize));
+
+    mFile.writeAt(0, header, HeaderSize);
+}
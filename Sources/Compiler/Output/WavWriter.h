@@ -0,0 +1,47 @@
+#ifndef COMPILER_OUTPUT_WAVWRITER_H
+#define COMPILER_OUTPUT_WAVWRITER_H
+
+#include "Common/IO.h"
+
+struct WavFormat
+{
+    int sampleRate = 44100;
+    int bitsPerSample = 8;
+};
+
+class WavWriter
+{
+public:
+    WavWriter(std::filesystem::path path, const WavFormat& format);
+    ~WavWriter();
+
+    void addPulse(uint32_t tStates, bool high);
+
+    void finish();
+
+private:
+    struct Run
+    {
+        uint32_t samples;
+        uint32_t remainder;
+    };
+
+    FileWriter mFile;
+    WavFormat mFormat;
+    std::unordered_map<uint32_t, Run> mRuns;
+    std::vector<uint8_t> mBuffer;
+    std::vector<uint8_t> mHighSamples;
+    std::vector<uint8_t> mLowSamples;
+    size_t mBufferUsed;
+    size_t mBytesPerSample;
+    uint64_t mDataSize;
+    uint32_t mRemainder;
+
+    const Run& run(uint32_t tStates);
+    void flush();
+    void writeHeader(uint64_t dataSize);
+
+    DISABLE_COPY(WavWriter);
+};
+
+#endif
@@ -14,6 +14,7 @@
 
 const char* Project::FileSuffix = "retro";
 const char* Project::DefaultOutputDirectory = "_out";
+const std::vector<int> Project::DefaultBanks = { 0, 1, 3, 4, 6, 7 };
 
 Project::Project()
 {
@@ -77,6 +78,21 @@ static std::unique_ptr<Project::Section> parseSection(
     section->attachment = Project::Section::Attachment::Default;
     section->compression = Compression::None;
     section->compressionLocation = section->location;
+    section->optimization = Project::Section::Optimization::OptimizeSize;
+    section->memory = Project::Section::Memory::AnyMemory;
+    section->memoryLocation = section->location;
+    section->affinity = OPT_STRING(affinity, Section);
+    section->inPlace = OPT_BOOL(inPlace, Section).value_or(false);
+    section->peephole = OPT_BOOL(peephole, Section).value_or(false);
+    section->keep = OPT_BOOL(keep, Section).value_or(false);
+    section->turboLoader = OPT_BOOL(turboLoader, Section).value_or(false);
+    section->turboLoaderLocation =
+        (locFactory ? locFactory->createLocation(ATTR_ROW(turboLoader, Section)) : nullptr);
+    section->relocator = OPT_BOOL(relocator, Section).value_or(false);
+    section->relocatorLocation =
+        (locFactory ? locFactory->createLocation(ATTR_ROW(relocator, Section)) : nullptr);
+    section->decompressors = DecompressorVariant::None;
+    section->decompressorsLocation = section->location;
 
     auto attach = OPT_STRING(attachment, Section);
     if (attach) {
@@ -101,13 +117,98 @@ static std::unique_ptr<Project::Section> parseSection(
             section->compression = Compression::Zx0Quick;
         else if (*comp == "lzsa2")
             section->compression = Compression::Lzsa2;
+        else if (*comp == "best")
+            section->compression = Compression::Best;
+        else if (*comp == "best-fast")
+            section->compression = Compression::BestFast;
         else
             INVALID(compression, Section);
     }
 
+    auto optimize = OPT_STRING(optimize, Section);
+    if (optimize) {
+        if (*optimize == "size")
+            section->optimization = Project::Section::Optimization::OptimizeSize;
+        else if (*optimize == "speed")
+            section->optimization = Project::Section::Optimization::OptimizeSpeed;
+        else
+            INVALID(optimize, Section);
+    }
+
+    auto memory = OPT_STRING(memory, Section);
+    if (memory) {
+        if (locFactory)
+            section->memoryLocation = locFactory->createLocation(ATTR_ROW(memory, Section));
+
+        if (*memory == "any")
+            section->memory = Project::Section::Memory::AnyMemory;
+        else if (*memory == "uncontended")
+            section->memory = Project::Section::Memory::UncontendedMemory;
+        else
+            INVALID(memory, Section);
+    }
+
+    auto decompressors = OPT_STRING(decompressors, Section);
+    if (decompressors) {
+        if (locFactory)
+            section->decompressorsLocation = locFactory->createLocation(ATTR_ROW(decompressors, Section));
+
+        if (*decompressors == "small")
+            section->decompressors = DecompressorVariant::Small;
+        else if (*decompressors == "fast")
+            section->decompressors = DecompressorVariant::Fast;
+        else
+            INVALID(decompressors, Section);
+    }
+
     return section;
 }
 
+static WavFormat parseWavFormat(const XmlDocument& xml, XmlNode xmlOutput)
+{
+    WavFormat format;
+
+    auto sampleRate = OPT_INT(wavSampleRate, Output);
+    if (sampleRate) {
+        if (*sampleRate < 8000 || *sampleRate > 192000)
+            INVALID(wavSampleRate, Output);
+        format.sampleRate = *sampleRate;
+    }
+
+    auto bits = OPT_INT(wavBits, Output);
+    if (bits) {
+        if (*bits != 8 && *bits != 16)
+            INVALID(wavBits, Output);
+        format.bitsPerSample = *bits;
+    }
+
+    return format;
+}
+
+// TZX turbo data block stores all timings as 16-bit values
+static void parseTurboTiming(const XmlDocument& xml, XmlNode xmlOutputTZX, const char* name, int minValue, int& value)
+{
+    auto result = xmlGetOptionalIntAttribute(xml, xmlOutputTZX, name);
+    if (result) {
+        if (*result < minValue || *result > 0xffff)
+            xmlInvalidAttributeValue(xml, xmlOutputTZX, name);
+        value = *result;
+    }
+}
+
+static std::unique_ptr<TurboTiming> parseTurboTiming(const XmlDocument& xml, XmlNode xmlOutputTZX)
+{
+    auto timing = std::make_unique<TurboTiming>();
+    parseTurboTiming(xml, xmlOutputTZX, "pilot", 1, timing->pilot);
+    parseTurboTiming(xml, xmlOutputTZX, "pilotPulses", 1, timing->pilotPulses);
+    parseTurboTiming(xml, xmlOutputTZX, "sync1", 1, timing->sync1);
+    parseTurboTiming(xml, xmlOutputTZX, "sync2", 1, timing->sync2);
+    parseTurboTiming(xml, xmlOutputTZX, "zero", 1, timing->zero);
+    parseTurboTiming(xml, xmlOutputTZX, "one", 1, timing->one);
+    parseTurboTiming(xml, xmlOutputTZX, "pause", 0, timing->pause);
+    return timing;
+}
+
 static std::unique_ptr<Project::Output::Z80> parseZ80(
     const XmlDocument& xml, XmlNode xmlOutputZ80, SourceLocationFactory* locFactory)
 {
@@ -239,6 +340,33 @@ void Project::load(std::filesystem::path path, SourceLocationFactory* locationFa
             file->startLocation = (locationFactory ? locationFactory->createLocation(ATTR_ROW(start, File)) : nullptr);
             file->until = OPT_STRING(until, File);
             file->untilLocation = (locationFactory ? locationFactory->createLocation(ATTR_ROW(until, File)) : nullptr);
+            file->fillGaps = OPT_BOOL(fillGaps, File).value_or(false);
+            file->stripUnused = OPT_BOOL(stripUnused, File).value_or(false);
+            file->listing = OPT_BOOL(listing, File).value_or(false);
+            file->relocatable = OPT_BOOL(relocatable, File).value_or(false);
+            file->relocatableLocation =
+                (locationFactory ? locationFactory->createLocation(ATTR_ROW(relocatable, File)) : nullptr);
+            file->banksLocation = (locationFactory ? locationFactory->createLocation(ATTR_ROW(banks, File)) : nullptr);
+            file->bankTable = OPT_STRING(bankTable, File);
+            file->bankTableLocation =
+                (locationFactory ? locationFactory->createLocation(ATTR_ROW(bankTable, File)) : nullptr);
+
+            auto banks = OPT_STRING(banks, File);
+            if (banks) {
+                if (*banks == "auto")
+                    file->banks = DefaultBanks;
+                else {
+                    for (size_t i = 0; i < banks->length(); i += 2) {
+                        int bank = (*banks)[i] - '0';
+                        if (bank < 0 || bank > 7 || (i + 1 < banks->length() && (*banks)[i + 1] != ',')
+                                || std::find(file->banks.begin(), file->banks.end(), bank) != file->banks.end())
+                            INVALID(banks, File);
+                        file->banks.emplace_back(bank);
+                    }
+                    if (file->banks.empty())
+                        INVALID(banks, File);
+                }
+            }
 
             FOR_EACH(Section, File)
                 file->sections.emplace_back(parseSection(xml, xmlSection, file.get(), locationFactory));
@@ -252,6 +380,7 @@ void Project::load(std::filesystem::path path, SourceLocationFactory* locationFa
         output->type = Output::ZXSpectrumTAP;
         output->location = (locationFactory ? locationFactory->createLocation(ROW(OutputTAP)) : nullptr);
         output->enabled = OPT_STRING(enabled, OutputTAP);
+        output->wav = parseWavFormat(xml, xmlOutputTAP);
 
         FOR_EACH(File, OutputTAP) {
             Output::File outputFile = {};
@@ -265,6 +394,28 @@ void Project::load(std::filesystem::path path, SourceLocationFactory* locationFa
         outputs.emplace_back(std::move(output));
     }
 
+    FOR_EACH(OutputTZX, RetroProject) {
+        auto output = std::make_unique<Output>();
+        output->type = Output::ZXSpectrumTZX;
+        output->location = (locationFactory ? locationFactory->createLocation(ROW(OutputTZX)) : nullptr);
+        output->enabled = OPT_STRING(enabled, OutputTZX);
+        output->wav = parseWavFormat(xml, xmlOutputTZX);
+
+        output->turbo = parseTurboTiming(xml, xmlOutputTZX);
+
+        FOR_EACH(File, OutputTZX) {
+            Output::File outputFile = {};
+            outputFile.location = (locationFactory ? locationFactory->createLocation(ROW(File)) : nullptr);
+            outputFile.name = OPT_STRING(name, File);
+            outputFile.ref = OPT_STRING(ref, File);
+            outputFile.refBasic = OPT_STRING(refBasic, File);
+            outputFile.turbo = OPT_BOOL(turbo, File).value_or(false);
+            output->files.emplace_back(std::move(outputFile));
+        }
+
+        outputs.emplace_back(std::move(output));
+    }
+
     FOR_EACH(OutputTRD, RetroProject) {
         auto output = std::make_unique<Output>();
         output->type = Output::ZXSpectrumTRD;
@@ -301,6 +452,24 @@ void Project::load(std::filesystem::path path, SourceLocationFactory* locationFa
         outputs.emplace_back(std::move(output));
     }
 
+    FOR_EACH(OutputSZX, RetroProject) {
+        auto output = std::make_unique<Output>();
+        output->type = Output::ZXSpectrumSZX;
+        output->location = (locationFactory ? locationFactory->createLocation(ROW(OutputSZX)) : nullptr);
+        output->enabled = OPT_STRING(enabled, OutputSZX);
+        output->z80 = parseZ80(xml, xmlOutputSZX, locationFactory);
+
+        FOR_EACH(File, OutputSZX) {
+            Output::File outputFile = {};
+            outputFile.location = (locationFactory ? locationFactory->createLocation(ROW(File)) : nullptr);
+            outputFile.name = OPT_STRING(name, File);
+            outputFile.ref = OPT_STRING(ref, File);
+            output->files.emplace_back(std::move(outputFile));
+        }
+
+        outputs.emplace_back(std::move(output));
+    }
+
     FOR_EACH(OutputPC, RetroProject) {
         auto output = std::make_unique<Output>();
         output->type = Output::PC;
@@ -353,6 +522,35 @@ static void writeSection(std::stringstream& ss, const char* element, const Proje
         case Compression::Zx0: ss << " compression=\"" << "zx0" << '"'; break;
         case Compression::Zx0Quick: ss << " compression=\"" << "zx0-quick" << '"'; break;
         case Compression::Lzsa2: ss << " compression=\"" << "lzsa2" << '"'; break;
+        case Compression::Best: ss << " compression=\"" << "best" << '"'; break;
+        case Compression::BestFast: ss << " compression=\"" << "best-fast" << '"'; break;
+    }
+    switch (section.optimization) {
+        case Project::Section::Optimization::OptimizeSize: break;
+        case Project::Section::Optimization::OptimizeSpeed: ss << " optimize=\"" << "speed" << '"'; break;
+    }
+    switch (section.memory) {
+        case Project::Section::Memory::AnyMemory: break;
+        case Project::Section::Memory::UncontendedMemory: ss << " memory=\"" << "uncontended" << '"'; break;
+    }
+    if (section.affinity) {
+        ss << " affinity=";
+        xmlEncodeInQuotes(ss, *section.affinity);
+    }
+    if (section.inPlace)
+        ss << " inPlace=\"true\"";
+    if (section.peephole)
+        ss << " peephole=\"true\"";
+    if (section.keep)
+        ss << " keep=\"true\"";
+    if (section.turboLoader)
+        ss << " turboLoader=\"true\"";
+    if (section.relocator)
+        ss << " relocator=\"true\"";
+    switch (section.decompressors) {
+        case DecompressorVariant::None: break;
+        case DecompressorVariant::Small: ss << " decompressors=\"" << "small" << '"'; break;
+        case DecompressorVariant::Fast: ss << " decompressors=\"" << "fast" << '"'; break;
     }
     ss << " />\n";
 }
@@ -362,8 +560,10 @@ static void writeOutput(std::stringstream& ss, const Project::Output& output)
     const char* element = nullptr;
     switch (output.type) {
         case Project::Output::ZXSpectrumTAP: element = "OutputTAP"; break;
+        case Project::Output::ZXSpectrumTZX: element = "OutputTZX"; break;
         case Project::Output::ZXSpectrumTRD: element = "OutputTRD"; break;
         case Project::Output::ZXSpectrumZ80: element = "OutputZ80"; break;
+        case Project::Output::ZXSpectrumSZX: element = "OutputSZX"; break;
     }
 
     ss << "    <" << element;
@@ -371,6 +571,19 @@ static void writeOutput(std::stringstream& ss, const Project::Output& output)
         ss << " enabled=";
         xmlEncodeInQuotes(ss, *output.enabled);
     }
+    if (output.wav.sampleRate != WavFormat().sampleRate)
+        ss << " wavSampleRate=\"" << output.wav.sampleRate << '"';
+    if (output.wav.bitsPerSample != WavFormat().bitsPerSample)
+        ss << " wavBits=\"" << output.wav.bitsPerSample << '"';
+    if (output.turbo) {
+        ss << " pilot=\"" << output.turbo->pilot << '"';
+        ss << " pilotPulses=\"" << output.turbo->pilotPulses << '"';
+        ss << " sync1=\"" << output.turbo->sync1 << '"';
+        ss << " sync2=\"" << output.turbo->sync2 << '"';
+        ss << " zero=\"" << output.turbo->zero << '"';
+        ss << " one=\"" << output.turbo->one << '"';
+        ss << " pause=\"" << output.turbo->pause << '"';
+    }
     ss << ">\n";
 
     for (const auto& file : output.files) {
@@ -387,6 +600,8 @@ static void writeOutput(std::stringstream& ss, const Project::Output& output)
             ss << " refBasic=";
             xmlEncodeInQuotes(ss, *file.refBasic);
         }
+        if (file.turbo)
+            ss << " turbo=\"true\"";
         ss << " />\n";
     }
 
@@ -498,6 +713,26 @@ void Project::save(std::filesystem::path path, bool createNew)
                 ss << ' ';
                 xmlEncodeInQuotes(ss, *file->until);
             }
+            if (file->fillGaps)
+                ss << " fillGaps=\"true\"";
+            if (file->stripUnused)
+                ss << " stripUnused=\"true\"";
+            if (file->listing)
+                ss << " listing=\"true\"";
+            if (file->relocatable)
+                ss << " relocatable=\"true\"";
+            if (file->banks == DefaultBanks)
+                ss << " banks=\"auto\"";
+            else if (!file->banks.empty()) {
+                ss << " banks=\"";
+                for (size_t i = 0; i < file->banks.size(); i++)
+                    ss << (i > 0 ? "," : "") << file->banks[i];
+                ss << '"';
+            }
+            if (file->bankTable) {
+                ss << " bankTable=";
+                xmlEncodeInQuotes(ss, *file->bankTable);
+            }
             ss << ">\n";
             for (const auto& section : file->sections)
                 writeSection(ss, "Section", *section);
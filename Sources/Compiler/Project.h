@@ -2,6 +2,8 @@
 #define COMPILER_PROJECT_H
 
 #include "Compiler/Compression/Compression.h"
+#include "Compiler/Output/TurboLoader.h"
+#include "Compiler/Output/WavWriter.h"
 
 class Expr;
 class SourceLocation;
@@ -17,6 +19,7 @@ class Project
 public:
     static const char* FileSuffix;
     static const char* DefaultOutputDirectory;
+    static const std::vector<int> DefaultBanks;
 
     struct File;
 
@@ -42,6 +45,18 @@ public:
             Upper,
         };
 
+        enum Optimization
+        {
+            OptimizeSize,
+            OptimizeSpeed,
+        };
+
+        enum Memory
+        {
+            AnyMemory,
+            UncontendedMemory,
+        };
+
         File* file;
         SourceLocation* location;
         std::string name;
@@ -57,6 +72,19 @@ public:
         Attachment attachment;
         Compression compression;
         SourceLocation* compressionLocation;
+        Optimization optimization;
+        Memory memory;
+        SourceLocation* memoryLocation;
+        std::optional<std::string> affinity;
+        bool inPlace;
+        bool peephole;
+        bool keep;                              // root for unused section stripping
+        bool turboLoader;
+        SourceLocation* turboLoaderLocation;
+        bool relocator;
+        SourceLocation* relocatorLocation;
+        DecompressorVariant decompressors;
+        SourceLocation* decompressorsLocation;
     };
 
     struct File
@@ -68,6 +96,15 @@ public:
         SourceLocation* startLocation;
         std::optional<std::string> until;
         SourceLocation* untilLocation;
+        bool fillGaps;
+        bool stripUnused;
+        bool listing;                           // write assembler listing (.lst) for this file
+        bool relocatable;                       // generate relocation table (<name>.reloc) for this file
+        SourceLocation* relocatableLocation;
+        std::vector<int> banks;                 // if not empty, sections are distributed among these 128K banks
+        SourceLocation* banksLocation;
+        std::optional<std::string> bankTable;
+        SourceLocation* bankTableLocation;
         std::vector<std::unique_ptr<Section>> sections;
     };
 
@@ -76,8 +113,10 @@ public:
         enum Type
         {
             ZXSpectrumTAP,
+            ZXSpectrumTZX,
             ZXSpectrumTRD,
             ZXSpectrumZ80,
+            ZXSpectrumSZX,
             PC,
         };
 
@@ -87,6 +126,7 @@ public:
             std::optional<std::string> ref;
             std::optional<std::string> refBasic;
             std::optional<std::string> name;
+            bool turbo;                         // written as turbo data block without header
         };
 
         struct Z80
@@ -137,6 +177,8 @@ public:
         std::optional<std::string> enabled;
         std::vector<File> files;
         std::unique_ptr<Z80> z80;
+        std::unique_ptr<TurboTiming> turbo;
+        WavFormat wav;
 
         bool isEnabled(SymbolTable* symbolTable) const;
     };
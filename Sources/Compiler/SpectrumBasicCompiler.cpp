@@ -8,7 +8,7 @@
 
 #define APPEND(C) \
     if (d >= MAXLINELENGTH) \
-        throw CompilerError(new (mHeap) SourceLocation(source->fileID, line), "line is too long."); \
+        throw CompilerError(newLocation(source->fileID, line), "line is too long."); \
     else \
         lineIn[d++] = (C)
 
@@ -16,41 +16,39 @@
     for (const char* str = (STR); *str; ++str) \
         APPEND(*str)
 
-static SpectrumBasicCompiler* instance;
+static std::mutex heapMutex;
 
 SpectrumBasicCompiler::SpectrumBasicCompiler(GCHeap* heap, CompiledOutput* output)
     : mHeap(heap)
     , mOutput(output)
+    , mContext(new bas2tap_context)
     , mBasicFile(nullptr)
     , mSourceLocation(nullptr)
     , mStartLineLocation(nullptr)
     , mBasicFileLine(0)
 {
-    assert(instance == nullptr);
-    instance = this;
+    mContext->user = this;
+    mContext->error = bas2tapError;
+    mContext->fgets = bas2tapFGets;
+    mContext->output = bas2tapOutput;
+    mContext->embed = bas2tapEmbed;
 
-    bas2tap_error = bas2tapError;
-    bas2tap_fgets = bas2tapFGets;
-    bas2tap_output = bas2tapOutput;
-
-    bas2tap_reset();
+    bas2tap_reset(mContext.get());
 }
 
 SpectrumBasicCompiler::~SpectrumBasicCompiler()
 {
-    assert(instance == this);
-    instance = nullptr;
 }
 
 void SpectrumBasicCompiler::addFile(const SourceFile* source)
 {
     if (!mSourceLocation)
-        mSourceLocation = new (mHeap) SourceLocation(source->fileID, 1);
+        mSourceLocation = newLocation(source->fileID, 1);
 
-    std::string fileData = loadFile(source->fileID->path());
+    MappedFile fileData(source->fileID->path());
 
-    const char* p = fileData.c_str();
-    const char* end = p + fileData.length();
+    const char* p = fileData.data();
+    const char* end = p + fileData.size();
     int line = 0;
     while (p < end) {
         ++line;
@@ -58,8 +56,7 @@ void SpectrumBasicCompiler::addFile(const SourceFile* source)
         mBasicFileLine = line;
 
         if (!*p) {
-            throw CompilerError(
-                new (mHeap) SourceLocation(source->fileID, line), "unexpected NUL byte in source file.");
+            throw CompilerError(newLocation(source->fileID, line), "unexpected NUL byte in source file.");
         }
 
         char lineIn[MAXLINELENGTH + 1];
@@ -90,24 +87,13 @@ void SpectrumBasicCompiler::addFile(const SourceFile* source)
                     int n = int(pend - (p + 1));
                     if (n > 5 && !strncmp(p + 1, "file:", 5)) {
                         std::string name(p + 6, n - 5);
-                        auto file = mOutput->getFile(name);
-                        if (!file) {
-                            std::stringstream ss;
-                            ss << "there is no file named \"" << name << "\".";
-                            throw CompilerError(new (mHeap) SourceLocation(source->fileID, line), ss.str());
-                        }
-                        file->setUsedByBasic();
-                        size_t n = file->size();
-                        const CodeEmitter::Byte* fileP = file->data();
-                        for (size_t i = 0; i < n; ++i, ++fileP) {
-                            char buf[8];
-                            snprintf(buf, sizeof(buf), "{%02X}", fileP->value);
-                            APPENDSTR(buf);
-                        }
+                        char buf[32];
+                        snprintf(buf, sizeof(buf), BAS2TAP_EMBED_PREFIX "%d}", embedFile(source, line, name));
+                        APPENDSTR(buf);
                         p = pend + 1;
                         continue;
                     } else if (n > 10 && !strncmp(p + 1, "autostart:", 10)) {
-                        mStartLineLocation = new (mHeap) SourceLocation(source->fileID, line);
+                        mStartLineLocation = newLocation(source->fileID, line);
                         p += 11;
 
                         if (p == pend)
@@ -141,7 +127,7 @@ void SpectrumBasicCompiler::addFile(const SourceFile* source)
                     ss << "invalid directive \"";
                     ss.write(p + 1, n);
                     ss << "\".";
-                    throw CompilerError(new (mHeap) SourceLocation(source->fileID, line), ss.str());
+                    throw CompilerError(newLocation(source->fileID, line), ss.str());
                 }
             }
 
@@ -153,32 +139,45 @@ void SpectrumBasicCompiler::addFile(const SourceFile* source)
         lineIn[d] = 0;
 
         char* basicIndex = nullptr;
-        int basicLine = bas2tap_PrepareLine(lineIn, line, &basicIndex);
+        int basicLine = bas2tap_PrepareLine(mContext.get(), lineIn, line, &basicIndex);
         if (basicLine < 0) {
             if (basicLine == -1)
-                throw CompilerError(new (mHeap) SourceLocation(source->fileID, line), "compilation error");
+                throw CompilerError(newLocation(source->fileID, line), "compilation error");
             continue; // line should be skipped
         }
 
         Line l;
         l.file = source;
         l.line = line;
-        l.basicIndex = int(basicIndex - bas2tap_ConvertedSpectrumLine);
-        l.lineData = bas2tap_ConvertedSpectrumLine;
+        l.basicIndex = int(basicIndex - mContext->ConvertedSpectrumLine);
+        l.lineData = mContext->ConvertedSpectrumLine;
         if (!mLines.emplace(basicLine, std::move(l)).second) {
             std::stringstream ss;
             ss << "duplicate use of line number " << basicLine << '.';
-            throw CompilerError(new (mHeap) SourceLocation(source->fileID, line), ss.str());
+            throw CompilerError(newLocation(source->fileID, line), ss.str());
         }
     }
 }
 
+void SpectrumBasicCompiler::collectFileReferences(const char* source, std::unordered_set<std::string>& names)
+{
+    for (const char* p = source; (p = strstr(p, "@{file:")) != nullptr; ) {
+        p += 7;
+        const char* pend = p;
+        while (*pend && *pend != '}' && *pend != '\n')
+            ++pend;
+        if (*pend == '}' && pend > p)
+            names.emplace(p, size_t(pend - p));
+        p = pend;
+    }
+}
+
 void SpectrumBasicCompiler::compile()
 {
     mLinesIter = mLines.cbegin();
     mBasicFile = nullptr;
     mBasicFileLine = 0;
-    if (bas2tap_main() != 0)
+    if (bas2tap_main(mContext.get()) != 0)
         throw CompilerError(mSourceLocation, "BASIC compilation failed.");
 
     if (mStartLine) {
@@ -191,7 +190,45 @@ void SpectrumBasicCompiler::compile()
     }
 }
 
-void SpectrumBasicCompiler::bas2tapError(int line, int stmt, const char* fmt, ...)
+SourceLocation* SpectrumBasicCompiler::newLocation(const FileID* file, int line)
+{
+    std::lock_guard<std::mutex> lock(heapMutex);
+    return new (mHeap) SourceLocation(file, line);
+}
+
+int SpectrumBasicCompiler::embedFile(const SourceFile* source, int line, const std::string& name)
+{
+    auto it = mEmbeddedFileIndices.find(name);
+    if (it != mEmbeddedFileIndices.end())
+        return it->second;
+
+    auto file = mOutput->getFile(name);
+    if (!file) {
+        std::stringstream ss;
+        ss << "there is no file named \"" << name << "\".";
+        throw CompilerError(newLocation(source->fileID, line), ss.str());
+    }
+
+    size_t n = file->size();
+    const CodeEmitter::Byte* fileP = file->data();
+
+    std::string data(n, 0);
+    for (size_t i = 0; i < n; ++i, ++fileP)
+        data[i] = char(fileP->value);
+
+    {
+        std::lock_guard<std::mutex> lock(heapMutex);
+        file->setUsedByBasic();
+    }
+
+    int index = int(mEmbeddedFiles.size());
+    mEmbeddedFiles.emplace_back(std::move(data));
+    mEmbeddedFileIndices.emplace(name, index);
+
+    return index;
+}
+
+void SpectrumBasicCompiler::bas2tapError(bas2tap_context* ctx, int line, int stmt, const char* fmt, ...)
 {
     char buf[1024];
     va_list args;
@@ -200,29 +237,45 @@ void SpectrumBasicCompiler::bas2tapError(int line, int stmt, const char* fmt, ..
     vsnprintf(buf, sizeof(buf), fmt, args);
     va_end(args);
 
-    auto file = (instance->mBasicFile ? instance->mBasicFile->fileID : nullptr);
-    throw CompilerError(new (instance->mHeap) SourceLocation(file, instance->mBasicFileLine), buf);
+    auto self = reinterpret_cast<SpectrumBasicCompiler*>(ctx->user);
+    auto file = (self->mBasicFile ? self->mBasicFile->fileID : nullptr);
+    throw CompilerError(self->newLocation(file, self->mBasicFileLine), buf);
 }
 
-int SpectrumBasicCompiler::bas2tapFGets(char** basicIndex, int* basicLineNo)
+int SpectrumBasicCompiler::bas2tapFGets(bas2tap_context* ctx, char** basicIndex, int* basicLineNo)
 {
-    if (instance->mLinesIter == instance->mLines.end())
+    auto self = reinterpret_cast<SpectrumBasicCompiler*>(ctx->user);
+    if (self->mLinesIter == self->mLines.end())
         return 0;
 
-    int basicLine = instance->mLinesIter->first;
-    const Line& line = instance->mLinesIter->second;
-    ++instance->mLinesIter;
+    int basicLine = self->mLinesIter->first;
+    const Line& line = self->mLinesIter->second;
+    ++self->mLinesIter;
 
-    instance->mBasicFile = line.file;
-    instance->mBasicFileLine = line.line;
-    memcpy(bas2tap_ConvertedSpectrumLine, line.lineData.c_str(), line.lineData.length() + 1);
-    *basicIndex = bas2tap_ConvertedSpectrumLine + line.basicIndex;
+    self->mBasicFile = line.file;
+    self->mBasicFileLine = line.line;
+    memcpy(ctx->ConvertedSpectrumLine, line.lineData.c_str(), line.lineData.length() + 1);
+    *basicIndex = ctx->ConvertedSpectrumLine + line.basicIndex;
     *basicLineNo = basicLine;
 
     return 1;
 }
 
-void SpectrumBasicCompiler::bas2tapOutput(const void* dst, size_t length)
+void SpectrumBasicCompiler::bas2tapOutput(bas2tap_context* ctx, const void* dst, size_t length)
 {
-    instance->mCompiledBasicStream.write(reinterpret_cast<const char*>(dst), int(length));
+    auto self = reinterpret_cast<SpectrumBasicCompiler*>(ctx->user);
+    self->mCompiledBasicStream.write(reinterpret_cast<const char*>(dst), std::streamsize(length));
+}
+
+int SpectrumBasicCompiler::bas2tapEmbed(bas2tap_context* ctx, int index, const unsigned char** data, size_t* length)
+{
+    auto self = reinterpret_cast<SpectrumBasicCompiler*>(ctx->user);
+    if (index < 0 || size_t(index) >= self->mEmbeddedFiles.size())
+        return 0;
+
+    const std::string& file = self->mEmbeddedFiles[index];
+    *data = reinterpret_cast<const unsigned char*>(file.data());
+    *length = file.length();
+
+    return 1;
 }
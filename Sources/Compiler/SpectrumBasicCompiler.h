@@ -5,8 +5,10 @@
 
 class GCHeap;
 class CompiledOutput;
+class FileID;
 class SourceLocation;
 struct SourceFile;
+struct bas2tap_context;
 
 class SpectrumBasicCompiler
 {
@@ -22,6 +24,9 @@ public:
 
     std::string compiledData() const { return mCompiledBasicStream.str(); }
 
+    // Collects names of files embedded with @{file:...}; used before linking so that they are not stripped
+    static void collectFileReferences(const char* source, std::unordered_set<std::string>& names);
+
 private:
     struct Line
     {
@@ -33,18 +38,25 @@ private:
 
     GCHeap* mHeap;
     CompiledOutput* mOutput;
+    std::unique_ptr<bas2tap_context> mContext;
     std::map<int, Line> mLines;
     std::map<int, Line>::const_iterator mLinesIter;
     std::stringstream mCompiledBasicStream;
+    std::vector<std::string> mEmbeddedFiles;
+    std::unordered_map<std::string, int> mEmbeddedFileIndices;
     const SourceFile* mBasicFile;
     SourceLocation* mSourceLocation;
     SourceLocation* mStartLineLocation;
     std::optional<int> mStartLine;
     int mBasicFileLine;
 
-    static void bas2tapError(int line, int stmt, const char* fmt, ...);
-    static int bas2tapFGets(char** basicIndex, int* basicLineNo);
-    static void bas2tapOutput(const void* dst, size_t length);
+    SourceLocation* newLocation(const FileID* file, int line);
+    int embedFile(const SourceFile* source, int line, const std::string& name);
+
+    static void bas2tapError(bas2tap_context* ctx, int line, int stmt, const char* fmt, ...);
+    static int bas2tapFGets(bas2tap_context* ctx, char** basicIndex, int* basicLineNo);
+    static void bas2tapOutput(bas2tap_context* ctx, const void* dst, size_t length);
+    static int bas2tapEmbed(bas2tap_context* ctx, int index, const unsigned char** data, size_t* length);
 
     DISABLE_COPY(SpectrumBasicCompiler);
 };
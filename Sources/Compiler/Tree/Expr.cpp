@@ -3,6 +3,7 @@
 #include "Compiler/Assembler/AssemblerContext.h"
 #include "Compiler/Linker/ISectionResolver.h"
 #include "Compiler/Tree/Symbol.h"
+#include "Compiler/Tree/SymbolReferences.h"
 #include "Compiler/CompilerError.h"
 
 class Expr::MarkAsEvaluating
@@ -202,6 +203,10 @@ bool ExprCurrentAddress::containsHereVariable() const
     return false;
 }
 
+void ExprCurrentAddress::collectReferences(SymbolReferences&) const
+{
+}
+
 void ExprCurrentAddress::toString(std::stringstream& ss) const
 {
     ss << '$';
@@ -261,6 +266,12 @@ bool ExprVariableHere::containsHereVariable() const
     return true;
 }
 
+void ExprVariableHere::collectReferences(SymbolReferences& refs) const
+{
+    if (mInitializer)
+        mInitializer->collectReferences(refs);
+}
+
 void ExprVariableHere::toString(std::stringstream& ss) const
 {
     ss << "{@here ";
@@ -307,6 +318,10 @@ bool ExprNumber::containsHereVariable() const
     return false;
 }
 
+void ExprNumber::collectReferences(SymbolReferences&) const
+{
+}
+
 void ExprNumber::toString(std::stringstream& ss) const
 {
     ss << mValue;
@@ -333,6 +348,13 @@ bool ExprIdentifier::containsHereVariable() const
     return false;
 }
 
+void ExprIdentifier::collectReferences(SymbolReferences& refs) const
+{
+    auto symbol = mSymbolTable->findSymbol(mName);
+    if (symbol && refs.symbols.emplace(symbol).second)
+        symbol->collectReferences(refs);
+}
+
 void ExprIdentifier::toString(std::stringstream& ss) const
 {
     ss << mName;
@@ -464,6 +486,13 @@ bool ExprConditional::containsHereVariable() const
         || mElse->containsHereVariable();
 }
 
+void ExprConditional::collectReferences(SymbolReferences& refs) const
+{
+    mCondition->collectReferences(refs);
+    mThen->collectReferences(refs);
+    mElse->collectReferences(refs);
+}
+
 void ExprConditional::toString(std::stringstream& ss) const
 {
     mCondition->toString(ss);
@@ -502,6 +531,11 @@ bool ExprAddressOfSection::containsHereVariable() const
     return false;
 }
 
+void ExprAddressOfSection::collectReferences(SymbolReferences& refs) const
+{
+    refs.sections.emplace(mSectionName);
+}
+
 void ExprAddressOfSection::toString(std::stringstream& ss) const
 {
     ss << "addressof(" << mSectionName << ")";
@@ -537,6 +571,11 @@ bool ExprBaseOfSection::containsHereVariable() const
     return false;
 }
 
+void ExprBaseOfSection::collectReferences(SymbolReferences& refs) const
+{
+    refs.sections.emplace(mSectionName);
+}
+
 void ExprBaseOfSection::toString(std::stringstream& ss) const
 {
     ss << "baseof(" << mSectionName << ")";
@@ -572,6 +611,11 @@ bool ExprSizeOfSection::containsHereVariable() const
     return false;
 }
 
+void ExprSizeOfSection::collectReferences(SymbolReferences& refs) const
+{
+    refs.sections.emplace(mSectionName);
+}
+
 void ExprSizeOfSection::toString(std::stringstream& ss) const
 {
     ss << "sizeof(" << mSectionName << ")";
@@ -602,6 +646,86 @@ Value ExprSizeOfSection::evaluate() const
 
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
+bool ExprBankOfSection::containsHereVariable() const
+{
+    return false;
+}
+
+void ExprBankOfSection::collectReferences(SymbolReferences& refs) const
+{
+    refs.sections.emplace(mSectionName);
+}
+
+void ExprBankOfSection::toString(std::stringstream& ss) const
+{
+    ss << "bankof(" << mSectionName << ")";
+}
+
+void ExprBankOfSection::replaceCurrentAddressWithLabel(AssemblerContext* context)
+{
+}
+
+bool ExprBankOfSection::canEvaluate(std::unique_ptr<CompilerError>& resolveError) const
+{
+    uint64_t value = 0;
+    if (!mSectionResolver || !mSectionResolver->tryResolveSectionBank(location(), mSectionName, value)) {
+        resolveError = std::make_unique<CompilerError>(location(),
+            "section bank is not available in this context.");
+        return false;
+    }
+    return true;
+}
+
+Value ExprBankOfSection::evaluate() const
+{
+    uint64_t value = 0;
+    if (!mSectionResolver || !mSectionResolver->tryResolveSectionBank(location(), mSectionName, value))
+        throw CompilerError(location(), "section bank is not available in this context.");
+    return Value(value);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+bool ExprCompressionOfSection::containsHereVariable() const
+{
+    return false;
+}
+
+void ExprCompressionOfSection::collectReferences(SymbolReferences&) const
+{
+    // Compression of a stripped section evaluates to zero, so it should not keep the section alive
+}
+
+void ExprCompressionOfSection::toString(std::stringstream& ss) const
+{
+    ss << "compressionof(" << mSectionName << ")";
+}
+
+void ExprCompressionOfSection::replaceCurrentAddressWithLabel(AssemblerContext* context)
+{
+}
+
+bool ExprCompressionOfSection::canEvaluate(std::unique_ptr<CompilerError>& resolveError) const
+{
+    uint64_t value = 0;
+    if (!mSectionResolver || !mSectionResolver->tryResolveSectionCompression(location(), mSectionName, value)) {
+        resolveError = std::make_unique<CompilerError>(location(),
+            "section compression is not available in this context.");
+        return false;
+    }
+    return true;
+}
+
+Value ExprCompressionOfSection::evaluate() const
+{
+    uint64_t value = 0;
+    if (!mSectionResolver || !mSectionResolver->tryResolveSectionCompression(location(), mSectionName, value))
+        throw CompilerError(location(), "section compression is not available in this context.");
+    return Value(value);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
 bool ExprNegate::isNegate() const
 {
     return true;
@@ -612,6 +736,11 @@ bool ExprNegate::containsHereVariable() const
     return mOperand->containsHereVariable();
 }
 
+void ExprNegate::collectReferences(SymbolReferences& refs) const
+{
+    mOperand->collectReferences(refs);
+}
+
 void ExprNegate::toString(std::stringstream& ss) const
 {
     ss << '-';
@@ -670,6 +799,11 @@ bool ExprBitwiseNot::containsHereVariable() const
     return mOperand->containsHereVariable();
 }
 
+void ExprBitwiseNot::collectReferences(SymbolReferences& refs) const
+{
+    mOperand->collectReferences(refs);
+}
+
 void ExprBitwiseNot::toString(std::stringstream& ss) const
 {
     ss << '~';
@@ -701,6 +835,11 @@ bool ExprLogicNot::containsHereVariable() const
     return mOperand->containsHereVariable();
 }
 
+void ExprLogicNot::collectReferences(SymbolReferences& refs) const
+{
+    mOperand->collectReferences(refs);
+}
+
 void ExprLogicNot::toString(std::stringstream& ss) const
 {
     ss << '!';
@@ -731,6 +870,12 @@ bool ExprAdd::containsHereVariable() const
         || mOperand2->containsHereVariable();
 }
 
+void ExprAdd::collectReferences(SymbolReferences& refs) const
+{
+    mOperand1->collectReferences(refs);
+    mOperand2->collectReferences(refs);
+}
+
 void ExprAdd::toString(std::stringstream& ss) const
 {
     mOperand1->toString(ss);
@@ -765,6 +910,12 @@ bool ExprSubtract::containsHereVariable() const
         || mOperand2->containsHereVariable();
 }
 
+void ExprSubtract::collectReferences(SymbolReferences& refs) const
+{
+    mOperand1->collectReferences(refs);
+    mOperand2->collectReferences(refs);
+}
+
 void ExprSubtract::toString(std::stringstream& ss) const
 {
     mOperand1->toString(ss);
@@ -799,6 +950,12 @@ bool ExprMultiply::containsHereVariable() const
         || mOperand2->containsHereVariable();
 }
 
+void ExprMultiply::collectReferences(SymbolReferences& refs) const
+{
+    mOperand1->collectReferences(refs);
+    mOperand2->collectReferences(refs);
+}
+
 void ExprMultiply::toString(std::stringstream& ss) const
 {
     mOperand1->toString(ss);
@@ -833,6 +990,12 @@ bool ExprDivide::containsHereVariable() const
         || mOperand2->containsHereVariable();
 }
 
+void ExprDivide::collectReferences(SymbolReferences& refs) const
+{
+    mOperand1->collectReferences(refs);
+    mOperand2->collectReferences(refs);
+}
+
 void ExprDivide::toString(std::stringstream& ss) const
 {
     mOperand1->toString(ss);
@@ -867,6 +1030,12 @@ bool ExprModulo::containsHereVariable() const
         || mOperand2->containsHereVariable();
 }
 
+void ExprModulo::collectReferences(SymbolReferences& refs) const
+{
+    mOperand1->collectReferences(refs);
+    mOperand2->collectReferences(refs);
+}
+
 void ExprModulo::toString(std::stringstream& ss) const
 {
     mOperand1->toString(ss);
@@ -901,6 +1070,12 @@ bool ExprShiftLeft::containsHereVariable() const
         || mOperand2->containsHereVariable();
 }
 
+void ExprShiftLeft::collectReferences(SymbolReferences& refs) const
+{
+    mOperand1->collectReferences(refs);
+    mOperand2->collectReferences(refs);
+}
+
 void ExprShiftLeft::toString(std::stringstream& ss) const
 {
     mOperand1->toString(ss);
@@ -948,6 +1123,12 @@ bool ExprShiftRight::containsHereVariable() const
         || mOperand2->containsHereVariable();
 }
 
+void ExprShiftRight::collectReferences(SymbolReferences& refs) const
+{
+    mOperand1->collectReferences(refs);
+    mOperand2->collectReferences(refs);
+}
+
 void ExprShiftRight::toString(std::stringstream& ss) const
 {
     mOperand1->toString(ss);
@@ -995,6 +1176,12 @@ bool ExprLess::containsHereVariable() const
         || mOperand2->containsHereVariable();
 }
 
+void ExprLess::collectReferences(SymbolReferences& refs) const
+{
+    mOperand1->collectReferences(refs);
+    mOperand2->collectReferences(refs);
+}
+
 void ExprLess::toString(std::stringstream& ss) const
 {
     mOperand1->toString(ss);
@@ -1029,6 +1216,12 @@ bool ExprLessEqual::containsHereVariable() const
         || mOperand2->containsHereVariable();
 }
 
+void ExprLessEqual::collectReferences(SymbolReferences& refs) const
+{
+    mOperand1->collectReferences(refs);
+    mOperand2->collectReferences(refs);
+}
+
 void ExprLessEqual::toString(std::stringstream& ss) const
 {
     mOperand1->toString(ss);
@@ -1063,6 +1256,12 @@ bool ExprGreater::containsHereVariable() const
         || mOperand2->containsHereVariable();
 }
 
+void ExprGreater::collectReferences(SymbolReferences& refs) const
+{
+    mOperand1->collectReferences(refs);
+    mOperand2->collectReferences(refs);
+}
+
 void ExprGreater::toString(std::stringstream& ss) const
 {
     mOperand1->toString(ss);
@@ -1097,6 +1296,12 @@ bool ExprGreaterEqual::containsHereVariable() const
         || mOperand2->containsHereVariable();
 }
 
+void ExprGreaterEqual::collectReferences(SymbolReferences& refs) const
+{
+    mOperand1->collectReferences(refs);
+    mOperand2->collectReferences(refs);
+}
+
 void ExprGreaterEqual::toString(std::stringstream& ss) const
 {
     mOperand1->toString(ss);
@@ -1131,6 +1336,12 @@ bool ExprEqual::containsHereVariable() const
         || mOperand2->containsHereVariable();
 }
 
+void ExprEqual::collectReferences(SymbolReferences& refs) const
+{
+    mOperand1->collectReferences(refs);
+    mOperand2->collectReferences(refs);
+}
+
 void ExprEqual::toString(std::stringstream& ss) const
 {
     mOperand1->toString(ss);
@@ -1165,6 +1376,12 @@ bool ExprNotEqual::containsHereVariable() const
         || mOperand2->containsHereVariable();
 }
 
+void ExprNotEqual::collectReferences(SymbolReferences& refs) const
+{
+    mOperand1->collectReferences(refs);
+    mOperand2->collectReferences(refs);
+}
+
 void ExprNotEqual::toString(std::stringstream& ss) const
 {
     mOperand1->toString(ss);
@@ -1199,6 +1416,12 @@ bool ExprBitwiseAnd::containsHereVariable() const
         || mOperand2->containsHereVariable();
 }
 
+void ExprBitwiseAnd::collectReferences(SymbolReferences& refs) const
+{
+    mOperand1->collectReferences(refs);
+    mOperand2->collectReferences(refs);
+}
+
 void ExprBitwiseAnd::toString(std::stringstream& ss) const
 {
     mOperand1->toString(ss);
@@ -1235,6 +1458,12 @@ bool ExprBitwiseOr::containsHereVariable() const
         || mOperand2->containsHereVariable();
 }
 
+void ExprBitwiseOr::collectReferences(SymbolReferences& refs) const
+{
+    mOperand1->collectReferences(refs);
+    mOperand2->collectReferences(refs);
+}
+
 void ExprBitwiseOr::toString(std::stringstream& ss) const
 {
     mOperand1->toString(ss);
@@ -1271,6 +1500,12 @@ bool ExprBitwiseXor::containsHereVariable() const
         || mOperand2->containsHereVariable();
 }
 
+void ExprBitwiseXor::collectReferences(SymbolReferences& refs) const
+{
+    mOperand1->collectReferences(refs);
+    mOperand2->collectReferences(refs);
+}
+
 void ExprBitwiseXor::toString(std::stringstream& ss) const
 {
     mOperand1->toString(ss);
@@ -1307,6 +1542,12 @@ bool ExprLogicAnd::containsHereVariable() const
         || mOperand2->containsHereVariable();
 }
 
+void ExprLogicAnd::collectReferences(SymbolReferences& refs) const
+{
+    mOperand1->collectReferences(refs);
+    mOperand2->collectReferences(refs);
+}
+
 void ExprLogicAnd::toString(std::stringstream& ss) const
 {
     mOperand1->toString(ss);
@@ -1341,6 +1582,12 @@ bool ExprLogicOr::containsHereVariable() const
         || mOperand2->containsHereVariable();
 }
 
+void ExprLogicOr::collectReferences(SymbolReferences& refs) const
+{
+    mOperand1->collectReferences(refs);
+    mOperand2->collectReferences(refs);
+}
+
 void ExprLogicOr::toString(std::stringstream& ss) const
 {
     mOperand1->toString(ss);
@@ -12,6 +12,7 @@ class AssemblerContext;
 class Label;
 class CompilerError;
 class ISectionResolver;
+struct SymbolReferences;
 
 ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
@@ -26,6 +27,7 @@ public:
 
     virtual bool isHereVariable() const;
     virtual bool containsHereVariable() const = 0;
+    virtual void collectReferences(SymbolReferences& refs) const = 0;
 
     virtual void toString(std::stringstream& ss) const = 0;
 
@@ -73,6 +75,7 @@ public:
     }
 
     bool containsHereVariable() const override;
+    void collectReferences(SymbolReferences& refs) const override;
 
     void toString(std::stringstream& ss) const override;
 
@@ -103,6 +106,7 @@ public:
 
     bool isHereVariable() const override;
     bool containsHereVariable() const override;
+    void collectReferences(SymbolReferences& refs) const override;
 
     void toString(std::stringstream& ss) const override;
 
@@ -130,6 +134,7 @@ public:
     }
 
     bool containsHereVariable() const override;
+    void collectReferences(SymbolReferences& refs) const override;
 
     void toString(std::stringstream& ss) const override;
 
@@ -157,7 +162,10 @@ public:
         registerFinalizer();
     }
 
+    const std::string& name() const { return mName; }
+
     bool containsHereVariable() const override;
+    void collectReferences(SymbolReferences& refs) const override;
 
     void toString(std::stringstream& ss) const override;
 
@@ -187,6 +195,7 @@ public:
     }
 
     bool containsHereVariable() const override;
+    void collectReferences(SymbolReferences& refs) const override;
 
     void toString(std::stringstream& ss) const override;
 
@@ -216,6 +225,7 @@ private:
         } \
         const char* sectionName() const noexcept { return mSectionName; } \
         bool containsHereVariable() const override; \
+        void collectReferences(SymbolReferences& refs) const override; \
         void toString(std::stringstream& ss) const override; \
         void replaceCurrentAddressWithLabel(AssemblerContext* context) override; \
     private: \
@@ -228,6 +238,8 @@ private:
 TREE_SECTION_OPERATOR(AddressOfSection);
 TREE_SECTION_OPERATOR(BaseOfSection);
 TREE_SECTION_OPERATOR(SizeOfSection);
+TREE_SECTION_OPERATOR(BankOfSection);
+TREE_SECTION_OPERATOR(CompressionOfSection);
 
 ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
@@ -242,6 +254,7 @@ TREE_SECTION_OPERATOR(SizeOfSection);
         } \
         Expr* operand() const noexcept { return mOperand; } \
         bool containsHereVariable() const override; \
+        void collectReferences(SymbolReferences& refs) const override; \
         void toString(std::stringstream& ss) const override; \
         void replaceCurrentAddressWithLabel(AssemblerContext* context) override; \
     private: \
@@ -262,6 +275,7 @@ TREE_SECTION_OPERATOR(SizeOfSection);
         { \
         } \
         bool containsHereVariable() const override; \
+        void collectReferences(SymbolReferences& refs) const override; \
         void toString(std::stringstream& ss) const override; \
         void replaceCurrentAddressWithLabel(AssemblerContext* context) override; \
     private: \
@@ -283,6 +297,7 @@ public:
 
     bool isNegate() const override;
     bool containsHereVariable() const override;
+    void collectReferences(SymbolReferences& refs) const override;
 
     Expr* operand() const noexcept { return mOperand; }
 
@@ -6,19 +6,23 @@
 class FileID : public GCObject
 {
 public:
-    FileID(std::filesystem::path name, std::filesystem::path path)
+    // Generated code (decompressors, turbo loader) has no source file; path refers to the project file
+    FileID(std::filesystem::path name, std::filesystem::path path, bool generated = false)
         : mName(std::move(name))
         , mPath(std::move(path))
+        , mGenerated(generated)
     {
         registerFinalizer();
     }
 
     const std::filesystem::path& name() const { return mName; }
     const std::filesystem::path& path() const { return mPath; }
+    bool isGenerated() const { return mGenerated; }
 
 private:
     std::filesystem::path mName;
     std::filesystem::path mPath;
+    bool mGenerated;
 
     DISABLE_COPY(FileID);
 };
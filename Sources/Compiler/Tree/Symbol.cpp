@@ -2,6 +2,7 @@
 #include "Compiler/CompilerError.h"
 #include "Compiler/Assembler/Label.h"
 #include "Compiler/Tree/Expr.h"
+#include "Compiler/Tree/SymbolReferences.h"
 
 ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
@@ -10,6 +11,11 @@ Symbol::Type ConstantSymbol::type() const
     return Constant;
 }
 
+void ConstantSymbol::collectReferences(SymbolReferences& refs) const
+{
+    mValue->collectReferences(refs);
+}
+
 ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
 Symbol::Type ConditionalConstantSymbol::type() const
@@ -17,6 +23,14 @@ Symbol::Type ConditionalConstantSymbol::type() const
     return ConditionalConstant;
 }
 
+void ConditionalConstantSymbol::collectReferences(SymbolReferences& refs) const
+{
+    for (const auto& entry : mEntries) {
+        entry.condition->collectReferences(refs);
+        entry.value->collectReferences(refs);
+    }
+}
+
 void ConditionalConstantSymbol::addValue(Expr* condition, Expr* value)
 {
     Entry entry;
@@ -73,6 +87,11 @@ Symbol::Type LabelSymbol::type() const
     return Label;
 }
 
+void LabelSymbol::collectReferences(SymbolReferences& refs) const
+{
+    refs.labels.emplace(mLabel);
+}
+
 ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
 Symbol::Type ConditionalLabelSymbol::type() const
@@ -80,6 +99,14 @@ Symbol::Type ConditionalLabelSymbol::type() const
     return ConditionalLabel;
 }
 
+void ConditionalLabelSymbol::collectReferences(SymbolReferences& refs) const
+{
+    for (const auto& entry : mEntries) {
+        entry.condition->collectReferences(refs);
+        refs.labels.emplace(entry.label);
+    }
+}
+
 void ConditionalLabelSymbol::addLabel(Expr* condition, ::Label* label)
 {
     Entry entry;
@@ -139,3 +166,7 @@ Symbol::Type RepeatVariableSymbol::type() const
 {
     return RepeatVariable;
 }
+
+void RepeatVariableSymbol::collectReferences(SymbolReferences&) const
+{
+}
@@ -10,6 +10,7 @@ class Value;
 class ProgramSection;
 class CompilerError;
 class ISectionResolver;
+struct SymbolReferences;
 
 ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
@@ -35,6 +36,7 @@ public:
     const char* name() const { return mName; }
 
     virtual Type type() const = 0;
+    virtual void collectReferences(SymbolReferences& refs) const = 0;
 
 private:
     SourceLocation* mLocation;
@@ -55,6 +57,7 @@ public:
     }
 
     Type type() const final override;
+    void collectReferences(SymbolReferences& refs) const final override;
 
     const Expr* value() const { return mValue; }
 
@@ -77,6 +80,7 @@ public:
     }
 
     Type type() const final override;
+    void collectReferences(SymbolReferences& refs) const final override;
     ProgramSection* section() const { return mSection; }
 
     void addValue(Expr* condition, Expr* value);
@@ -106,6 +110,7 @@ public:
     LabelSymbol(SourceLocation* location, ::Label* label);
 
     Type type() const final override;
+    void collectReferences(SymbolReferences& refs) const final override;
 
     ::Label* label() const { return mLabel; }
 
@@ -127,6 +132,7 @@ public:
     }
 
     Type type() const final override;
+    void collectReferences(SymbolReferences& refs) const final override;
 
     void addLabel(Expr* condition, ::Label* label);
 
@@ -154,6 +160,7 @@ public:
     RepeatVariableSymbol(SourceLocation* location, const char* name, Value* value);
 
     Type type() const final override;
+    void collectReferences(SymbolReferences& refs) const final override;
 
     Value* value() const { return mValue; }
 
@@ -0,0 +1,17 @@
+#ifndef COMPILER_TREE_SYMBOLREFERENCES_H
+#define COMPILER_TREE_SYMBOLREFERENCES_H
+
+#include "Common/Common.h"
+
+class Symbol;
+class Label;
+
+struct SymbolReferences
+{
+    std::unordered_set<const Symbol*> symbols;
+    std::unordered_set<const Label*> labels;
+    std::unordered_set<std::string> sections;
+    std::unordered_set<const Label*> definedLabels;
+};
+
+#endif
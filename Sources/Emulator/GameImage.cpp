@@ -0,0 +1,82 @@
+#include "GameImage.h"
+#include "Emulator/Snapshot.h"
+#include "Emulator/Z80Memory.h"
+
+static uint32_t readDWordLE(const uint8_t* p)
+{
+    return uint32_t(p[0]) | (uint32_t(p[1]) << 8) | (uint32_t(p[2]) << 16) | (uint32_t(p[3]) << 24);
+}
+
+static size_t readLength(const uint8_t*& src, const uint8_t* end, size_t length)
+{
+    if (length == 15) {
+        uint8_t byte;
+        do {
+            if (src == end)
+                throw std::runtime_error("Unexpected end of game data.");
+            byte = *src++;
+            length += byte;
+        } while (byte == 255);
+    }
+    return length;
+}
+
+void decompressLz4(const uint8_t* src, size_t srcSize, uint8_t* dst, size_t dstSize)
+{
+    const uint8_t* end = src + srcSize;
+    size_t out = 0;
+
+    while (src != end) {
+        uint8_t token = *src++;
+
+        size_t literals = readLength(src, end, token >> 4);
+        if (literals > size_t(end - src) || literals > dstSize - out)
+            throw std::runtime_error("Invalid game data.");
+        memcpy(dst + out, src, literals);
+        src += literals;
+        out += literals;
+
+        // Last sequence has no match
+        if (src == end)
+            break;
+
+        if (end - src < 2)
+            throw std::runtime_error("Unexpected end of game data.");
+        size_t offset = src[0] | (src[1] << 8);
+        src += 2;
+
+        size_t length = readLength(src, end, token & 15) + 4;
+        if (offset == 0 || offset > out || length > dstSize - out)
+            throw std::runtime_error("Invalid game data.");
+
+        // Source and destination may overlap
+        for (; length > 0; --length, ++out)
+            dst[out] = dst[out - offset];
+    }
+
+    if (out != dstSize)
+        throw std::runtime_error("Invalid game data.");
+}
+
+bool loadGameImage(FILE* f, SnapshotState& state, uint8_t* memory)
+{
+    uint8_t trailer[16];
+    if (fseek(f, -long(sizeof(trailer)), SEEK_END) != 0 || fread(trailer, 1, sizeof(trailer), f) != sizeof(trailer))
+        return false;
+    if (memcmp(&trailer[8], "GAMEDATA", 8) != 0)
+        return false;
+
+    uint32_t offset = readDWordLE(&trailer[0]);
+    uint32_t compressedSize = readDWordLE(&trailer[4]);
+    if (compressedSize > 2 * Z80Memory::BankCount * Z80Memory::BankSize)
+        throw std::runtime_error("Invalid game data.");
+
+    std::unique_ptr<uint8_t[]> compressed{new uint8_t[compressedSize]};
+    if (fseek(f, long(offset), SEEK_SET) != 0
+            || fread(&state, 1, sizeof(state), f) != sizeof(state)
+            || fread(compressed.get(), 1, compressedSize, f) != compressedSize)
+        throw std::runtime_error("Unable to read game data.");
+
+    decompressLz4(compressed.get(), compressedSize, memory, Z80Memory::BankCount * Z80Memory::BankSize);
+    return true;
+}
@@ -0,0 +1,17 @@
+#ifndef EMULATOR_GAMEIMAGE_H
+#define EMULATOR_GAMEIMAGE_H
+
+#include "Emulator/Common.h"
+
+/*
+ * Compiler appends machine state and LZ4-compressed memory to the runtime executable. Last 16 bytes
+ * of the file are the trailer: file offset of SnapshotState (uint32 LE), size of compressed memory
+ * (uint32 LE) and "GAMEDATA". Compressed memory immediately follows the state.
+ */
+
+// Returns false if file has no game data
+bool loadGameImage(FILE* f, SnapshotState& state, uint8_t* memory);
+
+void decompressLz4(const uint8_t* src, size_t srcSize, uint8_t* dst, size_t dstSize);
+
+#endif
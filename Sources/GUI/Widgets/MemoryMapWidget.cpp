@@ -23,9 +23,11 @@ MemoryMapWidget::MemoryMapWidget(QWidget* parent)
     setWordWrap(false);
     setExpandsOnDoubleClick(true);
 
-    setColumnCount(2);
+    setColumnCount(4);
     setColumnWidth(0, 350);
-    setHeaderItem(new QTreeWidgetItem(QStringList() << tr("Name") << tr("Address")));
+    setColumnWidth(1, 400);
+    setColumnWidth(2, 400);
+    setHeaderItem(new QTreeWidgetItem(QStringList() << tr("Name") << tr("Address") << tr("T-states") << tr("Memory")));
 
     auto hdr = header();
     hdr->setVisible(true);
@@ -61,6 +63,18 @@ static QString makeRange(uint64_t start, int64_t uncompressedSize, std::optional
         .arg(sizeString);
 }
 
+static QString makeAddress(int64_t address)
+{
+    return QStringLiteral("0x%1/%2")
+        .arg(QStringLiteral("%1").arg(address, 4, 16, QChar('0')).toUpper())
+        .arg(address, -5, 10, QChar(' '));
+}
+
+static QString makeTStates(const DebugInformation::TStates& tStates)
+{
+    return fromUtf8(DebugInformation::tStatesToString(tStates));
+}
+
 void MemoryMapWidget::setData(CompiledOutput* linkerOutput)
 {
     clear();
@@ -81,10 +95,32 @@ void MemoryMapWidget::setData(CompiledOutput* linkerOutput)
             if (section.compression != Compression::None)
                 compressedSize = section.compressedSize;
 
-            QTreeWidgetItem* sectionItem = new QTreeWidgetItem(fileItem, QStringList()
-                << fromUtf8(section.name)
-                << makeRange(section.startAddress, section.uncompressedSize, compressedSize));
-            (void)sectionItem;
+            const DebugInformation::MemoryRegion* region = nullptr;
+            for (const auto& it : debugInfo->memoryRegions()) {
+                if (it.name == section.name) {
+                    region = &it;
+                    break;
+                }
+            }
+
+            QStringList columns;
+            columns << fromUtf8(section.name);
+            columns << makeRange(section.startAddress, section.uncompressedSize, compressedSize);
+            columns << (section.timing ? makeTStates(section.timing->tStates) : QString());
+            if (region)
+                columns << fromUtf8(DebugInformation::contentionToString(*region));
+
+            QTreeWidgetItem* sectionItem = new QTreeWidgetItem(fileItem, columns);
+            if (region && region->uncontendedRequired && region->contendedBytes != 0) {
+                sectionItem->setForeground(3, Qt::red);
+                sectionItem->setToolTip(3, tr("Section requested uncontended memory but was placed in contended memory."));
+            }
+            if (section.timing) {
+                for (const auto& label : section.timing->labels) {
+                    new QTreeWidgetItem(sectionItem, QStringList()
+                        << fromUtf8(label.name) << makeAddress(label.address) << makeTStates(label.tStates));
+                }
+            }
         }
     }
 }
@@ -1,6 +1,7 @@
 // SDL2 runtime uses different MSVC runtime so we have to recompile emulator code separately. Use Unity build here.
 
 #include "Emulator/Emulator.cpp"
+#include "Emulator/GameImage.cpp"
 #include "Emulator/Z80Cpu.cpp"
 #include "Emulator/Z80Memory.cpp"
 #include "Emulator/Z80Screen.cpp"
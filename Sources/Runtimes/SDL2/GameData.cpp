@@ -1,5 +1,53 @@
 #include "GameData.h"
+#include "Emulator/GameImage.h"
 #include "Emulator/Snapshot.h"
 
-SnapshotState initState = { 'R', 'E', 'G', 'I', 'S', 'T', 'E', 'R', 'S', '\x1A', '\x1A' };
-uint8_t initMemory[Z80Memory::BankCount * Z80Memory::BankSize] = {'M','E','M','O','R','Y','\x1A','\x1A'};
+#ifdef __APPLE__
+ #include <limits.h>
+ #include <mach-o/dyld.h>
+#endif
+
+SnapshotState initState;
+uint8_t initMemory[Z80Memory::BankCount * Z80Memory::BankSize];
+
+static FILE* openExecutable(const char* argv0)
+{
+  #if defined(_WIN32)
+    (void)argv0;
+    wchar_t path[MAX_PATH];
+    DWORD length = GetModuleFileNameW(nullptr, path, MAX_PATH);
+    if (length == 0 || length >= MAX_PATH)
+        return nullptr;
+    return _wfopen(path, L"rb");
+  #elif defined(__APPLE__)
+    char path[PATH_MAX];
+    uint32_t size = sizeof(path);
+    if (_NSGetExecutablePath(path, &size) != 0)
+        return (argv0 ? fopen(argv0, "rb") : nullptr);
+    return fopen(path, "rb");
+  #elif defined(__linux__)
+    FILE* f = fopen("/proc/self/exe", "rb");
+    if (!f && argv0)
+        f = fopen(argv0, "rb");
+    return f;
+  #else
+    return (argv0 ? fopen(argv0, "rb") : nullptr);
+  #endif
+}
+
+void loadGameData(const char* argv0)
+{
+    FILE* f = openExecutable(argv0);
+    if (!f)
+        throw std::runtime_error("Unable to open executable file.");
+
+    try {
+        if (!loadGameImage(f, initState, initMemory))
+            throw std::runtime_error("Game data is missing in the executable file.");
+    } catch (...) {
+        fclose(f);
+        throw;
+    }
+
+    fclose(f);
+}
@@ -7,4 +7,6 @@
 extern SnapshotState initState;
 extern uint8_t initMemory[Z80Memory::BankCount * Z80Memory::BankSize];
 
+void loadGameData(const char* argv0);
+
 #endif
@@ -45,14 +45,23 @@ int main(int argc, char** argv)
   #ifdef __EMSCRIPTEN__
     emscripten_set_main_loop(runFrame, 0, TRUE);
   #else
-   #ifndef NDEBUG
-    for (int i = 1; i < argc; i++) {
-        if (argv[i][0] != '-') {
-            loadSnapshot(argv[i], initState, initMemory);
-            break;
+    try {
+        bool loaded = false;
+       #ifndef NDEBUG
+        for (int i = 1; i < argc; i++) {
+            if (argv[i][0] != '-') {
+                loadSnapshot(argv[i], initState, initMemory);
+                loaded = true;
+                break;
+            }
         }
+       #endif
+
+        if (!loaded)
+            loadGameData(argc > 0 ? argv[0] : nullptr);
+    } catch (const std::exception& e) {
+        error(e.what());
     }
-   #endif
 
     for (;;)
         runFrame();
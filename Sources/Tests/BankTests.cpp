@@ -0,0 +1,124 @@
+#include "Tests/Common.h"
+
+static const char source[] =
+    "#section code\n"
+    "ld a, bankof(level)\n"
+    "ret\n"
+    "#section big1\n"
+    "#repeat 10000\n"
+    "nop\n"
+    "#endrepeat\n"
+    "#section big2\n"
+    "#repeat 10000\n"
+    "nop\n"
+    "#endrepeat\n"
+    "#section helper\n"
+    "#repeat 5000\n"
+    "nop\n"
+    "#endrepeat\n"
+    "#section level\n"
+    "#repeat 5000\n"
+    "nop\n"
+    "#endrepeat\n"
+    "#section small\n"
+    "#repeat 100\n"
+    "nop\n"
+    "#endrepeat\n"
+    ;
+
+TEST_CASE("sections packed into banks", "[banks]")
+{
+    static const char bank3[] =
+        "bank 3\n"
+        "section helper at 0xC000..0xD387: 5000 bytes, contended\n"
+        "section level at 0xD388..0xE70F: 5000 bytes, contended\n"
+        "contended: 10000 of 10000 bytes\n"
+        ;
+
+    ErrorConsumer errorConsumer;
+    DataBlob actual = assembleWithProject(errorConsumer, "BanksProject.xml", source);
+    REQUIRE(errorConsumer.errorMessage() == "");
+    REQUIRE(actual.numFiles() == 3);
+    REQUIRE(actual.fileData("BANK0").data().size() == 10100);
+    REQUIRE(actual.fileData("BANK0").loadAddress() == 0xc000);
+    REQUIRE(actual.fileData("BANK1").data().size() == 10000);
+    REQUIRE(actual.fileData("BANK3").memoryMap() == bank3);
+}
+
+TEST_CASE("bank table and bankof", "[banks]")
+{
+    static const unsigned char binary[] = {
+        0x3e, 0x03,             // ld a, bankof(level)
+        0xc9,                   // ret
+        0x00,                   // bank_table: big1
+        0x01,                   // big2
+        0x03,                   // helper
+        0x03,                   // level
+        0x00,                   // small
+        };
+
+    ErrorConsumer errorConsumer;
+    DataBlob actual = assembleWithProject(errorConsumer, "BanksProject.xml", source);
+    DataBlob expected(binary, sizeof(binary));
+    REQUIRE(errorConsumer.errorMessage() == "");
+    REQUIRE(actual == expected);
+}
+
+TEST_CASE("sections do not fit into banks", "[banks]")
+{
+    ErrorConsumer errorConsumer;
+    DataBlob actual = assembleWithProject(errorConsumer, "BanksOverflowProject.xml", source);
+    REQUIRE(errorConsumer.errorMessage() == "not enough memory in banks to place section \"big2\".");
+}
+
+static const char uncontendedSource[] =
+    "#section big1\n"
+    "#repeat 10000\n"
+    "nop\n"
+    "#endrepeat\n"
+    "#section fast\n"
+    "#repeat 100\n"
+    "nop\n"
+    "#endrepeat\n"
+    "#section caller\n"
+    "call callee\n"
+    "#repeat 5000\n"
+    "nop\n"
+    "#endrepeat\n"
+    "#section callee\n"
+    "callee:\n"
+    "#repeat 5000\n"
+    "nop\n"
+    "#endrepeat\n"
+    ;
+
+TEST_CASE("uncontended sections and callers are packed together", "[banks]")
+{
+    static const char bank1[] =
+        "bank 1\n"
+        "section caller at 0xC000..0xD38A: 5003 bytes, contended\n"
+        "section callee at 0xD38B..0xE712: 5000 bytes, contended\n"
+        "contended: 10003 of 10003 bytes\n"
+        ;
+
+    static const char bank2[] =
+        "bank 2\n"
+        "section big1 at 0xC000..0xE70F: 10000 bytes, uncontended\n"
+        "section fast at 0xE710..0xE773: 100 bytes, uncontended\n"
+        "contended: 0 of 10100 bytes\n"
+        ;
+
+    ErrorConsumer errorConsumer;
+    DataBlob actual = assembleWithProject(errorConsumer, "BanksUncontendedProject.xml", uncontendedSource);
+    REQUIRE(errorConsumer.errorMessage() == "");
+    REQUIRE(actual.numFiles() == 2);
+    REQUIRE(actual.fileData("BANK1").memoryMap() == bank1);
+    REQUIRE(actual.fileData("BANK2").memoryMap() == bank2);
+}
+
+TEST_CASE("uncontended section without uncontended bank", "[banks]")
+{
+    ErrorConsumer errorConsumer;
+    DataBlob actual = assembleWithProject(errorConsumer, "BanksContendedProject.xml", uncontendedSource);
+    REQUIRE(errorConsumer.errorMessage() == "not enough uncontended memory in banks to place section \"fast\".");
+}
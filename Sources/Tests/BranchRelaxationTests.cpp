@@ -0,0 +1,263 @@
+#include "Tests/Common.h"
+
+TEST_CASE("jmp backward within range", "[jmp]")
+{
+    static const char source[] =
+        "#section main_0x100\n"
+        "loop:\n"
+        "nop\n"
+        "jmp loop\n"
+        ;
+
+    static const unsigned char binary[] = {
+        0x00,
+        0x18,
+        0xfd,
+        };
+
+    ErrorConsumer errorConsumer;
+    DataBlob actual = assemble(errorConsumer, source);
+    DataBlob expected(binary, sizeof(binary));
+    REQUIRE(errorConsumer.errorMessage() == "");
+    REQUIRE(actual == expected);
+}
+
+TEST_CASE("jmp conditional forward", "[jmp]")
+{
+    static const char source[] =
+        "#section main_0x100\n"
+        "jmp nz, done\n"
+        "nop\n"
+        "done:\n"
+        "ret\n"
+        ;
+
+    static const unsigned char binary[] = {
+        0x20,
+        0x01,
+        0x00,
+        0xc9,
+        };
+
+    ErrorConsumer errorConsumer;
+    DataBlob actual = assemble(errorConsumer, source);
+    DataBlob expected(binary, sizeof(binary));
+    REQUIRE(errorConsumer.errorMessage() == "");
+    REQUIRE(actual == expected);
+}
+
+TEST_CASE("jmp out of range", "[jmp]")
+{
+    static const char source[] =
+        "#section main_0x100\n"
+        "jmp c, far\n"
+        "defs 200\n"
+        "far:\n"
+        "ret\n"
+        ;
+
+    std::vector<uint8_t> binary = { 0xda, 0xcb, 0x01 };
+    binary.resize(binary.size() + 200, 0);
+    binary.emplace_back(0xc9);
+
+    ErrorConsumer errorConsumer;
+    DataBlob actual = assemble(errorConsumer, source);
+    DataBlob expected(binary.data(), binary.size());
+    REQUIRE(errorConsumer.errorMessage() == "");
+    REQUIRE(actual == expected);
+}
+
+TEST_CASE("jmp converges after shrinking other jumps", "[jmp]")
+{
+    static const char source[] =
+        "#section main_0x100\n"
+        "jmp finish\n"
+        "self:\n"
+        "jmp self\n"
+        "defs 124\n"
+        "finish:\n"
+        "ret\n"
+        ;
+
+    std::vector<uint8_t> binary = { 0x18, 0x7e, 0x18, 0xfe };
+    binary.resize(binary.size() + 124, 0);
+    binary.emplace_back(0xc9);
+
+    ErrorConsumer errorConsumer;
+    DataBlob actual = assemble(errorConsumer, source);
+    DataBlob expected(binary.data(), binary.size());
+    REQUIRE(errorConsumer.errorMessage() == "");
+    REQUIRE(actual == expected);
+}
+
+TEST_CASE("jmp with condition not supported by jr", "[jmp]")
+{
+    static const char source[] =
+        "#section main_0x100\n"
+        "jmp po, done\n"
+        "done:\n"
+        "ret\n"
+        ;
+
+    static const unsigned char binary[] = {
+        0xe2,
+        0x03,
+        0x01,
+        0xc9,
+        };
+
+    ErrorConsumer errorConsumer;
+    DataBlob actual = assemble(errorConsumer, source);
+    DataBlob expected(binary, sizeof(binary));
+    REQUIRE(errorConsumer.errorMessage() == "");
+    REQUIRE(actual == expected);
+}
+
+TEST_CASE("jmp to absolute address", "[jmp]")
+{
+    static const char source[] =
+        "#section main_0x100\n"
+        "jmp 0x102\n"
+        ;
+
+    static const unsigned char binary[] = {
+        0xc3,
+        0x02,
+        0x01,
+        };
+
+    ErrorConsumer errorConsumer;
+    DataBlob actual = assemble(errorConsumer, source);
+    DataBlob expected(binary, sizeof(binary));
+    REQUIRE(errorConsumer.errorMessage() == "");
+    REQUIRE(actual == expected);
+}
+
+TEST_CASE("jmp to another section", "[jmp]")
+{
+    static const char source[] =
+        "#section sec1\n"
+        "jmp other\n"
+        "#section sec1_0x1234\n"
+        "other:\n"
+        "ret\n"
+        ;
+
+    static const unsigned char binary[] = {
+        0xc3,
+        0x34,
+        0x12,
+        0xc9,
+        };
+
+    ErrorConsumer errorConsumer;
+    DataBlob actual = assemble(errorConsumer, source);
+    DataBlob expected(binary, sizeof(binary));
+    REQUIRE(errorConsumer.errorMessage() == "");
+    REQUIRE(actual == expected);
+}
+
+TEST_CASE("jmp in section resolved on later pass", "[jmp]")
+{
+    static const char source[] =
+        "#section sec1\n"
+        "start:\n"
+        "#if other > 0x1000\n"
+        "nop\n"
+        "#endif\n"
+        "jmp start\n"
+        "#section sec1_0x1234\n"
+        "other:\n"
+        "ret\n"
+        ;
+
+    static const unsigned char binary[] = {
+        0x00,
+        0x18,
+        0xfd,
+        0xc9,
+        };
+
+    ErrorConsumer errorConsumer;
+    DataBlob actual = assemble(errorConsumer, source);
+    DataBlob expected(binary, sizeof(binary));
+    REQUIRE(errorConsumer.errorMessage() == "");
+    REQUIRE(actual == expected);
+}
+
+TEST_CASE("jmp in repeat", "[jmp]")
+{
+    static const char source[] =
+        "#section main_0x100\n"
+        "start:\n"
+        "#repeat 2\n"
+        "jmp start\n"
+        "#endrepeat\n"
+        ;
+
+    static const unsigned char binary[] = {
+        0x18,
+        0xfe,
+        0x18,
+        0xfc,
+        };
+
+    ErrorConsumer errorConsumer;
+    DataBlob actual = assemble(errorConsumer, source);
+    DataBlob expected(binary, sizeof(binary));
+    REQUIRE(errorConsumer.errorMessage() == "");
+    REQUIRE(actual == expected);
+}
+
+TEST_CASE("jmp in section optimized for speed", "[jmp]")
+{
+    static const char source[] =
+        "#section speed_0x100\n"
+        "loop:\n"
+        "jmp loop\n"
+        ;
+
+    static const unsigned char binary[] = {
+        0xc3,
+        0x00,
+        0x01,
+        };
+
+    ErrorConsumer errorConsumer;
+    DataBlob actual = assemble(errorConsumer, source);
+    DataBlob expected(binary, sizeof(binary));
+    REQUIRE(errorConsumer.errorMessage() == "");
+    REQUIRE(actual == expected);
+}
+
+TEST_CASE("jmp timing", "[jmp]")
+{
+    static const char source[] =
+        "#section main_0x100\n"
+        "loop:\n"
+        "jmp nz, loop\n"
+        ;
+
+    static const char timing[] =
+        "section main_0x100 at 0x0100: 7..12 T\n"
+        "    0x0100  loop                             7..12 T\n"
+        "    0x0100  jmp nz -> jr                     7..12 T (jp: 10 T)\n"
+        ;
+
+    ErrorConsumer errorConsumer;
+    DataBlob actual = assemble(errorConsumer, source);
+    REQUIRE(errorConsumer.errorMessage() == "");
+    REQUIRE(actual.timing() == timing);
+}
+
+TEST_CASE("jmp without operands", "[jmp]")
+{
+    static const char source[] =
+        "#section main_0x100\n"
+        "jmp\n"
+        ;
+
+    ErrorConsumer errorConsumer;
+    DataBlob actual = assemble(errorConsumer, source);
+    REQUIRE(errorConsumer.errorMessage() == "source:2: invalid operands for opcode 'JMP'.");
+}
@@ -0,0 +1,67 @@
+#include "Tests/Common.h"
+#include "Compiler/Compression/Compressor.h"
+
+static const char source[] =
+    "#section inplace\n"
+    "#repeat 64\n"
+    "db 1, 2, 3, 4, 5, 6, 7, 8\n"
+    "#endrepeat\n"
+    ;
+
+static std::vector<uint8_t> uncompressedData()
+{
+    std::vector<uint8_t> data;
+    for (int i = 0; i < 64; i++) {
+        for (int j = 1; j <= 8; j++)
+            data.emplace_back(uint8_t(j));
+    }
+    return data;
+}
+
+TEST_CASE("in-place decompression layout", "[compression]")
+{
+    auto compressor = Compressor::create(nullptr, Compression::Zx0);
+    std::vector<uint8_t> compressed;
+    compressor->compress(nullptr, uncompressedData(), compressed);
+
+    ErrorConsumer errorConsumer;
+    DataBlob actual = assembleWithProject(errorConsumer, "InPlaceProject.xml", source);
+    DataBlob expected(compressed.data(), compressed.size());
+    REQUIRE(errorConsumer.errorMessage() == "");
+    REQUIRE(actual == expected);
+    REQUIRE(actual.loadAddress() + compressed.size() == 0x8000 + 512 + size_t(compressor->safeDistance()));
+}
+
+TEST_CASE("compressed data overlapping decompression target", "[compression]")
+{
+    static const char overlap[] =
+        "#section overlap\n"
+        "#repeat 64\n"
+        "db 1, 2, 3, 4, 5, 6, 7, 8\n"
+        "#endrepeat\n"
+        ;
+
+    auto compressor = Compressor::create(nullptr, Compression::Zx0);
+    std::vector<uint8_t> compressed;
+    compressor->compress(nullptr, uncompressedData(), compressed);
+
+    std::stringstream ss;
+    ss << "compressed data of section \"overlap\" in file \"OVERLAP\" overlaps its decompression target "
+          "(compressed data should end at 0x" << std::hex << std::uppercase
+       << (0x9000 + 512 + compressor->safeDistance()) << " or later).";
+
+    ErrorConsumer errorConsumer;
+    DataBlob actual = assembleWithProject(errorConsumer, "InPlaceProject.xml", overlap);
+    REQUIRE(errorConsumer.errorMessage() == ss.str());
+}
+
+TEST_CASE("compressors report safe distance", "[compression]")
+{
+    for (auto compression : { Compression::Lzsa2, Compression::Zx7, Compression::Zx0 }) {
+        auto compressor = Compressor::create(nullptr, compression);
+        std::vector<uint8_t> compressed;
+        compressor->compress(nullptr, uncompressedData(), compressed);
+        REQUIRE(compressor->safeDistance() > 0);
+        REQUIRE(compressed.size() < 512);
+    }
+}
@@ -0,0 +1,223 @@
+#include "Tests/Common.h"
+#include "Compiler/Compression/Compressor.h"
+#include "Emulator/Emulator.h"
+#include "Emulator/Z80Cpu.h"
+#include "Emulator/Z80Memory.h"
+#include "Common/IO.h"
+
+// Literal runs, short and long matches, near and far offsets
+static std::string payload()
+{
+    std::string data;
+
+    uint32_t seed = 12345;
+    for (int i = 0; i < 300; i++) {
+        seed = seed * 1103515245 + 12345;
+        data += char(seed >> 16);
+    }
+
+    static const char phrase[] = "The quick brown fox jumps over the lazy dog. ";
+    for (int i = 0; i < 20; i++) {
+        data += phrase;
+        data += char(i);
+    }
+
+    data += std::string(600, 0);
+    data += data.substr(10, 200);
+    data += std::string(30, 0x55);
+    data += data.substr(0, 20);
+
+    return data;
+}
+
+// Compresses payload with the given codec, then runs "decompress_packed" in the emulator and returns memory
+// at the base of the decompressed section
+static std::string decompress(const char* compression, const char* decompressors, const std::string& data)
+{
+    TempFile projectFile(".xml");
+    std::stringstream xml;
+    xml << "<?xml version=\"1.0\" encoding=\"utf-8\"?>\n"
+        << "<RetroProject>\n"
+        << "    <Files>\n"
+        << "        <File name=\"MAIN\">\n"
+        << "            <Section name=\"code\" base=\"0x8000\" decompressors=\"" << decompressors << "\" />\n"
+        << "            <Section name=\"packed\" base=\"0xc000\" compression=\"" << compression << "\" />\n"
+        << "        </File>\n"
+        << "    </Files>\n"
+        << "</RetroProject>\n";
+    writeFile(projectFile.path(), xml.str());
+
+    std::stringstream source;
+    source << "#section code\n"
+           << "ld hl, addressof(packed)\n"
+           << "ld de, baseof(packed)\n"
+           << "jp decompress_packed\n"
+           << "#section packed\n";
+    for (char ch : data)
+        source << "db " << unsigned(uint8_t(ch)) << '\n';
+
+    ErrorConsumer errorConsumer;
+    DataBlob actual = assembleWithProject(errorConsumer, projectFile.path().string().c_str(), source.str().c_str());
+    REQUIRE(errorConsumer.errorMessage() == "");
+    REQUIRE(actual.loadAddress() == 0x8000);
+
+    const uint16_t returnAddress = 0x7000;
+    const uint16_t stackAddress = 0x7ffe;
+
+    Emulator emulator;
+    Z80Memory* memory = emulator.memory();
+    const std::string& code = actual.data();
+    for (size_t i = 0; i < code.size(); i++)
+        memory->write(uint16_t(0x8000 + i), uint8_t(code[i]));
+    memory->write(stackAddress, uint8_t(returnAddress & 0xff));
+    memory->write(stackAddress + 1, uint8_t(returnAddress >> 8));
+
+    Z80Cpu* cpu = emulator.cpu();
+    cpu->set_sp(stackAddress);
+    cpu->set_pc(0x8000);
+
+    for (int steps = 0; cpu->get_pc() != returnAddress; steps++) {
+        REQUIRE(steps < 1000000);
+        cpu->on_step();
+    }
+
+    std::string result(data.size(), 0);
+    for (size_t i = 0; i < data.size(); i++)
+        result[i] = char(memory->read(uint16_t(0xc000 + i)));
+
+    return result;
+}
+
+TEST_CASE("small decompressor linked into designated section", "[decompressors]")
+{
+    static const char source[] =
+        "#section code\n"
+        "call decompress_zx0\n"
+        "ret\n"
+        "#section packed\n"
+        "db 1, 2, 3, 1, 2, 3\n"
+        ;
+
+    auto compressor = Compressor::create(nullptr, Compression::Zx0);
+    std::vector<uint8_t> compressed;
+    compressor->compress(nullptr, { 1, 2, 3, 1, 2, 3 }, compressed);
+
+    std::vector<uint8_t> binary = {
+        0xcd, 0x04, 0x80,       // call decompress_zx0
+        0xc9,                   // ret
+        0x01, 0xff, 0xff,       // ld bc, 0xffff
+        0xc5,                   // push bc
+        0x03,                   // inc bc
+        0x3e, 0x80,             // ld a, 0x80
+        };
+
+    ErrorConsumer errorConsumer;
+    DataBlob actual = assembleWithProject(errorConsumer, "DecompressorsProject.xml", source);
+    REQUIRE(errorConsumer.errorMessage() == "");
+    REQUIRE(actual.data().size() == 4 + 69 + compressed.size());
+    REQUIRE(actual.data().substr(0, binary.size()) == std::string(binary.begin(), binary.end()));
+    REQUIRE(actual.data().substr(4 + 69) == std::string(compressed.begin(), compressed.end()));
+}
+
+TEST_CASE("decompressor for unused codec is not linked", "[decompressors]")
+{
+    static const char source[] =
+        "#section code\n"
+        "call decompress_zx7\n"
+        "#section packed\n"
+        "db 1, 2, 3\n"
+        ;
+
+    ErrorConsumer errorConsumer;
+    DataBlob actual = assembleWithProject(errorConsumer, "DecompressorsProject.xml", source);
+    REQUIRE(errorConsumer.errorMessage() == "source:2: use of undeclared identifier 'decompress_zx7'.");
+}
+
+TEST_CASE("decompressor entry point exported for compressed section", "[decompressors]")
+{
+    static const char source[] =
+        "#section code\n"
+        "dw decompress_packed - decompress_zx0\n"
+        "db compressionof(packed)\n"
+        "#section packed\n"
+        "db 1, 2, 3\n"
+        ;
+
+    ErrorConsumer errorConsumer;
+    DataBlob actual = assembleWithProject(errorConsumer, "DecompressorsProject.xml", source);
+    REQUIRE(errorConsumer.errorMessage() == "");
+    REQUIRE(actual.data().substr(0, 3) == std::string("\x00\x00\x02", 3));
+}
+
+TEST_CASE("fast decompressor linked for codec selected by best compression", "[decompressors]")
+{
+    static const char source[] =
+        "#section code\n"
+        "dw decompress_packed\n"
+        "db compressionof(packed)\n"
+        "#section packed\n"
+        "db 1, 2, 3\n"
+        ;
+
+    auto compressor = Compressor::create(nullptr, Compression::BestFast);
+    std::vector<uint8_t> compressed;
+    compressor->compress(nullptr, { 1, 2, 3 }, compressed);
+    REQUIRE(compressor->compression() == Compression::Lzsa2);
+
+    ErrorConsumer errorConsumer;
+    DataBlob actual = assembleWithProject(errorConsumer, "DecompressorsFastProject.xml", source);
+    REQUIRE(errorConsumer.errorMessage() == "");
+    REQUIRE(actual.data().substr(0, 3) == std::string("\x03\x80\x04", 3));
+    REQUIRE(actual.data().substr(actual.data().size() - compressed.size())
+        == std::string(compressed.begin(), compressed.end()));
+}
+
+TEST_CASE("decompressor for codec not selected by best compression is not linked", "[decompressors]")
+{
+    static const char source[] =
+        "#section code\n"
+        "dw decompress_zx7\n"
+        "#section packed\n"
+        "db 1, 2, 3\n"
+        ;
+
+    ErrorConsumer errorConsumer;
+    DataBlob actual = assembleWithProject(errorConsumer, "DecompressorsFastProject.xml", source);
+    REQUIRE(errorConsumer.errorMessage() == "source:2: unable to resolve label \"decompress_zx7\".");
+}
+
+TEST_CASE("small zx0 decompressor restores data", "[decompressors]")
+{
+    std::string data = payload();
+    REQUIRE(decompress("zx0", "small", data) == data);
+}
+
+TEST_CASE("fast zx0 decompressor restores data", "[decompressors]")
+{
+    std::string data = payload();
+    REQUIRE(decompress("zx0", "fast", data) == data);
+}
+
+TEST_CASE("small zx7 decompressor restores data", "[decompressors]")
+{
+    std::string data = payload();
+    REQUIRE(decompress("zx7", "small", data) == data);
+}
+
+TEST_CASE("fast zx7 decompressor restores data", "[decompressors]")
+{
+    std::string data = payload();
+    REQUIRE(decompress("zx7", "fast", data) == data);
+}
+
+TEST_CASE("small lzsa2 decompressor restores data", "[decompressors]")
+{
+    std::string data = payload();
+    REQUIRE(decompress("lzsa2", "small", data) == data);
+}
+
+TEST_CASE("fast lzsa2 decompressor restores data", "[decompressors]")
+{
+    std::string data = payload();
+    REQUIRE(decompress("lzsa2", "fast", data) == data);
+}
@@ -0,0 +1,61 @@
+#include "Tests/Common.h"
+
+static const char source[] =
+    "#section code\n"
+    "ld h, table >> 8\n"
+    "ret\n"
+    "#section table\n"
+    "table:\n"
+    "#repeat 256\n"
+    "db 0\n"
+    "#endrepeat\n"
+    "#section small1\n"
+    "#repeat 100\n"
+    "db 1\n"
+    "#endrepeat\n"
+    "#section small2\n"
+    "#repeat 200\n"
+    "db 2\n"
+    "#endrepeat\n"
+    "#section tail\n"
+    "db 3\n"
+    ;
+
+TEST_CASE("alignment gap filled with small sections", "[gaps]")
+{
+    static const char memoryMap[] =
+        "section code at 0x8000..0x8002: 3 bytes, uncontended\n"
+        "section small2 at 0x8003..0x80CA: 200 bytes, uncontended\n"
+        "section tail at 0x80CB..0x80CB: 1 bytes, uncontended\n"
+        "section table at 0x8100..0x81FF: 256 bytes, uncontended\n"
+        "section small1 at 0x8200..0x8263: 100 bytes, uncontended\n"
+        "contended: 0 of 560 bytes\n"
+        "gaps filled: 201 bytes recovered\n"
+        ;
+
+    ErrorConsumer errorConsumer;
+    DataBlob actual = assembleWithProject(errorConsumer, "GapsProject.xml", source);
+    REQUIRE(errorConsumer.errorMessage() == "");
+    REQUIRE(actual.memoryMap() == memoryMap);
+    REQUIRE(actual.data().size() == 0x264);
+    REQUIRE(actual.data().substr(0, 4) == std::string("\x26\x81\xc9\x02", 4));
+    REQUIRE(actual.data()[0xcb] == 3);
+}
+
+TEST_CASE("gaps are left alone unless requested", "[gaps]")
+{
+    static const char memoryMap[] =
+        "section code at 0x8000..0x8002: 3 bytes, uncontended\n"
+        "section table at 0x8100..0x81FF: 256 bytes, uncontended\n"
+        "section small1 at 0x8200..0x8263: 100 bytes, uncontended\n"
+        "section small2 at 0x8264..0x832B: 200 bytes, uncontended\n"
+        "section tail at 0x832C..0x832C: 1 bytes, uncontended\n"
+        "contended: 0 of 560 bytes\n"
+        ;
+
+    ErrorConsumer errorConsumer;
+    DataBlob actual = assembleWithProject(errorConsumer, "GapsProject.xml", source);
+    REQUIRE(errorConsumer.errorMessage() == "");
+    REQUIRE(actual.fileData("PLAIN").memoryMap() == memoryMap);
+    REQUIRE(actual.fileData("PLAIN").data().size() == 0x32d);
+}
@@ -0,0 +1,81 @@
+#include "Tests/Common.h"
+#include "Common/BuildManifest.h"
+
+static const char source[] =
+    "#section code\n"
+    "ld a, bankof(level)\n"
+    "ret\n"
+    "#section big1\n"
+    "#repeat 10000\n"
+    "nop\n"
+    "#endrepeat\n"
+    "#section helper\n"
+    "#repeat 5000\n"
+    "nop\n"
+    "#endrepeat\n"
+    "#section level\n"
+    "#repeat 5000\n"
+    "{LEVEL}\n"
+    "#endrepeat\n"
+    ;
+
+static DataBlob assemble(const char* level, const char* prefix = "")
+{
+    std::string text = std::string(prefix) + source;
+    text.replace(text.find("{LEVEL}"), 7, level);
+
+    ErrorConsumer errorConsumer;
+    DataBlob blob = assembleWithProject(errorConsumer, "BanksProject.xml", text.c_str());
+    REQUIRE(errorConsumer.errorMessage() == "");
+    return blob;
+}
+
+TEST_CASE("fingerprint is stable between builds", "[incremental]")
+{
+    DataBlob first = assemble("nop");
+    DataBlob second = assemble("nop");
+    REQUIRE(first.numFiles() == 2);
+    REQUIRE(first.fingerprint() != 0);
+    REQUIRE(first.fingerprint() == second.fingerprint());
+    REQUIRE(first.fileData("BANK0").fingerprint() == second.fileData("BANK0").fingerprint());
+    REQUIRE(first.fileData("BANK1").fingerprint() == second.fileData("BANK1").fingerprint());
+}
+
+TEST_CASE("fingerprint changes only for modified bank", "[incremental]")
+{
+    DataBlob first = assemble("nop");
+    DataBlob second = assemble("scf");
+    REQUIRE(first.fingerprint() == second.fingerprint());
+    REQUIRE(first.fileData("BANK0").fingerprint() == second.fileData("BANK0").fingerprint());
+    REQUIRE(first.fileData("BANK1").fingerprint() != second.fileData("BANK1").fingerprint());
+}
+
+TEST_CASE("fingerprint changes when source lines move", "[incremental]")
+{
+    DataBlob first = assemble("nop");
+    DataBlob second = assemble("nop", "; comment\n");
+    REQUIRE(first.data() == second.data());
+    REQUIRE(first.fingerprint() != second.fingerprint());
+    REQUIRE(first.fileData("BANK1").fingerprint() != second.fileData("BANK1").fingerprint());
+}
+
+TEST_CASE("source maps are rebuilt only for modified bank", "[incremental]")
+{
+    TempFile outputPath("");
+    std::filesystem::create_directories(outputPath.path());
+    BuildManifest manifest(outputPath.path());
+
+    std::string text1 = source;
+    text1.replace(text1.find("{LEVEL}"), 7, "nop");
+    std::string text2 = source;
+    text2.replace(text2.find("{LEVEL}"), 7, "scf");
+
+    ErrorConsumer errorConsumer;
+    auto first = updateSourceMaps(errorConsumer, manifest, outputPath.path(), "BanksProject.xml", text1.c_str());
+    auto second = updateSourceMaps(errorConsumer, manifest, outputPath.path(), "BanksProject.xml", text1.c_str());
+    auto third = updateSourceMaps(errorConsumer, manifest, outputPath.path(), "BanksProject.xml", text2.c_str());
+    REQUIRE(errorConsumer.errorMessage() == "");
+    REQUIRE(first == std::vector<std::string>{ "MAIN", "BANK0", "BANK1" });
+    REQUIRE(second.empty());
+    REQUIRE(third == std::vector<std::string>{ "BANK1" });
+}
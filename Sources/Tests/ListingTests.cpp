@@ -0,0 +1,80 @@
+#include "Tests/Common.h"
+#include "Common/IO.h"
+
+TEST_CASE("listing contains address, bytes, timing and source", "[listing]")
+{
+    static const char source[] =
+        "#section code\n"
+        "start:\n"
+        "ld a, 1\n"
+        "jr nz, start\n"
+        "ld (ix+5), 0x12\n"
+        "db 1, 2, 3, 4, 5, 6\n"
+        "#section table\n"
+        "dw start\n"
+        "#section paged\n"
+        "ret\n"
+        "#section plain\n"
+        "nop\n"
+        ;
+
+    static const char listing[] =
+        "8000  --  3E 01        7       source:3\n"
+        "8002  --  20 FC        7..12   source:4\n"
+        "8004  --  DD 36 05 12  19      source:5\n"
+        "8008  --  01 02 03 04          source:6\n"
+        "800C  --  05 06\n"
+        "800E  --  ; 2 bytes of empty space\n"
+        "8010  --  00 80                source:8\n"
+        ;
+
+    ErrorConsumer errorConsumer;
+    DataBlob actual = assembleWithProject(errorConsumer, "ListingProject.xml", source);
+    REQUIRE(errorConsumer.errorMessage() == "");
+    REQUIRE(actual.listing() == listing);
+    REQUIRE(actual.fileData("BANK3").listing() == "C000  03  C9           10      source:10\n");
+    REQUIRE(actual.fileData("PLAIN").listing() == "");
+}
+
+TEST_CASE("listing of repeated instructions", "[listing]")
+{
+    static const char source[] =
+        "#section code\n"
+        "#repeat 2\n"
+        "inc hl\n"
+        "#endrepeat\n"
+        ;
+
+    static const char listing[] =
+        "8000  --  23           6       source:3\n"
+        "8001  --  23           6       source:3\n"
+        ;
+
+    ErrorConsumer errorConsumer;
+    DataBlob actual = assembleWithProject(errorConsumer, "ListingProject.xml", source);
+    REQUIRE(errorConsumer.errorMessage() == "");
+    REQUIRE(actual.listing() == listing);
+}
+
+TEST_CASE("listing shows source text of user code only", "[listing]")
+{
+    TempFile file(".asm");
+    writeFile(file.path(),
+        "#section code\n"
+        "ld a, 0xff\n"
+        "call turbo_load\n"
+        );
+
+    ErrorConsumer errorConsumer;
+    DataBlob actual = assembleFileWithProject(errorConsumer, "ListingTurboProject.xml", file.path());
+    REQUIRE(errorConsumer.errorMessage() == "");
+
+    // Generated code refers to the project file, which must not be shown as its source text
+    std::string name = file.path().filename().string();
+    std::string listing =
+        "8000  --  3E FF        7       " + name + ":2 ld a, 0xff\n"
+        "8002  --  CD 05 80     17      " + name + ":3 call turbo_load\n"
+        "8005  --  CD 0A 80     17      turbo_load.asm:2\n"
+        "8008  --  FB           4       turbo_load.asm:3\n";
+    REQUIRE(actual.listing().substr(0, listing.size()) == listing);
+}
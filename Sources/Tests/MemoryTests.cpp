@@ -0,0 +1,66 @@
+#include "Tests/Common.h"
+
+static const char source[] =
+    "#section data\n"
+    "db 1, 2, 3, 4\n"
+    "#section fast\n"
+    "ret\n"
+    "#section paged\n"
+    "nop\n"
+    "#section pinned\n"
+    "#repeat 16\n"
+    "nop\n"
+    "#endrepeat\n"
+    ;
+
+TEST_CASE("uncontended section skips contended memory", "[memory]")
+{
+    static const char memoryMap[] =
+        "section data at 0x7FF0..0x7FF3: 4 bytes, contended\n"
+        "section fast at 0x8000..0x8000: 1 bytes, uncontended\n"
+        "contended: 4 of 5 bytes\n"
+        ;
+
+    std::string binary("\x01\x02\x03\x04", 4);
+    binary.append(12, '\0');
+    binary.append(1, '\xc9');
+
+    ErrorConsumer errorConsumer;
+    DataBlob actual = assembleWithProject(errorConsumer, "UncontendedProject.xml", source);
+    REQUIRE(errorConsumer.errorMessage() == "");
+    REQUIRE(actual.data() == binary);
+    REQUIRE(actual.loadAddress() == 0x7ff0);
+    REQUIRE(actual.memoryMap() == memoryMap);
+    REQUIRE(actual.warnings() == "");
+}
+
+TEST_CASE("uncontended section in odd bank", "[memory]")
+{
+    static const char memoryMap[] =
+        "bank 1\n"
+        "section paged at 0xC000..0xC000: 1 bytes, contended (uncontended memory requested)\n"
+        "contended: 1 of 1 bytes\n"
+        ;
+
+    ErrorConsumer errorConsumer;
+    DataBlob actual = assembleWithProject(errorConsumer, "UncontendedProject.xml", source);
+    REQUIRE(errorConsumer.errorMessage() == "");
+    REQUIRE(actual.fileData("BANK1").memoryMap() == memoryMap);
+    REQUIRE(actual.fileData("BANK1").warnings() ==
+        "section \"paged\" in file \"BANK1\" is placed in contended memory (1 of 1 bytes are contended).\n");
+}
+
+TEST_CASE("uncontended section with explicit base in contended memory", "[memory]")
+{
+    static const char memoryMap[] =
+        "section pinned at 0x7FF8..0x8007: 16 bytes, 8 contended (uncontended memory requested)\n"
+        "contended: 8 of 16 bytes\n"
+        ;
+
+    ErrorConsumer errorConsumer;
+    DataBlob actual = assembleWithProject(errorConsumer, "UncontendedProject.xml", source);
+    REQUIRE(errorConsumer.errorMessage() == "");
+    REQUIRE(actual.fileData("SCREEN").memoryMap() == memoryMap);
+    REQUIRE(actual.fileData("SCREEN").warnings() ==
+        "section \"pinned\" in file \"SCREEN\" is placed in contended memory (8 of 16 bytes are contended).\n");
+}
@@ -0,0 +1,189 @@
+#include "Tests/Common.h"
+
+TEST_CASE("peephole: ld a, 0 replaced when flags are overwritten", "[peephole]")
+{
+    static const char source[] =
+        "#section peephole_0x100\n"
+        "ld a, 0\n"
+        "add a, b\n"
+        "ret\n"
+        ;
+
+    static const unsigned char binary[] = {
+        0xaf,                   // xor a
+        0x80,                   // add a, b
+        0xc9,                   // ret
+        };
+
+    ErrorConsumer errorConsumer;
+    DataBlob actual = assemble(errorConsumer, source);
+    DataBlob expected(binary, sizeof(binary));
+    REQUIRE(errorConsumer.errorMessage() == "");
+    REQUIRE(actual == expected);
+}
+
+TEST_CASE("peephole: ld a, 0 kept when flags are read", "[peephole]")
+{
+    static const char source[] =
+        "#section peephole_0x100\n"
+        "ld a, 0\n"
+        "adc a, b\n"
+        "ld a, 0\n"
+        "ret\n"
+        ;
+
+    static const unsigned char binary[] = {
+        0x3e, 0x00,             // ld a, 0
+        0x88,                   // adc a, b
+        0x3e, 0x00,             // ld a, 0
+        0xc9,                   // ret
+        };
+
+    ErrorConsumer errorConsumer;
+    DataBlob actual = assemble(errorConsumer, source);
+    DataBlob expected(binary, sizeof(binary));
+    REQUIRE(errorConsumer.errorMessage() == "");
+    REQUIRE(actual == expected);
+}
+
+TEST_CASE("peephole: cp 0 replaced when parity is not read on any path", "[peephole]")
+{
+    static const char source[] =
+        "#section peephole_0x100\n"
+        "cp 0\n"
+        "jr nz, skip\n"
+        "inc b\n"
+        "skip:\n"
+        "xor a\n"
+        "ret\n"
+        ;
+
+    static const unsigned char binary[] = {
+        0xb7,                   // or a
+        0x20, 0x01,             // jr nz, skip
+        0x04,                   // inc b
+        0xaf,                   // xor a
+        0xc9,                   // ret
+        };
+
+    ErrorConsumer errorConsumer;
+    DataBlob actual = assemble(errorConsumer, source);
+    DataBlob expected(binary, sizeof(binary));
+    REQUIRE(errorConsumer.errorMessage() == "");
+    REQUIRE(actual == expected);
+}
+
+TEST_CASE("peephole: cp 0 kept when parity is read", "[peephole]")
+{
+    static const char source[] =
+        "#section peephole_0x100\n"
+        "cp 0\n"
+        "jr z, skip\n"
+        "xor a\n"
+        "skip:\n"
+        "jp pe, 0\n"
+        ;
+
+    static const unsigned char binary[] = {
+        0xfe, 0x00,             // cp 0
+        0x28, 0x01,             // jr z, skip
+        0xaf,                   // xor a
+        0xea, 0x00, 0x00,       // jp pe, 0
+        };
+
+    ErrorConsumer errorConsumer;
+    DataBlob actual = assemble(errorConsumer, source);
+    DataBlob expected(binary, sizeof(binary));
+    REQUIRE(errorConsumer.errorMessage() == "");
+    REQUIRE(actual == expected);
+}
+
+TEST_CASE("peephole: jumps to next instruction and ld r, r removed", "[peephole]")
+{
+    static const char source[] =
+        "#section peephole_0x100\n"
+        "ld b, b\n"
+        "jp next\n"
+        "next:\n"
+        "nop\n"
+        "jr z, @@local\n"
+        "@@local:\n"
+        "ret\n"
+        ;
+
+    static const unsigned char binary[] = {
+        0x00,                   // nop
+        0xc9,                   // ret
+        };
+
+    ErrorConsumer errorConsumer;
+    DataBlob actual = assemble(errorConsumer, source);
+    DataBlob expected(binary, sizeof(binary));
+    REQUIRE(errorConsumer.errorMessage() == "");
+    REQUIRE(actual == expected);
+}
+
+TEST_CASE("peephole: labelled instructions are not rewritten", "[peephole]")
+{
+    static const char source[] =
+        "#section peephole_0x100\n"
+        "patch:\n"
+        "ld a, 0\n"
+        "add a, b\n"
+        "ret\n"
+        ;
+
+    static const unsigned char binary[] = {
+        0x3e, 0x00,             // ld a, 0
+        0x80,                   // add a, b
+        0xc9,                   // ret
+        };
+
+    ErrorConsumer errorConsumer;
+    DataBlob actual = assemble(errorConsumer, source);
+    DataBlob expected(binary, sizeof(binary));
+    REQUIRE(errorConsumer.errorMessage() == "");
+    REQUIRE(actual == expected);
+}
+
+TEST_CASE("peephole: disabled by default", "[peephole]")
+{
+    static const char source[] =
+        "#section main_0x100\n"
+        "ld a, 0\n"
+        "add a, b\n"
+        "ret\n"
+        ;
+
+    static const unsigned char binary[] = {
+        0x3e, 0x00,             // ld a, 0
+        0x80,                   // add a, b
+        0xc9,                   // ret
+        };
+
+    ErrorConsumer errorConsumer;
+    DataBlob actual = assemble(errorConsumer, source);
+    DataBlob expected(binary, sizeof(binary));
+    REQUIRE(errorConsumer.errorMessage() == "");
+    REQUIRE(actual == expected);
+}
+
+TEST_CASE("peephole: savings in timing report", "[peephole]")
+{
+    static const char source[] =
+        "#section peephole_0x100\n"
+        "ld a, 0\n"
+        "add a, b\n"
+        "ret\n"
+        ;
+
+    static const char timing[] =
+        "section peephole_0x100 at 0x0100: 18 T\n"
+        "    peephole: saved 1 bytes, 3 T (1 rewrites)\n"
+        ;
+
+    ErrorConsumer errorConsumer;
+    DataBlob actual = assemble(errorConsumer, source);
+    REQUIRE(errorConsumer.errorMessage() == "");
+    REQUIRE(actual.timing() == timing);
+}
@@ -0,0 +1,241 @@
+#include "Tests/Common.h"
+#include "Emulator/Emulator.h"
+#include "Emulator/Z80Cpu.h"
+#include "Emulator/Z80Memory.h"
+
+// Loads MAIN at 0x8000 and relocatable module at the specified address, then calls "relocate" from MAIN
+static std::string runRelocator(const DataBlob& blob, uint16_t moduleAddress)
+{
+    const uint16_t tableAddress = 0x6000;
+    const uint16_t returnAddress = 0x7000;
+    const uint16_t stackAddress = 0x7ffe;
+
+    Emulator emulator;
+    Z80Memory* memory = emulator.memory();
+    auto load = [memory](uint16_t address, const std::string& data) {
+            for (size_t i = 0; i < data.size(); i++)
+                memory->write(uint16_t(address + i), uint8_t(data[i]));
+        };
+
+    const std::string& module = blob.fileData("MODULE").data();
+    load(0x8000, blob.data());
+    load(moduleAddress, module);
+    load(tableAddress, blob.fileData("MODULE.reloc").data());
+    memory->write(stackAddress, uint8_t(returnAddress & 0xff));
+    memory->write(stackAddress + 1, uint8_t(returnAddress >> 8));
+
+    Z80Cpu* cpu = emulator.cpu();
+    cpu->set_sp(stackAddress);
+    cpu->set_hl(moduleAddress);
+    cpu->set_de(tableAddress);
+    cpu->set_bc(uint16_t(moduleAddress - blob.fileData("MODULE").loadAddress()));
+    cpu->set_pc(0x8000);
+
+    for (int steps = 0; cpu->get_pc() != returnAddress; steps++) {
+        REQUIRE(steps < 100000);
+        cpu->on_step();
+    }
+
+    std::string result(module.size(), 0);
+    for (size_t i = 0; i < module.size(); i++)
+        result[i] = char(memory->read(uint16_t(moduleAddress + i)));
+
+    return result;
+}
+
+TEST_CASE("relocation table", "[relocation]")
+{
+    static const char source[] =
+        "#section code\n"
+        "ret\n"
+        "#section module\n"
+        "entry:\n"
+        "ld hl, data\n"
+        "call sub\n"
+        "jr entry\n"
+        "ld a, (0x5c00)\n"
+        "ret\n"
+        "sub:\n"
+        "ld de, data_end - data\n"
+        "ret\n"
+        "#section module_data\n"
+        "data:\n"
+        "dw entry, sub\n"
+        "db 1, 2, 3\n"
+        "data_end:\n"
+        ;
+
+    static const unsigned char binary[] = {
+        0x21, 0x10, 0xc0,       // ld hl, data
+        0xcd, 0x0c, 0xc0,       // call sub
+        0x18, 0xf8,             // jr entry
+        0x3a, 0x00, 0x5c,       // ld a, (0x5c00)
+        0xc9,                   // ret
+        0x11, 0x07, 0x00,       // ld de, data_end - data
+        0xc9,                   // ret
+        0x00, 0xc0,             // dw entry
+        0x0c, 0xc0,             // dw sub
+        0x01, 0x02, 0x03,       // db 1, 2, 3
+        };
+
+    static const unsigned char table[] = {
+        0x02,                   // offset 1
+        0x02,                   // offset 4
+        0x0b,                   // offset 16
+        0x01,                   // offset 18
+        0x00,
+        };
+
+    ErrorConsumer errorConsumer;
+    DataBlob actual = assembleWithProject(errorConsumer, "RelocatableProject.xml", source);
+    REQUIRE(errorConsumer.errorMessage() == "");
+    REQUIRE(actual.fileData("MODULE") == DataBlob(binary, sizeof(binary)));
+    REQUIRE(actual.fileData("MODULE.reloc") == DataBlob(table, sizeof(table)));
+}
+
+TEST_CASE("relocation table with long distance", "[relocation]")
+{
+    static const char source[] =
+        "#section code\n"
+        "ret\n"
+        "#section module\n"
+        "entry:\n"
+        "dw entry\n"
+        "defs 600\n"
+        "dw entry\n"
+        ;
+
+    static const unsigned char table[] = { 0x01, 0xff, 0xff, 0x5d, 0x00 };
+
+    ErrorConsumer errorConsumer;
+    DataBlob actual = assembleWithProject(errorConsumer, "RelocatableProject.xml", source);
+    REQUIRE(errorConsumer.errorMessage() == "");
+    REQUIRE(actual.fileData("MODULE.reloc") == DataBlob(table, sizeof(table)));
+}
+
+TEST_CASE("relocatable module without fixups", "[relocation]")
+{
+    static const char source[] =
+        "#section code\n"
+        "ret\n"
+        "#section module\n"
+        "loop:\n"
+        "djnz loop\n"
+        "ret\n"
+        ;
+
+    ErrorConsumer errorConsumer;
+    DataBlob actual = assembleWithProject(errorConsumer, "RelocatableProject.xml", source);
+    REQUIRE(errorConsumer.errorMessage() == "");
+    REQUIRE(actual.fileData("MODULE.reloc") == DataBlob("\0", 1));
+}
+
+TEST_CASE("byte address can't be relocated", "[relocation]")
+{
+    static const char source[] =
+        "#section code\n"
+        "ret\n"
+        "#section module\n"
+        "entry:\n"
+        "ld a, entry >> 8\n"
+        "ret\n"
+        ;
+
+    ErrorConsumer errorConsumer;
+    DataBlob actual = assembleWithProject(errorConsumer, "RelocatableProject.xml", source);
+    REQUIRE(errorConsumer.errorMessage() ==
+        "source:5: value depends on address of relocatable file \"MODULE\" and can't be relocated.");
+}
+
+TEST_CASE("relocator linked into designated section", "[relocation]")
+{
+    static const char source[] =
+        "#section code\n"
+        "call relocate\n"
+        "ret\n"
+        "#section module\n"
+        "ret\n"
+        ;
+
+    static const unsigned char binary[] = {
+        0xcd, 0x04, 0x80,       // call relocate
+        0xc9,                   // ret
+        0x1a,                   // ld a, (de)
+        0x13,                   // inc de
+        0xb7,                   // or a
+        0xc8,                   // ret z
+        };
+
+    ErrorConsumer errorConsumer;
+    DataBlob actual = assembleWithProject(errorConsumer, "RelocatableProject.xml", source);
+    REQUIRE(errorConsumer.errorMessage() == "");
+    REQUIRE(actual.data().substr(0, sizeof(binary)) == std::string(binary, binary + sizeof(binary)));
+}
+
+TEST_CASE("relocator patches module loaded at another address", "[relocation]")
+{
+    static const char source[] =
+        "#section code\n"
+        "call relocate\n"
+        "ret\n"
+        "#section module\n"
+        "entry:\n"
+        "ld hl, data\n"
+        "call sub\n"
+        "jr entry\n"
+        "ld a, (0x5c00)\n"
+        "ret\n"
+        "sub:\n"
+        "ld de, data_end - data\n"
+        "ret\n"
+        "#section module_data\n"
+        "data:\n"
+        "dw entry, sub\n"
+        "db 1, 2, 3\n"
+        "data_end:\n"
+        ;
+
+    static const unsigned char binary[] = {
+        0x21, 0x33, 0x91,       // ld hl, data
+        0xcd, 0x2f, 0x91,       // call sub
+        0x18, 0xf8,             // jr entry
+        0x3a, 0x00, 0x5c,       // ld a, (0x5c00)
+        0xc9,                   // ret
+        0x11, 0x07, 0x00,       // ld de, data_end - data
+        0xc9,                   // ret
+        0x23, 0x91,             // dw entry
+        0x2f, 0x91,             // dw sub
+        0x01, 0x02, 0x03,       // db 1, 2, 3
+        };
+
+    ErrorConsumer errorConsumer;
+    DataBlob actual = assembleWithProject(errorConsumer, "RelocatableProject.xml", source);
+    REQUIRE(errorConsumer.errorMessage() == "");
+    REQUIRE(actual.fileData("MODULE").loadAddress() == 0xc000);
+    REQUIRE(runRelocator(actual, 0x9123) == std::string(binary, binary + sizeof(binary)));
+}
+
+TEST_CASE("relocator skips long distances", "[relocation]")
+{
+    static const char source[] =
+        "#section code\n"
+        "call relocate\n"
+        "ret\n"
+        "#section module\n"
+        "entry:\n"
+        "dw entry\n"
+        "defs 600\n"
+        "dw entry + 1\n"
+        ;
+
+    ErrorConsumer errorConsumer;
+    DataBlob actual = assembleWithProject(errorConsumer, "RelocatableProject.xml", source);
+    REQUIRE(errorConsumer.errorMessage() == "");
+
+    std::string expected(604, 0);
+    expected[1] = 0x64;         // dw entry
+    expected[602] = 0x01;       // dw entry + 1
+    expected[603] = 0x64;
+
+    REQUIRE(runRelocator(actual, 0x6400) == expected);
+}
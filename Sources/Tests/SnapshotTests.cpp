@@ -0,0 +1,392 @@
+#include "Tests/Common.h"
+#include "Compiler/Output/SpectrumSnapshotWriter.h"
+#include "Compiler/Output/LibSpectrum/LibSpectrum.h"
+#include "Compiler/Compression/Lz4.h"
+#include "Emulator/GameImage.h"
+#include "Emulator/Snapshot.h"
+#include "Common/IO.h"
+
+static std::string writeSnapshot(SpectrumSnapshotWriter& writer)
+{
+    TempFile file(".z80");
+    writer.setWriteZ80File(nullptr, file.path());
+    writer.writeOutput();
+    return file.load();
+}
+
+static void requirePage(libspectrum_snap* snap, int page, size_t offset, const std::vector<uint8_t>& bytes)
+{
+    const libspectrum_byte* memory = libspectrum_snap_pages(snap, page);
+    REQUIRE(memory != nullptr);
+    REQUIRE(std::string(reinterpret_cast<const char*>(memory + offset), bytes.size())
+        == std::string(bytes.begin(), bytes.end()));
+}
+
+TEST_CASE("z80 version 1 memory is compressed", "[z80]")
+{
+    std::vector<uint8_t> code = { 0xed, 0xed, 0xed, 0x00, 0xed, 0x00, 0x00, 0x00, 0x00, 0x00, 0x01, 0x02, 0xed };
+
+    SpectrumSnapshotWriter writer;
+    writer.setPC(0x8000);
+    addCode(writer, "code", 0x8000, code);
+    std::string data = writeSnapshot(writer);
+
+    REQUIRE(data.size() < 1000);
+    REQUIRE((uint8_t(data[12]) & 0x20) != 0);
+    REQUIRE(data.substr(data.size() - 4) == std::string("\x00\xed\xed\x00", 4));
+
+    LibSpectrum lib;
+    libspectrum_snap* snap = libspectrum_snap_alloc();
+    REQUIRE(libspectrum_snap_read(snap, reinterpret_cast<const libspectrum_byte*>(data.data()),
+        data.size(), LIBSPECTRUM_ID_SNAPSHOT_Z80, nullptr) == LIBSPECTRUM_ERROR_NONE);
+    requirePage(snap, 2, 0, code);
+    requirePage(snap, 2, code.size(), std::vector<uint8_t>(100, 0));
+    libspectrum_snap_free(snap);
+}
+
+TEST_CASE("z80 pages are compressed unless it makes them larger", "[z80]")
+{
+    std::vector<uint8_t> code = { 0x01, 0x02, 0x03, 0x04 };
+    std::vector<uint8_t> noise(16384);
+    for (size_t i = 0; i < noise.size(); i++)
+        noise[i] = (i % 2 == 0 ? 0xed : uint8_t(i * 7));
+
+    SpectrumSnapshotWriter writer;
+    writer.setMachine(Z80Machine::Spectrum128k);
+    addCode(writer, "code", 0x8000, code);
+    addCode(writer, "bank3", 0xc000, noise);
+    std::string data = writeSnapshot(writer);
+
+    // 8 pages, only bank 3 is stored uncompressed
+    size_t headerSize = 30 + 2 + 23;
+    REQUIRE(data.size() < headerSize + 8 * 3 + 16384 + 7 * 300);
+
+    LibSpectrum lib;
+    libspectrum_snap* snap = libspectrum_snap_alloc();
+    REQUIRE(libspectrum_snap_read(snap, reinterpret_cast<const libspectrum_byte*>(data.data()),
+        data.size(), LIBSPECTRUM_ID_SNAPSHOT_Z80, nullptr) == LIBSPECTRUM_ERROR_NONE);
+    requirePage(snap, 2, 0, code);
+    requirePage(snap, 3, 0, noise);
+    requirePage(snap, 7, 0, std::vector<uint8_t>(16384, 0));
+    libspectrum_snap_free(snap);
+}
+
+static std::string writeSzxSnapshot(SpectrumSnapshotWriter& writer)
+{
+    TempFile file(".szx");
+    writer.setWriteSzxFile(nullptr, file.path());
+    writer.writeOutput();
+    return file.load();
+}
+
+static std::vector<std::pair<int, uint16_t>> szxRamPages(const std::string& data)
+{
+    std::vector<std::pair<int, uint16_t>> pages;
+    for (size_t off = 8; off + 8 <= data.size(); ) {
+        const uint8_t* p = reinterpret_cast<const uint8_t*>(&data[off]);
+        size_t size = p[4] | (p[5] << 8) | (p[6] << 16) | (size_t(p[7]) << 24);
+        if (data.compare(off, 4, "RAMP") == 0)
+            pages.emplace_back(p[10], uint16_t(p[8] | (p[9] << 8)));
+        off += 8 + size;
+        REQUIRE(off <= data.size());
+    }
+    return pages;
+}
+
+TEST_CASE("szx pages are compressed", "[szx]")
+{
+    SpectrumSnapshotWriter writer;
+    writer.setPC(0x8000);
+    addCode(writer, "code", 0x8000, { 0x01, 0x02, 0x03, 0x04 });
+    std::string data = writeSzxSnapshot(writer);
+
+    REQUIRE(data.substr(0, 4) == "ZXST");
+    REQUIRE(data[6] == 1);  // ZXSTMID_48K
+    REQUIRE(data.size() < 1000);
+
+    std::vector<std::pair<int, uint16_t>> expected = { { 5, 1 }, { 2, 1 }, { 0, 1 } };
+    REQUIRE(szxRamPages(data) == expected);
+}
+
+TEST_CASE("szx pages are stored uncompressed if compression makes them larger", "[szx]")
+{
+    std::vector<uint8_t> noise(16384);
+    uint32_t seed = 1;
+    for (size_t i = 0; i < noise.size(); i++) {
+        seed = seed * 1103515245 + 12345;
+        noise[i] = uint8_t(seed >> 16);
+    }
+
+    SpectrumSnapshotWriter writer;
+    writer.setMachine(Z80Machine::Spectrum128k);
+    addCode(writer, "bank3", 0xc000, noise);
+    std::string data = writeSzxSnapshot(writer);
+
+    REQUIRE(data.substr(0, 4) == "ZXST");
+    REQUIRE(data.size() < 16384 + 4000);
+
+    std::vector<std::pair<int, uint16_t>> expected = {
+        { 5, 1 }, { 2, 1 }, { 0, 1 }, { 1, 1 }, { 3, 0 }, { 4, 1 }, { 6, 1 }, { 7, 1 } };
+    REQUIRE(szxRamPages(data) == expected);
+
+    size_t pos = data.find(std::string(reinterpret_cast<const char*>(noise.data()), 64));
+    REQUIRE(pos != std::string::npos);
+}
+
+namespace
+{
+    class BitReader
+    {
+    public:
+        BitReader(const uint8_t* data, size_t size) : mData(data), mSize(size), mPos(0), mBit(0) {}
+
+        size_t position() const { return mPos; }
+
+        uint32_t read(int count)
+        {
+            uint32_t value = 0;
+            for (int i = 0; i < count; i++) {
+                if (mPos >= mSize)
+                    FAIL("unexpected end of deflate stream");
+                value |= uint32_t((mData[mPos] >> mBit) & 1) << i;
+                if (++mBit == 8) {
+                    mBit = 0;
+                    ++mPos;
+                }
+            }
+            return value;
+        }
+
+        // Huffman codes are stored starting from the most significant bit
+        uint32_t readCode(int count)
+        {
+            uint32_t code = 0;
+            for (int i = 0; i < count; i++)
+                code = (code << 1) | read(1);
+            return code;
+        }
+
+        void alignToByte()
+        {
+            if (mBit != 0) {
+                mBit = 0;
+                ++mPos;
+            }
+        }
+
+    private:
+        const uint8_t* mData;
+        size_t mSize;
+        size_t mPos;
+        int mBit;
+    };
+}
+
+static int readFixedLiteralOrLength(BitReader& reader)
+{
+    uint32_t code = reader.readCode(7);
+    if (code <= 0x17)
+        return int(256 + code);
+    code = (code << 1) | reader.read(1);
+    if (code >= 0x30 && code <= 0xbf)
+        return int(code - 0x30);
+    if (code >= 0xc0 && code <= 0xc7)
+        return int(280 + code - 0xc0);
+    code = (code << 1) | reader.read(1);
+    return int(144 + code - 0x190);
+}
+
+// Supports stored and fixed Huffman blocks, which is all the writer produces
+static std::vector<uint8_t> zlibInflate(const uint8_t* data, size_t size)
+{
+    static const uint16_t lengthBase[] = {
+        3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31,
+        35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258,
+    };
+    static const uint8_t lengthExtraBits[] = {
+        0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2,
+        3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0,
+    };
+    static const uint16_t distanceBase[] = {
+        1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193,
+        257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577,
+    };
+    static const uint8_t distanceExtraBits[] = {
+        0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6,
+        7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13,
+    };
+
+    REQUIRE(size >= 6);
+    REQUIRE((data[0] & 0x0f) == 8);
+    REQUIRE(((data[0] << 8) | data[1]) % 31 == 0);
+
+    std::vector<uint8_t> out;
+    BitReader reader(data + 2, size - 6);
+    bool last;
+    do {
+        last = (reader.read(1) != 0);
+        uint32_t type = reader.read(2);
+        if (type == 0) {
+            reader.alignToByte();
+            uint32_t length = reader.read(16);
+            REQUIRE((reader.read(16) ^ length) == 0xffff);
+            for (uint32_t i = 0; i < length; i++)
+                out.emplace_back(uint8_t(reader.read(8)));
+            continue;
+        }
+
+        REQUIRE(type == 1);
+        for (;;) {
+            int symbol = readFixedLiteralOrLength(reader);
+            if (symbol < 256) {
+                out.emplace_back(uint8_t(symbol));
+                continue;
+            }
+            if (symbol == 256)
+                break;
+
+            symbol -= 257;
+            if (symbol >= 29)
+                FAIL("invalid length code");
+            size_t length = lengthBase[symbol] + reader.read(lengthExtraBits[symbol]);
+            uint32_t distanceCode = reader.readCode(5);
+            if (distanceCode >= 30)
+                FAIL("invalid distance code");
+            size_t distance = distanceBase[distanceCode] + reader.read(distanceExtraBits[distanceCode]);
+            if (distance > out.size())
+                FAIL("distance too far back");
+            for (size_t i = 0; i < length; i++)
+                out.emplace_back(out[out.size() - distance]);
+        }
+    } while (!last);
+
+    reader.alignToByte();
+    REQUIRE(reader.position() == size - 6);
+
+    uint32_t a = 1, b = 0;
+    for (uint8_t byte : out) {
+        a = (a + byte) % 65521;
+        b = (b + a) % 65521;
+    }
+    const uint8_t* p = data + size - 4;
+    REQUIRE(((uint32_t(p[0]) << 24) | (p[1] << 16) | (p[2] << 8) | p[3]) == ((b << 16) | a));
+
+    return out;
+}
+
+static std::map<int, std::vector<uint8_t>> szxRamContents(const std::string& data)
+{
+    std::map<int, std::vector<uint8_t>> pages;
+    for (size_t off = 8; off + 8 <= data.size(); ) {
+        const uint8_t* p = reinterpret_cast<const uint8_t*>(&data[off]);
+        size_t size = p[4] | (p[5] << 8) | (p[6] << 16) | (size_t(p[7]) << 24);
+        REQUIRE(off + 8 + size <= data.size());
+        if (data.compare(off, 4, "RAMP") == 0) {
+            REQUIRE(size >= 3);
+            if ((p[8] & 1) != 0)
+                pages[p[10]] = zlibInflate(p + 11, size - 3);
+            else
+                pages[p[10]] = std::vector<uint8_t>(p + 11, p + 8 + size);
+        }
+        off += 8 + size;
+    }
+    return pages;
+}
+
+TEST_CASE("szx compressed pages round trip", "[szx]")
+{
+    std::vector<uint8_t> screen(6912);
+    for (size_t i = 0; i < screen.size(); i++)
+        screen[i] = uint8_t(i < 6144 ? (i / 32) ^ (i % 7) : 0x38);
+    std::vector<uint8_t> code = { 0xf3, 0x31, 0xfe, 0xff, 0x01, 0x02, 0x03, 0x01, 0x02, 0x03, 0xc9 };
+    std::vector<uint8_t> table(4000);
+    for (size_t i = 0; i < table.size(); i++)
+        table[i] = uint8_t((i * i) >> 3);
+
+    SpectrumSnapshotWriter writer;
+    writer.setMachine(Z80Machine::Spectrum128k);
+    writer.setPC(0x8000);
+    addCode(writer, "screen", 0x4000, screen);
+    addCode(writer, "code", 0x8000, code);
+    addCode(writer, "bank3", 0xc100, table);
+    std::string data = writeSzxSnapshot(writer);
+
+    std::vector<std::pair<int, uint16_t>> compressed = {
+        { 5, 1 }, { 2, 1 }, { 0, 1 }, { 1, 1 }, { 3, 1 }, { 4, 1 }, { 6, 1 }, { 7, 1 } };
+    REQUIRE(szxRamPages(data) == compressed);
+
+    auto pages = szxRamContents(data);
+    REQUIRE(pages.size() == 8);
+
+    std::vector<uint8_t> bank5(16384, 0);
+    std::copy(screen.begin(), screen.end(), bank5.begin());
+    std::vector<uint8_t> bank2(16384, 0);
+    std::copy(code.begin(), code.end(), bank2.begin());
+    std::vector<uint8_t> bank3(16384, 0);
+    std::copy(table.begin(), table.end(), bank3.begin() + 0x100);
+
+    REQUIRE(pages[5] == bank5);
+    REQUIRE(pages[2] == bank2);
+    REQUIRE(pages[3] == bank3);
+    for (int page : { 0, 1, 4, 6, 7 })
+        REQUIRE(pages[page] == std::vector<uint8_t>(16384, 0));
+}
+
+TEST_CASE("memory image is appended to runtime executable", "[exe]")
+{
+    TempFile runtime(".bin");
+    TempFile exe(".exe");
+    std::string runtimeData = "MZ runtime executable";
+    writeFile(runtime.path(), runtimeData);
+
+    std::vector<uint8_t> code = { 0xf3, 0x31, 0x00, 0x00, 0xc3, 0x00, 0x80 };
+    SpectrumSnapshotWriter writer;
+    writer.setPC(0x8000);
+    writer.setSP(0xfffe);
+    writer.setBorderColor(3);
+    addCode(writer, "code", 0x8000, code);
+    addCode(writer, "screen", 0x4000, std::vector<uint8_t>(6144, 0xaa));
+    writer.addWriteExeFile(nullptr, runtime.path(), exe.path());
+    writer.writeOutput();
+
+    std::string data = exe.load();
+    REQUIRE(data.substr(0, runtimeData.size()) == runtimeData);
+    REQUIRE(data.size() < runtimeData.size() + 1000);
+    REQUIRE(data.substr(data.size() - 8) == "GAMEDATA");
+
+    SnapshotState state = {};
+    std::vector<uint8_t> memory(8 * 16384, 0xff);
+    FILE* f = fopen(exe.path().string().c_str(), "rb");
+    REQUIRE(f != nullptr);
+    bool loaded = loadGameImage(f, state, memory.data());
+    fclose(f);
+
+    REQUIRE(loaded);
+    REQUIRE(state.pcL == 0x00);
+    REQUIRE(state.pcH == 0x80);
+    REQUIRE(state.spL == 0xfe);
+    REQUIRE(state.spH == 0xff);
+    REQUIRE(state.borderColor == 3);
+    REQUIRE(std::string(memory.begin() + 5 * 16384, memory.begin() + 5 * 16384 + 6144) == std::string(6144, '\xaa'));
+    REQUIRE(std::string(memory.begin() + 2 * 16384, memory.begin() + 2 * 16384 + code.size())
+        == std::string(code.begin(), code.end()));
+    REQUIRE(std::count(memory.begin(), memory.end(), 0) == ptrdiff_t(memory.size() - 6144 - 4));
+}
+
+TEST_CASE("lz4 memory image round trip", "[exe]")
+{
+    std::vector<uint8_t> src(16384);
+    for (size_t i = 0; i < src.size(); i++)
+        src[i] = (i < 8000 ? uint8_t(i * i >> 5) : 0);
+
+    std::vector<uint8_t> compressed;
+    lz4Compress(src.data(), src.size(), compressed);
+    REQUIRE(compressed.size() < 9000);
+
+    std::vector<uint8_t> dst(src.size());
+    decompressLz4(compressed.data(), compressed.size(), dst.data(), dst.size());
+    REQUIRE(dst == src);
+
+    REQUIRE_THROWS(decompressLz4(compressed.data(), compressed.size() - 1, dst.data(), dst.size()));
+    REQUIRE_THROWS(decompressLz4(compressed.data(), compressed.size(), dst.data(), dst.size() - 1));
+}
@@ -0,0 +1,129 @@
+#include "Tests/Common.h"
+#include "Compiler/Linker/SourceMap.h"
+
+static void readSourceMap(SourceMap& sourceMap, const DataBlob& blob)
+{
+    const auto* data = reinterpret_cast<const uint8_t*>(blob.sourceMap().data());
+    REQUIRE(sourceMap.read(data, blob.sourceMap().size()));
+}
+
+TEST_CASE("source map runs and symbols", "[srcmap]")
+{
+    static const char source[] =
+        "#section main\n"
+        "start:\n"
+        "ld a, 1\n"
+        "ld b, 2\n"
+        "\n"
+        "loop:\n"
+        "djnz loop\n"
+        "db 1, 2, 3\n"
+        "ret\n"
+        ;
+
+    ErrorConsumer errorConsumer;
+    DataBlob actual = assemble(errorConsumer, source);
+    REQUIRE(errorConsumer.errorMessage() == "");
+
+    SourceMap sourceMap;
+    readSourceMap(sourceMap, actual);
+    REQUIRE(sourceMap.loadAddress() == 0x1234);
+    REQUIRE(sourceMap.size() == 10);
+    REQUIRE(sourceMap.bank() == SourceMap::NoBank);
+    REQUIRE(sourceMap.files() == std::vector<std::string>{ "source" });
+
+    const auto& runs = sourceMap.runs();
+    REQUIRE(runs.size() == 5);
+    REQUIRE(runs[0].address == 0x1234);
+    REQUIRE(runs[0].size == 2);
+    REQUIRE(runs[0].line == 3);
+    REQUIRE(runs[1].line == 4);
+    REQUIRE(runs[2].address == 0x1238);
+    REQUIRE(runs[2].line == 7);
+    REQUIRE(runs[3].size == 3);
+    REQUIRE(runs[3].line == 8);
+    REQUIRE(runs[4].address == 0x123d);
+    REQUIRE(runs[4].file == 0);
+    REQUIRE(runs[4].line == 9);
+
+    REQUIRE(sourceMap.findRun(0x1235) == &runs[0]);
+    REQUIRE(sourceMap.findRun(0x123b) == &runs[3]);
+    REQUIRE(sourceMap.findRun(0x123e) == nullptr);
+    REQUIRE(sourceMap.findRun(0x1233) == nullptr);
+
+    const auto& symbols = sourceMap.symbols();
+    REQUIRE(symbols.size() == 2);
+    REQUIRE(symbols[0].name == "start");
+    REQUIRE(symbols[0].address == 0x1234);
+    REQUIRE(symbols[1].name == "loop");
+    REQUIRE(symbols[1].address == 0x1238);
+}
+
+TEST_CASE("source map with multiple files", "[srcmap]")
+{
+    static const char source1[] =
+        "#section main\n"
+        "call func\n"
+        "ret\n"
+        ;
+
+    static const char source2[] =
+        "#section main\n"
+        "func:\n"
+        "nop\n"
+        "ret\n"
+        ;
+
+    ErrorConsumer errorConsumer;
+    DataBlob actual = assemble2(errorConsumer, source1, source2);
+    REQUIRE(errorConsumer.errorMessage() == "");
+
+    SourceMap sourceMap;
+    readSourceMap(sourceMap, actual);
+    REQUIRE(sourceMap.files() == std::vector<std::string>{ "source1", "source2" });
+
+    const auto& runs = sourceMap.runs();
+    REQUIRE(runs.size() == 4);
+    REQUIRE(runs[0].file == 0);
+    REQUIRE(runs[0].size == 3);
+    REQUIRE(runs[1].file == 0);
+    REQUIRE(runs[1].line == 3);
+    REQUIRE(runs[2].file == 1);
+    REQUIRE(runs[2].line == 3);
+    REQUIRE(runs[3].file == 1);
+    REQUIRE(runs[3].line == 4);
+}
+
+TEST_CASE("source map is compact", "[srcmap]")
+{
+    std::string source = "#section main\n";
+    for (int i = 0; i < 1000; i++)
+        source += "ld hl, 0x1234\n";
+
+    ErrorConsumer errorConsumer;
+    DataBlob actual = assemble(errorConsumer, source.c_str());
+    REQUIRE(errorConsumer.errorMessage() == "");
+
+    // 44-byte header, one file name, 3 bytes per run
+    REQUIRE(actual.sourceMap().size() <= 44 + 4 + 3 * 1000 + 12);
+    REQUIRE(actual.sourceMap().substr(0, 4) == "RSMP");
+
+    SourceMap sourceMap;
+    readSourceMap(sourceMap, actual);
+    REQUIRE(sourceMap.runs().size() == 1000);
+    REQUIRE(sourceMap.runs()[999].address == 0x1234 + 999 * 3);
+    REQUIRE(sourceMap.runs()[999].line == 1001);
+}
+
+TEST_CASE("truncated source map is rejected", "[srcmap]")
+{
+    ErrorConsumer errorConsumer;
+    DataBlob actual = assemble(errorConsumer, "#section main\nstart:\nnop\n");
+    REQUIRE(errorConsumer.errorMessage() == "");
+
+    const auto* data = reinterpret_cast<const uint8_t*>(actual.sourceMap().data());
+    SourceMap sourceMap;
+    REQUIRE(sourceMap.read(data, actual.sourceMap().size()));
+    REQUIRE(!sourceMap.read(data, actual.sourceMap().size() - 1));
+    REQUIRE(!sourceMap.read(data, 40));
+}
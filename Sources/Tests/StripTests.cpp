@@ -0,0 +1,125 @@
+#include "Tests/Common.h"
+
+static const char source[] =
+    "#section code\n"
+    "call used\n"
+    "ld bc, sizeof(table)\n"
+    "ret\n"
+    "#section used\n"
+    "used:\n"
+    "jp helper\n"
+    "#section helper\n"
+    "helper:\n"
+    "ret\n"
+    "#section unused\n"
+    "unused:\n"
+    "call helper\n"
+    "call missing\n"
+    "db 1, 2, 3\n"
+    "#section exported\n"
+    "exported:\n"
+    "db 4\n"
+    "#section table\n"
+    "db 5, 6\n"
+    "#section other\n"
+    "missing:\n"
+    "ret\n"
+    ;
+
+TEST_CASE("unreferenced sections are stripped", "[strip]")
+{
+    static const char memoryMap[] =
+        "section code at 0x8000..0x8006: 7 bytes, uncontended\n"
+        "section used at 0x8007..0x8009: 3 bytes, uncontended\n"
+        "section helper at 0x800A..0x800A: 1 bytes, uncontended\n"
+        "section exported at 0x800B..0x800B: 1 bytes, uncontended\n"
+        "section table at 0x800C..0x800D: 2 bytes, uncontended\n"
+        "contended: 0 of 14 bytes\n"
+        "removed section unused: 9 bytes\n"
+        "removed: 9 bytes\n"
+        ;
+
+    static const char binary[] =
+        "\xcd\x07\x80"    // call used
+        "\x01\x02\x00"    // ld bc, sizeof(table)
+        "\xc9"            // ret
+        "\xc3\x0a\x80"    // jp helper
+        "\xc9"            // ret
+        "\x04"            // db 4
+        "\x05\x06"        // db 5, 6
+        ;
+
+    ErrorConsumer errorConsumer;
+    DataBlob actual = assembleWithProject(errorConsumer, "StripProject.xml", source);
+    REQUIRE(errorConsumer.errorMessage() == "");
+    REQUIRE(actual.memoryMap() == memoryMap);
+    REQUIRE(actual.data() == std::string(binary, sizeof(binary) - 1));
+}
+
+TEST_CASE("constants referring to stripped code are not evaluated", "[strip]")
+{
+    static const char constants[] =
+        "unused_end equ unused + 9\n"
+        "unused_size equ sizeof(unused)\n"
+        ;
+
+    ErrorConsumer errorConsumer;
+    DataBlob actual = assembleWithProject(errorConsumer, "StripProject.xml", (std::string(constants) + source).c_str());
+    REQUIRE(errorConsumer.errorMessage() == "");
+    REQUIRE(actual.data().size() == 14);
+}
+
+TEST_CASE("sections of files embedded into basic are not stripped", "[strip]")
+{
+    static const char code[] =
+        "#section code\n"
+        "ret\n"
+        "#section used\n"
+        "xor a\n"
+        "ret\n"
+        ;
+
+    static const char basic[] =
+        "10 RANDOMIZE USR 32769\n"
+        "20 REM @{file:MAIN}\n"
+        ;
+
+    ErrorConsumer errorConsumer;
+    DataBlob actual = assembleWithBasic(errorConsumer, "StripProject.xml", code, basic);
+    REQUIRE(errorConsumer.errorMessage() == "");
+    REQUIRE(actual.data() == std::string("\xc9\xaf\xc9", 3));
+
+    actual = assembleWithProject(errorConsumer, "StripProject.xml", code);
+    REQUIRE(errorConsumer.errorMessage() == "");
+    REQUIRE(actual.data() == std::string("\xc9", 1));
+}
+
+TEST_CASE("unresolved label in code that is not stripped", "[strip]")
+{
+    static const char labels[] =
+        "#section helper\n"
+        "#repeat 0\n"
+        "inner:\n"
+        "nop\n"
+        "#endrepeat\n"
+        ;
+
+    ErrorConsumer errorConsumer;
+    DataBlob actual = assembleWithProject(errorConsumer, "StripProject.xml", (std::string(source) + labels).c_str());
+    REQUIRE(errorConsumer.errorMessage() == "source:26: unable to resolve address for label \"inner\".");
+}
+
+TEST_CASE("labels in stripped code are not reported as unresolved", "[strip]")
+{
+    static const char labels[] =
+        "#section unused\n"
+        "#repeat 0\n"
+        "inner:\n"
+        "nop\n"
+        "#endrepeat\n"
+        ;
+
+    ErrorConsumer errorConsumer;
+    DataBlob actual = assembleWithProject(errorConsumer, "StripProject.xml", (std::string(source) + labels).c_str());
+    REQUIRE(errorConsumer.errorMessage() == "");
+}
@@ -0,0 +1,74 @@
+#include "Tests/Common.h"
+#include "Compiler/Output/TRDOSWriter.h"
+
+static std::vector<uint8_t> pattern(size_t size)
+{
+    std::vector<uint8_t> data(size);
+    for (size_t i = 0; i < size; i++)
+        data[i] = uint8_t(i * 13);
+    return data;
+}
+
+static void writeDisk(TRDOSWriter& writer, std::string& trd, std::string& scl)
+{
+    TempFile trdFile(".trd");
+    TempFile sclFile(".scl");
+    writer.setWriteSclFile(sclFile.path());
+    writer.setWriteTrdFile(trdFile.path(), "volume");
+    writer.writeOutput();
+
+    trd = trdFile.load();
+    scl = sclFile.load();
+}
+
+TEST_CASE("trd and scl images", "[trdos]")
+{
+    TRDOSWriter writer;
+    writer.addBasicFile(nullptr, "boot", std::string("\x00\x0a\x02\x00\xef\x0d", 6), 10);
+    addCode(writer, "code", 0x8000, pattern(700));
+
+    std::string trd, scl;
+    writeDisk(writer, trd, scl);
+
+    REQUIRE(trd.size() == 655360);
+    REQUIRE(trd.substr(0, 16) == std::string("boot    B\x0a\x00\x0a\x00\x01\x00\x01", 16));
+    REQUIRE(trd.substr(16, 16) == std::string("code    C\x00\x80\xbc\x02\x03\x01\x01", 16));
+    REQUIRE(trd[32] == 1);
+    REQUIRE(trd.substr(8 * 256 + 225, 7) == std::string("\x04\x01\x16\x02\xec\x09\x10", 7));
+    REQUIRE(trd.substr(8 * 256 + 245, 8) == "volume  ");
+    REQUIRE(trd.substr(16 * 256, 10) == std::string("\x00\x0a\x02\x00\xef\x0d\x80\xaa\x0a\x00", 10));
+    REQUIRE(trd.substr(17 * 256, 3) == std::string("\x00\x0d\x1a", 3));
+    REQUIRE(trd.substr(17 * 256 + 700, 68) == std::string(68, '\0'));
+
+    REQUIRE(scl.size() == 9 + 2 * 14 + 4 * 256 + 4);
+    REQUIRE(scl.substr(0, 9) == "SINCLAIR\x02");
+    REQUIRE(scl.substr(9, 14) == trd.substr(0, 14));
+    REQUIRE(scl.substr(23, 14) == trd.substr(16, 14));
+    REQUIRE(scl.substr(37, 4 * 256) == trd.substr(16 * 256, 4 * 256));
+
+    uint32_t checksum = 0;
+    for (size_t i = 0; i < scl.size() - 4; i++)
+        checksum += uint8_t(scl[i]);
+    const char* p = &scl[scl.size() - 4];
+    REQUIRE((uint8_t(p[0]) | (uint8_t(p[1]) << 8) | (uint8_t(p[2]) << 16) | (uint32_t(uint8_t(p[3])) << 24)) == checksum);
+}
+
+TEST_CASE("too many files for trd", "[trdos]")
+{
+    TRDOSWriter writer;
+    for (int i = 0; i < 129; i++)
+        addCode(writer, "code", 0x8000, pattern(1));
+
+    std::string trd, scl;
+    REQUIRE_THROWS_WITH(writeDisk(writer, trd, scl), "too many files for TR-DOS disk.");
+}
+
+TEST_CASE("files do not fit on trd", "[trdos]")
+{
+    TRDOSWriter writer;
+    for (int i = 0; i < 11; i++)
+        addCode(writer, "code", 0x0000, pattern(65000));
+
+    std::string trd, scl;
+    REQUIRE_THROWS_WITH(writeDisk(writer, trd, scl), "not enough space on TR-DOS disk.");
+}
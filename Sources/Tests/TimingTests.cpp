@@ -0,0 +1,160 @@
+#include "Tests/Common.h"
+
+TEST_CASE("section and label timing", "[timing]")
+{
+    static const char source[] =
+        "#section main_0x100\n"
+        "start:\n"
+        "ld a, 1\n"
+        "loop:\n"
+        "djnz loop\n"
+        "ret\n"
+        ;
+
+    static const char timing[] =
+        "section main_0x100 at 0x0100: 25..30 T\n"
+        "    0x0100  start                            7 T\n"
+        "    0x0102  loop                             18..23 T\n"
+        ;
+
+    ErrorConsumer errorConsumer;
+    DataBlob actual = assemble(errorConsumer, source);
+    REQUIRE(errorConsumer.errorMessage() == "");
+    REQUIRE(actual.timing() == timing);
+}
+
+TEST_CASE("timing of repeated code", "[timing]")
+{
+    static const char source[] =
+        "#section main_0x100\n"
+        "db 0\n"
+        "#repeat 3\n"
+        "nop\n"
+        "#endrepeat\n"
+        "wait:\n"
+        "jr nz, wait\n"
+        ;
+
+    static const char timing[] =
+        "section main_0x100 at 0x0100: 19..24 T\n"
+        "    0x0104  wait                             7..12 T\n"
+        ;
+
+    ErrorConsumer errorConsumer;
+    DataBlob actual = assemble(errorConsumer, source);
+    REQUIRE(errorConsumer.errorMessage() == "");
+    REQUIRE(actual.timing() == timing);
+}
+
+TEST_CASE("ensuretstates exact", "[timing]")
+{
+    static const char source[] =
+        "#section main_0x100\n"
+        "#ensuretstates start, finish, 18\n"
+        "start:\n"
+        "ld a, 1\n"
+        "ld (hl), a\n"
+        "nop\n"
+        "finish:\n"
+        "ret\n"
+        ;
+
+    static const unsigned char binary[] = {
+        0x3e,
+        0x01,
+        0x77,
+        0x00,
+        0xc9,
+        };
+
+    ErrorConsumer errorConsumer;
+    DataBlob actual = assemble(errorConsumer, source);
+    DataBlob expected(binary, sizeof(binary));
+    REQUIRE(errorConsumer.errorMessage() == "");
+    REQUIRE(actual == expected);
+}
+
+TEST_CASE("ensuretstates exact with conditional branch", "[timing]")
+{
+    static const char source[] =
+        "#section main_0x100\n"
+        "start:\n"
+        "jr z, finish\n"
+        "finish:\n"
+        "#timing start, finish, 12\n"
+        ;
+
+    ErrorConsumer errorConsumer;
+    DataBlob actual = assemble(errorConsumer, source);
+    REQUIRE(errorConsumer.errorMessage() ==
+        "source:5: code between 0x0100 and 0x0102 takes 7..12 T-states, expected exactly 12.");
+}
+
+TEST_CASE("ensuretstates at most", "[timing]")
+{
+    static const char source[] =
+        "#section main_0x100\n"
+        "start:\n"
+        "jr z, finish\n"
+        "finish:\n"
+        "#timing start, finish, <= 12\n"
+        ;
+
+    ErrorConsumer errorConsumer;
+    DataBlob actual = assemble(errorConsumer, source);
+    REQUIRE(errorConsumer.errorMessage() == "");
+}
+
+TEST_CASE("ensuretstates overrun", "[timing]")
+{
+    static const char source[] =
+        "#section main_0x100\n"
+        "start:\n"
+        "#repeat 4\n"
+        "nop\n"
+        "#endrepeat\n"
+        "finish:\n"
+        "#ensuretstates start, finish, <= 12\n"
+        ;
+
+    ErrorConsumer errorConsumer;
+    DataBlob actual = assemble(errorConsumer, source);
+    REQUIRE(errorConsumer.errorMessage() ==
+        "source:7: code between 0x0100 and 0x0104 takes 16 T-states, expected at most 12.");
+}
+
+TEST_CASE("ensuretstates missing comma", "[timing]")
+{
+    static const char source[] =
+        "#section main_0x100\n"
+        "start:\n"
+        "#ensuretstates start 12\n"
+        ;
+
+    ErrorConsumer errorConsumer;
+    DataBlob actual = assemble(errorConsumer, source);
+    REQUIRE(errorConsumer.errorMessage() == "source:3: expected ',', found number.");
+}
+
+TEST_CASE("ensuretstates range outside of section", "[timing]")
+{
+    static const char source1[] =
+        "#section main_0x100\n"
+        "start:\n"
+        "nop\n"
+        "#ensuretstates start, finish, <= 12\n"
+        ;
+
+    static const char source2[] =
+        "#section sec1_0x1234\n"
+        "#repeat 4\n"
+        "nop\n"
+        "#endrepeat\n"
+        "finish:\n"
+        ;
+
+    ErrorConsumer errorConsumer;
+    DataBlob actual = assemble2(errorConsumer, source1, source2);
+    REQUIRE(errorConsumer.errorMessage() ==
+        "source1:4: range 0x0100..0x1238 is outside of section 0x0100..0x0101.");
+}
@@ -0,0 +1,152 @@
+#include "Tests/Common.h"
+#include "Compiler/Output/SpectrumTapeWriter.h"
+#include "Compiler/Project.h"
+#include "Common/IO.h"
+
+TEST_CASE("turbo loader linked into designated section", "[turbo]")
+{
+    static const char source[] =
+        "#section code\n"
+        "ld ix, 0xc000\n"
+        "ld de, 0x100\n"
+        "ld a, 0xff\n"
+        "call turbo_load\n"
+        "ret\n"
+        ;
+
+    std::vector<uint8_t> binary = {
+        0xdd, 0x21, 0x00, 0xc0, // ld ix, 0xc000
+        0x11, 0x00, 0x01,       // ld de, 0x100
+        0x3e, 0xff,             // ld a, 0xff
+        0xcd, 0x0d, 0x80,       // call turbo_load
+        0xc9,                   // ret
+        0xcd, 0x12, 0x80,       // call tload_bytes
+        0xfb,                   // ei
+        0xc9,                   // ret
+        0x14,                   // inc d
+        0x08,                   // ex af, af'
+        0x15,                   // dec d
+        0xf3,                   // di
+        };
+
+    ErrorConsumer errorConsumer;
+    DataBlob actual = assembleWithProject(errorConsumer, "TurboProject.xml", source);
+    REQUIRE(errorConsumer.errorMessage() == "");
+    REQUIRE(actual.data().size() == 13 + 169);
+    REQUIRE(actual.data().substr(0, binary.size()) == std::string(binary.begin(), binary.end()));
+}
+
+TEST_CASE("turbo loader rejects indistinguishable bit pulses", "[turbo]")
+{
+    static const char source[] =
+        "#section code\n"
+        "call turbo_load\n"
+        ;
+
+    ErrorConsumer errorConsumer;
+    DataBlob actual = assembleWithProject(errorConsumer, "TurboInvalidProject.xml", source);
+    REQUIRE(errorConsumer.errorMessage() == "turbo pulses for bits 0 and 1 are too close.");
+}
+
+TEST_CASE("turbo file written as tzx turbo data block", "[turbo][tzx]")
+{
+    TurboTiming timing;
+    timing.pilot = 1000;
+    timing.pilotPulses = 2000;
+    timing.sync1 = 300;
+    timing.sync2 = 350;
+    timing.zero = 250;
+    timing.one = 520;
+    timing.pause = 700;
+
+    TempFile file(".tzx");
+    SpectrumTapeWriter writer;
+    writer.setTurboTiming(timing);
+    writer.addTurboFile("data");
+    addCode(writer, "loader", 0x8000, { 0xc9 });
+    addCode(writer, "data", 0xc000, { 0x12, 0x34, 0x56 });
+    writer.setWriteTzxFile(file.path());
+    writer.writeOutput();
+    std::string tzx = file.load();
+
+    REQUIRE(tzx.substr(0, 8) == "ZXTape!\x1a");
+
+    // Skip standard speed header and data blocks of the loader
+    size_t off = 10;
+    for (int i = 0; i < 2; i++) {
+        REQUIRE(tzx[off] == 0x10);
+        off += 5 + (uint8_t(tzx[off + 3]) | (uint8_t(tzx[off + 4]) << 8));
+    }
+
+    REQUIRE(tzx.size() == off + 19 + 5);
+    REQUIRE(tzx.substr(off, 19) == std::string(
+        "\x11"          // turbo speed data block
+        "\xe8\x03"      // pilot pulse
+        "\x2c\x01"      // first sync pulse
+        "\x5e\x01"      // second sync pulse
+        "\xfa\x00"      // zero bit pulse
+        "\x08\x02"      // one bit pulse
+        "\xd0\x07"      // pilot tone length
+        "\x08"          // used bits in the last byte
+        "\xbc\x02"      // pause
+        "\x05\x00\x00", // data length
+        19));
+    REQUIRE(tzx.substr(off + 19) == std::string("\xff\x12\x34\x56\x8f", 5));
+}
+
+TEST_CASE("turbo loader timing constants", "[turbo]")
+{
+    static const char source[] =
+        "#section code\n"
+        "call turbo_load\n"
+        ;
+
+    ErrorConsumer errorConsumer;
+    DataBlob actual = assembleWithProject(errorConsumer, "TurboCustomProject.xml", source);
+    REQUIRE(errorConsumer.errorMessage() == "");
+    const std::string& data = actual.data();
+
+    // Expected values follow from the pulse lengths in the project file
+    REQUIRE(data.substr(31, 3) == std::string("\x21\x0c\x01", 3));      // ld hl, WAIT
+    REQUIRE(data.substr(46, 2) == "\x06\xa5");                          // ld b, LEADER_START
+    REQUIRE(data.substr(53, 2) == "\x3e\xcb");                          // ld a, LEADER_MAX
+    REQUIRE(data.substr(61, 2) == "\x06\xd2");                          // ld b, SYNC_START
+    REQUIRE(data.substr(69, 2) == "\xfe\xe2");                          // cp SYNC_MAX
+    REQUIRE(data.substr(83, 2) == "\x06\xe0");                          // ld b, BIT_START
+    REQUIRE(data.substr(109, 2) == "\x06\xe2");                         // ld b, BYTE_START
+    REQUIRE(data.substr(117, 2) == "\x3e\xed");                         // ld a, BIT_THRESHOLD
+    REQUIRE(data.substr(122, 2) == "\x06\xe0");                         // ld b, BIT_START
+    REQUIRE(data.substr(142, 2) == "\x3e\x01");                         // ld a, EDGE_DELAY
+}
+
+static void loadTurboProject(const char* attributes)
+{
+    TempFile file(".xml");
+    writeFile(file.path(), std::string(
+        "<?xml version=\"1.0\" encoding=\"utf-8\"?>\n"
+        "<RetroProject>\n"
+        "    <OutputTZX ") + attributes + " />\n"
+        "</RetroProject>\n");
+
+    Project project;
+    project.load(file.path(), nullptr);
+}
+
+TEST_CASE("turbo timings are validated", "[turbo]")
+{
+    REQUIRE_NOTHROW(loadTurboProject("pilot=\"65535\" pause=\"0\""));
+    REQUIRE_THROWS_WITH(loadTurboProject("pilot=\"0\""),
+        Catch::Contains("Invalid value \"0\" for attribute \"pilot\" in element \"OutputTZX\""));
+    REQUIRE_THROWS_WITH(loadTurboProject("pilotPulses=\"-1\""),
+        Catch::Contains("Invalid value \"-1\" for attribute \"pilotPulses\""));
+    REQUIRE_THROWS_WITH(loadTurboProject("sync1=\"0\""),
+        Catch::Contains("Invalid value \"0\" for attribute \"sync1\""));
+    REQUIRE_THROWS_WITH(loadTurboProject("sync2=\"65536\""),
+        Catch::Contains("Invalid value \"65536\" for attribute \"sync2\""));
+    REQUIRE_THROWS_WITH(loadTurboProject("zero=\"0\""),
+        Catch::Contains("Invalid value \"0\" for attribute \"zero\""));
+    REQUIRE_THROWS_WITH(loadTurboProject("one=\"100000\""),
+        Catch::Contains("Invalid value \"100000\" for attribute \"one\""));
+    REQUIRE_THROWS_WITH(loadTurboProject("pause=\"-5\""),
+        Catch::Contains("Invalid value \"-5\" for attribute \"pause\""));
+}
@@ -1,5 +1,8 @@
 #include "DataBlob.h"
 #include "Compiler/Linker/CompiledOutput.h"
+#include "Compiler/Linker/DebugInformation.h"
+#include "Compiler/Linker/ListingWriter.h"
+#include "Compiler/Linker/SourceMap.h"
 
 static const DataBlob dummy;
 
@@ -22,6 +25,33 @@ DataBlob::DataBlob(CompiledFile* file)
         char* dst = &mData[0];
         while (p < end)
             *dst++ = (*p++).value;
+
+        std::stringstream ss;
+        file->debugInfo()->writeTimingReport(ss);
+        mTiming = ss.str();
+
+        std::stringstream map;
+        file->debugInfo()->writeMemoryMap(map);
+        mMemoryMap = map.str();
+
+        SourceMap sourceMap;
+        sourceMap.build(file);
+        std::vector<uint8_t> sourceMapData;
+        sourceMap.write(sourceMapData);
+        mSourceMap.assign(sourceMapData.begin(), sourceMapData.end());
+
+        if (file->isListingEnabled()) {
+            ListingWriter listing(file);
+            std::string line;
+            while (listing.nextLine(line))
+                mListing += line + '\n';
+        }
+
+        for (const auto& warning : file->warnings())
+            mWarnings += warning.message + '\n';
+
+        mLoadAddress = file->loadAddress();
+        mFingerprint = file->fingerprint();
     }
 }
 
@@ -17,6 +17,13 @@ public:
     DataBlob& operator=(DataBlob&& other) = default;
 
     const std::string& data() const { return mData; }
+    const std::string& timing() const { return mTiming; }
+    const std::string& memoryMap() const { return mMemoryMap; }
+    const std::string& sourceMap() const { return mSourceMap; }
+    const std::string& listing() const { return mListing; }
+    const std::string& warnings() const { return mWarnings; }
+    size_t loadAddress() const { return mLoadAddress; }
+    uint64_t fingerprint() const { return mFingerprint; }
 
     bool hasFiles() const { return !mFileData.empty(); }
     int numFiles() const { return int(mFileData.size()); }
@@ -28,6 +35,13 @@ public:
 
 private:
     std::string mData;
+    std::string mTiming;
+    std::string mMemoryMap;
+    std::string mSourceMap;
+    std::string mListing;
+    std::string mWarnings;
+    size_t mLoadAddress = 0;
+    uint64_t mFingerprint = 0;
     std::unordered_map<std::string, std::unique_ptr<DataBlob>> mFileData;
 };
 
@@ -0,0 +1,29 @@
+#include "TempFile.h"
+#include "Common/IO.h"
+#include <atomic>
+#include <chrono>
+#include <random>
+
+TempFile::TempFile(const char* extension)
+{
+    static const uint64_t session = (uint64_t(std::random_device()()) << 32)
+        ^ uint64_t(std::chrono::steady_clock::now().time_since_epoch().count());
+    static std::atomic<uint32_t> counter;
+
+    std::stringstream ss;
+    ss << "retrotoolkit_test_" << std::hex << std::setfill('0') << std::setw(16) << session
+       << '_' << std::setw(8) << counter++ << extension;
+
+    mPath = std::filesystem::temp_directory_path() / ss.str();
+}
+
+TempFile::~TempFile()
+{
+    std::error_code error;
+    std::filesystem::remove_all(mPath, error);
+}
+
+std::string TempFile::load() const
+{
+    return loadFile(mPath);
+}
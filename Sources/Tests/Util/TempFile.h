@@ -0,0 +1,22 @@
+#ifndef TESTS_UTIL_TEMPFILE_H
+#define TESTS_UTIL_TEMPFILE_H
+
+#include "Common/Common.h"
+
+// Unique file name in the system temporary directory; the file (or directory) is deleted on destruction
+class TempFile
+{
+public:
+    explicit TempFile(const char* extension);
+    ~TempFile();
+
+    const std::filesystem::path& path() const { return mPath; }
+    std::string load() const;
+
+private:
+    std::filesystem::path mPath;
+
+    DISABLE_COPY(TempFile);
+};
+
+#endif
@@ -1,9 +1,13 @@
 #include "TestUtil.h"
 #include "Compiler/Linker/Program.h"
 #include "Compiler/Linker/Linker.h"
+#include "Compiler/Linker/SourceMap.h"
 #include "Compiler/Assembler/AssemblerParser.h"
 #include "Compiler/Lexer.h"
 #include "Compiler/Project.h"
+#include "Compiler/SpectrumBasicCompiler.h"
+#include "Common/BuildManifest.h"
+#include "Common/IO.h"
 
 static GCHeap heap;
 
@@ -23,9 +27,27 @@ static void assemble(Program* program, const char* name, const char* source)
     parser.parse(lexer.firstToken());
 }
 
-static DataBlob link(const std::unique_ptr<Project>& project, Program* program)
+static void assembleFile(Program* program, const std::filesystem::path& path)
+{
+    std::string source = loadFile(path);
+    auto fileID = new (&heap) FileID(path.filename(), path);
+    Lexer lexer(&heap, Lexer::Mode::Assembler);
+    lexer.scan(fileID, source.c_str());
+    AssemblerParser parser(&heap, program);
+    parser.parse(lexer.firstToken());
+}
+
+static DataBlob link(const std::unique_ptr<Project>& project, Program* program, const char* basicSource = nullptr)
 {
     Linker linker(&heap, project.get());
+
+    if (basicSource) {
+        std::unordered_set<std::string> filesUsedByBasic;
+        SpectrumBasicCompiler::collectFileReferences(basicSource, filesUsedByBasic);
+        for (const auto& name : filesUsedByBasic)
+            linker.addFileUsedByBasic(name);
+    }
+
     auto output = linker.link(program);
 
     auto mainFile = output->getFile("MAIN");
@@ -80,3 +102,74 @@ DataBlob assemble3(ErrorConsumer& errorConsumer, const char* source1, const char
         return DataBlob();
     }
 }
+
+DataBlob assembleWithProject(ErrorConsumer& errorConsumer, const char* projectFile, const char* source)
+{
+    try {
+        auto program = new (&heap) Program();
+        auto project = loadProject(projectFile);
+        assemble(program, "source", source);
+        return link(project, program);
+    } catch (const CompilerError& error) {
+        errorConsumer.setError(error);
+        return DataBlob();
+    }
+}
+
+DataBlob assembleWithBasic(ErrorConsumer& errorConsumer, const char* projectFile, const char* source, const char* basicSource)
+{
+    try {
+        auto program = new (&heap) Program();
+        auto project = loadProject(projectFile);
+        assemble(program, "source", source);
+        return link(project, program, basicSource);
+    } catch (const CompilerError& error) {
+        errorConsumer.setError(error);
+        return DataBlob();
+    }
+}
+
+DataBlob assembleFileWithProject(ErrorConsumer& errorConsumer, const char* projectFile, const std::filesystem::path& sourceFile)
+{
+    try {
+        auto program = new (&heap) Program();
+        auto project = loadProject(projectFile);
+        assembleFile(program, sourceFile);
+        return link(project, program);
+    } catch (const CompilerError& error) {
+        errorConsumer.setError(error);
+        return DataBlob();
+    }
+}
+
+std::vector<std::string> updateSourceMaps(ErrorConsumer& errorConsumer, BuildManifest& manifest,
+    const std::filesystem::path& outputPath, const char* projectFile, const char* source)
+{
+    std::vector<std::string> result;
+
+    try {
+        auto program = new (&heap) Program();
+        auto project = loadProject(projectFile);
+        assemble(program, "source", source);
+
+        Linker linker(&heap, project.get());
+        auto output = linker.link(program);
+
+        for (const auto& file : output->files()) {
+            if (SourceMap::update(manifest, outputPath / (file->name() + ".srcmap"), file))
+                result.emplace_back(file->name());
+        }
+    } catch (const CompilerError& error) {
+        errorConsumer.setError(error);
+    }
+
+    return result;
+}
+
+void addCode(IOutputWriter& writer, const char* name, size_t address, const std::vector<uint8_t>& bytes)
+{
+    std::vector<CodeEmitter::Byte> data(bytes.size());
+    for (size_t i = 0; i < bytes.size(); i++)
+        data[i].value = bytes[i];
+    writer.addCodeFile(nullptr, name, name, data.data(), data.size(), address);
+}
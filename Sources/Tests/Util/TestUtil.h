@@ -4,11 +4,24 @@
 #include "Tests/Common.h"
 #include "Common/GC.h"
 #include "Compiler/Linker/CompiledOutput.h"
+#include "Compiler/Output/IOutputWriter.h"
 #include "Tests/Util/DataBlob.h"
 #include "Tests/Util/ErrorConsumer.h"
+#include "Tests/Util/TempFile.h"
+
+class BuildManifest;
 
 DataBlob assemble(ErrorConsumer& errorConsumer, const char* source);
 DataBlob assemble2(ErrorConsumer& errorConsumer, const char* source1, const char* source2);
 DataBlob assemble3(ErrorConsumer& errorConsumer, const char* source1, const char* source2, const char* source3);
+DataBlob assembleWithProject(ErrorConsumer& errorConsumer, const char* projectFile, const char* source);
+DataBlob assembleWithBasic(ErrorConsumer& errorConsumer, const char* projectFile, const char* source, const char* basicSource);
+DataBlob assembleFileWithProject(ErrorConsumer& errorConsumer, const char* projectFile, const std::filesystem::path& sourceFile);
+
+// Returns names of files for which source maps were rebuilt
+std::vector<std::string> updateSourceMaps(ErrorConsumer& errorConsumer, BuildManifest& manifest,
+    const std::filesystem::path& outputPath, const char* projectFile, const char* source);
+
+void addCode(IOutputWriter& writer, const char* name, size_t address, const std::vector<uint8_t>& bytes);
 
 #endif
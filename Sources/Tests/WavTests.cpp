@@ -0,0 +1,48 @@
+#include "Tests/Common.h"
+#include "Compiler/Output/WavWriter.h"
+
+static std::string writeWav(const WavFormat& format, std::initializer_list<std::pair<uint32_t, bool>> pulses)
+{
+    TempFile file(".wav");
+
+    WavWriter writer(file.path(), format);
+    for (const auto& pulse : pulses)
+        writer.addPulse(pulse.first, pulse.second);
+    writer.finish();
+
+    return file.load();
+}
+
+TEST_CASE("8-bit wav", "[wav]")
+{
+    WavFormat format;
+    std::string wav = writeWav(format, { { 2168, true }, { 2168, false }, { 79, true } });
+
+    // 2168 T-states at 44100 Hz is 27.3 samples; fractions are carried into the last pulse (79 T-states).
+    // Data chunk of odd size is padded.
+    REQUIRE(wav.size() == 44 + 27 + 27 + 1 + 1);
+    REQUIRE(wav.substr(0, 4) == "RIFF");
+    REQUIRE(wav.substr(8, 8) == "WAVEfmt ");
+    REQUIRE(wav.substr(22, 2) == std::string("\x01\x00", 2));
+    REQUIRE(wav.substr(24, 4) == std::string("\x44\xac\x00\x00", 4));
+    REQUIRE(wav.substr(34, 2) == std::string("\x08\x00", 2));
+    REQUIRE(wav.substr(36, 8) == std::string("data\x37\x00\x00\x00", 8));
+    REQUIRE(wav.substr(44, 27) == std::string(27, '\xff'));
+    REQUIRE(wav.substr(44 + 27, 27) == std::string(27, '\x00'));
+    REQUIRE(wav.substr(44 + 54, 2) == std::string("\xff\x00", 2));
+}
+
+TEST_CASE("16-bit wav", "[wav]")
+{
+    WavFormat format;
+    format.sampleRate = 22050;
+    format.bitsPerSample = 16;
+    std::string wav = writeWav(format, { { 1000, true }, { 1000, false } });
+
+    REQUIRE(wav.size() == 44 + 2 * 6 + 2 * 6);
+    REQUIRE(wav.substr(24, 4) == std::string("\x22\x56\x00\x00", 4));
+    REQUIRE(wav.substr(28, 4) == std::string("\x44\xac\x00\x00", 4));
+    REQUIRE(wav.substr(32, 4) == std::string("\x02\x00\x10\x00", 4));
+    REQUIRE(wav.substr(44, 4) == std::string("\xff\x7f\xff\x7f", 4));
+    REQUIRE(wav.substr(44 + 12, 4) == std::string("\x01\x80\x01\x80", 4));
+}